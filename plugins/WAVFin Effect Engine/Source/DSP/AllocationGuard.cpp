@@ -0,0 +1,110 @@
+#include "AllocationGuard.h"
+
+#if WAVFIN_ENABLE_ALLOCATION_CHECKS
+
+#include <cstdlib>
+#include <new>
+
+#if JUCE_WINDOWS
+ #include <malloc.h>
+#endif
+
+namespace WAVFinDSP
+{
+
+namespace
+{
+    thread_local int guardDepth = 0;
+    std::atomic<int> numViolations { 0 };
+}
+
+ScopedNoAllocation::ScopedNoAllocation() noexcept   { ++guardDepth; }
+ScopedNoAllocation::~ScopedNoAllocation() noexcept  { --guardDepth; }
+
+void ScopedNoAllocation::noteAllocation (std::size_t size) noexcept
+{
+    if (guardDepth == 0)
+        return;
+
+    numViolations.fetch_add (1, std::memory_order_relaxed);
+
+    // Stop counting while the assertion itself runs, in case it logs.
+    --guardDepth;
+    juce::ignoreUnused (size);
+    jassertfalse; // Heap allocation on the audio thread
+    ++guardDepth;
+}
+
+int ScopedNoAllocation::getNumViolations() noexcept
+{
+    return numViolations.load (std::memory_order_relaxed);
+}
+
+} // namespace WAVFinDSP
+
+//==============================================================================
+static void* allocateChecked (std::size_t size)
+{
+    WAVFinDSP::ScopedNoAllocation::noteAllocation (size);
+
+    if (auto* ptr = std::malloc (size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+// Over-aligned types (alignas above the default new alignment) come through here
+static void* allocateAlignedChecked (std::size_t size, std::align_val_t alignment)
+{
+    WAVFinDSP::ScopedNoAllocation::noteAllocation (size);
+
+    const auto bytes = size != 0 ? size : 1;
+    const auto align = juce::jmax (static_cast<std::size_t> (alignment), sizeof (void*));
+
+   #if JUCE_WINDOWS
+    if (auto* ptr = _aligned_malloc (bytes, align))
+        return ptr;
+   #else
+    void* ptr = nullptr;
+
+    if (posix_memalign (&ptr, align, bytes) == 0)
+        return ptr;
+   #endif
+
+    throw std::bad_alloc();
+}
+
+static void freeAligned (void* ptr) noexcept
+{
+   #if JUCE_WINDOWS
+    _aligned_free (ptr);
+   #else
+    std::free (ptr);
+   #endif
+}
+
+void* operator new (std::size_t size)                                   { return allocateChecked (size); }
+void* operator new[] (std::size_t size)                                 { return allocateChecked (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept   { try { return allocateChecked (size); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { try { return allocateChecked (size); } catch (...) { return nullptr; } }
+
+void operator delete (void* ptr) noexcept                               { std::free (ptr); }
+void operator delete[] (void* ptr) noexcept                             { std::free (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept                  { std::free (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept                { std::free (ptr); }
+void operator delete (void* ptr, const std::nothrow_t&) noexcept        { std::free (ptr); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept      { std::free (ptr); }
+
+void* operator new (std::size_t size, std::align_val_t alignment)                                   { return allocateAlignedChecked (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)                                 { return allocateAlignedChecked (size, alignment); }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { try { return allocateAlignedChecked (size, alignment); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return allocateAlignedChecked (size, alignment); } catch (...) { return nullptr; } }
+
+void operator delete (void* ptr, std::align_val_t) noexcept                         { freeAligned (ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept                       { freeAligned (ptr); }
+void operator delete (void* ptr, std::size_t, std::align_val_t) noexcept            { freeAligned (ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept          { freeAligned (ptr); }
+void operator delete (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept  { freeAligned (ptr); }
+void operator delete[] (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned (ptr); }
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/** Set to 1 (CMake option WAVFIN_ENABLE_ALLOCATION_CHECKS) to make any heap
+    allocation inside a ScopedNoAllocation region trip an assertion.
+    This replaces the global operator new, so keep it out of release builds.
+*/
+#ifndef WAVFIN_ENABLE_ALLOCATION_CHECKS
+ #define WAVFIN_ENABLE_ALLOCATION_CHECKS 0
+#endif
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Test-mode guard for the audio callback.
+
+    While an instance is alive on a thread, any call to operator new on that
+    thread (plain, nothrow or over-aligned) is counted and asserts. When allocation checks are compiled out the
+    guard is an empty object.
+*/
+class ScopedNoAllocation
+{
+public:
+   #if WAVFIN_ENABLE_ALLOCATION_CHECKS
+    ScopedNoAllocation() noexcept;
+    ~ScopedNoAllocation() noexcept;
+
+    /** Called by the replacement operator new. */
+    static void noteAllocation (std::size_t size) noexcept;
+
+    /** Number of allocations seen inside guarded regions since start-up. */
+    static int getNumViolations() noexcept;
+   #else
+    ScopedNoAllocation() noexcept = default;
+    static int getNumViolations() noexcept  { return 0; }
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedNoAllocation)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,304 @@
+#include "ConvolutionStage.h"
+
+namespace WAVFinDSP
+{
+
+namespace
+{
+    // Trailing samples quieter than this (relative to the peak) are trimmed
+    constexpr float silenceThresholdDb = -90.0f;
+
+    /** Same approach as juce::dsp::Convolution: a ResamplingAudioSource over the whole IR. */
+    juce::AudioBuffer<float> resampleImpulse (juce::AudioBuffer<float>& source, double sourceRate, double targetRate)
+    {
+        if (sourceRate == targetRate)
+            return source;
+
+        const auto ratio = sourceRate / targetRate;
+        juce::AudioBuffer<float> result (source.getNumChannels(), (int) std::ceil (source.getNumSamples() / ratio));
+
+        juce::MemoryAudioSource memorySource (source, false);
+        juce::ResamplingAudioSource resampler (&memorySource, false, source.getNumChannels());
+
+        resampler.setResamplingRatio (ratio);
+        resampler.prepareToPlay (result.getNumSamples(), targetRate);
+
+        juce::AudioSourceChannelInfo info (result);
+        resampler.getNextAudioBlock (info);
+        return result;
+    }
+
+    /** Drops the silent end of the IR and scales it to unit energy per channel (on average). */
+    void trimAndNormalise (juce::AudioBuffer<float>& impulse)
+    {
+        const auto numSamples = impulse.getNumSamples();
+        const auto peak = impulse.getMagnitude (0, numSamples);
+
+        if (peak <= 0.0f)
+        {
+            impulse.setSize (impulse.getNumChannels(), 0);
+            return;
+        }
+
+        const auto threshold = peak * juce::Decibels::decibelsToGain (silenceThresholdDb);
+        int length = 0;
+
+        for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+        {
+            const auto* data = impulse.getReadPointer (ch);
+
+            for (int s = numSamples; s > length; --s)
+            {
+                if (std::abs (data[s - 1]) > threshold)
+                {
+                    length = s;
+                    break;
+                }
+            }
+        }
+
+        impulse.setSize (impulse.getNumChannels(), length, true);
+
+        double energy = 0.0;
+        for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            for (int s = 0; s < length; ++s)
+                energy += juce::square ((double) impulse.getSample (ch, s));
+
+        impulse.applyGain ((float) (1.0 / std::sqrt (energy / impulse.getNumChannels())));
+    }
+}
+
+//==============================================================================
+class ConvolutionStage::LoaderThread  : public juce::Thread
+{
+public:
+    explicit LoaderThread (ConvolutionStage& s) : juce::Thread ("WAVFin IR loader"), stage (s) {}
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            stage.loadRequestedFiles();
+            wait (-1);
+        }
+    }
+
+private:
+    ConvolutionStage& stage;
+};
+
+class ConvolutionStage::TailThread  : public juce::Thread
+{
+public:
+    explicit TailThread (ConvolutionStage& s) : juce::Thread ("WAVFin convolution tail"), stage (s) {}
+
+    void run() override
+    {
+        // Polls, so the audio thread never has to signal it
+        while (! threadShouldExit())
+        {
+            stage.processTail();
+            wait (1);
+        }
+    }
+
+private:
+    ConvolutionStage& stage;
+};
+
+//==============================================================================
+ConvolutionStage::ConvolutionStage()
+    : loader (std::make_unique<LoaderThread> (*this)),
+      tailWorker (std::make_unique<TailThread> (*this))
+{
+    loader->startThread (juce::Thread::Priority::normal);
+}
+
+ConvolutionStage::~ConvolutionStage()
+{
+    loader->stopThread (10000);
+    stopTailThread();
+    discardPendingEngines();
+}
+
+void ConvolutionStage::prepare (double newSampleRate, int newNumChannels, bool nonRealtime)
+{
+    // The audio thread is stopped; the worker must be too before the engines change hands
+    stopTailThread();
+
+    {
+        // Held so that a load in progress publishes either before this or with the new settings
+        const juce::ScopedLock sl (sourceLock);
+
+        sampleRate = newSampleRate;
+        numChannels = juce::jmax (1, newNumChannels);
+        tailInline = nonRealtime;
+
+        discardPendingEngines();
+        active = createEngine();
+    }
+
+    numUnderruns.store (0, std::memory_order_relaxed);
+    impulseSeconds.store (getImpulseLength() / sampleRate, std::memory_order_relaxed);
+    workerEngine.store (active.get(), std::memory_order_release);
+    tailWorker->startThread (juce::Thread::Priority::high);
+}
+
+bool ConvolutionStage::process (const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    // Take a new engine only once the worker has deleted the previous one
+    if (pending.load (std::memory_order_relaxed) != nullptr && retired.load (std::memory_order_acquire) == nullptr)
+    {
+        auto* next = pending.exchange (nullptr, std::memory_order_acq_rel);
+        workerEngine.store (next, std::memory_order_release);
+        retired.store (active.release(), std::memory_order_release);
+        active.reset (next);
+        impulseSeconds.store (getImpulseLength() / sampleRate, std::memory_order_relaxed);
+    }
+
+    if (active == nullptr || active->getLength() == 0)
+        return false;
+
+    active->process (block);
+    numUnderruns.store (active->getNumUnderruns(), std::memory_order_relaxed);
+    return true;
+}
+
+void ConvolutionStage::reset() noexcept
+{
+    // A pending engine has heard nothing yet
+    if (active != nullptr)
+        active->reset();
+}
+
+void ConvolutionStage::loadImpulseResponse (const juce::File& file)
+{
+    {
+        const juce::ScopedLock sl (requestLock);
+        requestedFile = file;
+        currentFile = file;
+        ++numRequests;
+    }
+
+    loader->notify();
+}
+
+bool ConvolutionStage::waitForPendingLoads (int timeoutMilliseconds) const
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMilliseconds);
+
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl (requestLock);
+
+            if (numRequestsHandled == numRequests)
+                return true;
+        }
+
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep (5);
+    }
+}
+
+juce::File ConvolutionStage::getImpulseResponseFile() const
+{
+    const juce::ScopedLock sl (requestLock);
+    return currentFile;
+}
+
+//==============================================================================
+void ConvolutionStage::loadRequestedFiles()
+{
+    for (;;)
+    {
+        juce::File file;
+
+        {
+            const juce::ScopedLock sl (requestLock);
+            file = std::exchange (requestedFile, juce::File());
+
+            // Nothing new since the last file, so every request so far has been dealt with
+            if (file == juce::File())
+            {
+                numRequestsHandled = numRequests;
+                return;
+            }
+        }
+
+        if (! readFile (file))
+        {
+            // Keep reporting the IR that is still playing
+            const juce::ScopedLock sl (sourceLock);
+            const juce::ScopedLock rl (requestLock);
+
+            if (currentFile == file)
+                currentFile = loadedFile;
+        }
+
+        sendChangeMessage();
+    }
+}
+
+bool ConvolutionStage::readFile (const juce::File& file)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+        return false;
+
+    const auto length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxLengthSeconds * reader->sampleRate));
+    juce::AudioBuffer<float> buffer ((int) juce::jlimit (1u, 2u, reader->numChannels), length);
+
+    if (! reader->read (&buffer, 0, length, 0, true, buffer.getNumChannels() > 1))
+        return false;
+
+    const juce::ScopedLock sl (sourceLock);
+
+    sourceIR = std::move (buffer);
+    sourceSampleRate = reader->sampleRate;
+    loadedFile = file;
+
+    // Replaces a pending engine the audio thread has not picked up yet
+    delete pending.exchange (createEngine().release(), std::memory_order_acq_rel);
+    return true;
+}
+
+std::unique_ptr<PartitionedConvolver> ConvolutionStage::createEngine() const
+{
+    if (sourceIR.getNumSamples() == 0)
+        return {};
+
+    auto source = sourceIR;
+    auto impulse = resampleImpulse (source, sourceSampleRate, sampleRate);
+    trimAndNormalise (impulse);
+
+    return std::make_unique<PartitionedConvolver> (impulse, numChannels, tailInline);
+}
+
+void ConvolutionStage::processTail() noexcept
+{
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+
+    if (auto* engine = workerEngine.load (std::memory_order_acquire))
+        engine->processTail();
+}
+
+void ConvolutionStage::stopTailThread()
+{
+    tailWorker->stopThread (1000);
+    workerEngine.store (nullptr, std::memory_order_release);
+}
+
+void ConvolutionStage::discardPendingEngines()
+{
+    delete pending.exchange (nullptr, std::memory_order_acq_rel);
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
+
+} // namespace WAVFinDSP
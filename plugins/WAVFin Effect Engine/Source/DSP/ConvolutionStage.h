@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_events/juce_events.h>
+#include "PartitionedConvolver.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Impulse-response convolution for the chain, built on PartitionedConvolver.
+
+    Two threads run beside the audio thread:
+    - the loader decodes an IR file, resamples it to the current rate, trims the
+      trailing silence, normalises it to unit energy and builds a new engine;
+    - the tail worker computes the engine's long partitions (see PartitionedConvolver).
+
+    A finished engine is handed to the audio thread through an atomic pointer. The
+    audio thread swaps it in at the start of a block and passes the old one back to
+    the worker thread, which deletes it, so nothing is allocated, freed or locked on
+    the audio thread. Listeners are told (asynchronously) when a load completes or fails.
+*/
+class ConvolutionStage  : public juce::ChangeBroadcaster
+{
+public:
+    /** Longer files are truncated. */
+    static constexpr double maxLengthSeconds = 10.0;
+
+    ConvolutionStage();
+    ~ConvolutionStage() override;
+
+    /** Rebuilds the current IR for this rate and layout. With nonRealtime set the tail
+        is computed on the audio thread, so offline renders do not depend on the worker. */
+    void prepare (double sampleRate, int numChannels, bool nonRealtime);
+
+    /** Replaces the block with the wet signal. Returns false, leaving the block
+        untouched, while no IR is loaded. Audio thread only. */
+    bool process (const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    /** Forgets the input heard so far, so the next block starts from silence. Audio thread only. */
+    void reset() noexcept;
+
+    /** Starts loading in the background; the current IR keeps playing until the new one is ready. */
+    void loadImpulseResponse (const juce::File& file);
+
+    /** Blocks until every file requested so far has been read (or has failed). For offline
+        tools that must not render before the IR is in place; never call it on the audio thread.
+        Returns false on timeout. */
+    bool waitForPendingLoads (int timeoutMilliseconds) const;
+
+    /** The file last requested, or the last one that loaded if that request failed. */
+    juce::File getImpulseResponseFile() const;
+
+    /** Length of the IR that is playing, in samples. Audio thread only. */
+    int getImpulseLength() const noexcept       { return active != nullptr ? active->getLength() : 0; }
+
+    /** Length of the IR that is playing, in seconds. Safe from any thread. */
+    double getImpulseLengthSeconds() const noexcept     { return impulseSeconds.load (std::memory_order_relaxed); }
+
+    /** Tail blocks the worker missed since the current IR was loaded. */
+    int getNumUnderruns() const noexcept        { return numUnderruns.load (std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    class LoaderThread;
+    class TailThread;
+
+    void loadRequestedFiles();
+    bool readFile (const juce::File& file);
+    std::unique_ptr<PartitionedConvolver> createEngine() const;
+    void processTail() noexcept;
+
+    void stopTailThread();
+    void discardPendingEngines();
+
+    //==============================================================================
+    std::unique_ptr<LoaderThread> loader;
+    std::unique_ptr<TailThread> tailWorker;
+
+    // The decoded file at its own rate, plus the settings the engine is built for
+    juce::CriticalSection sourceLock;
+    juce::AudioBuffer<float> sourceIR;
+    double sourceSampleRate = 0.0;
+    juce::File loadedFile;
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+    bool tailInline = false;
+
+    juce::CriticalSection requestLock;
+    juce::File requestedFile, currentFile;
+    int numRequests = 0, numRequestsHandled = 0;
+
+    // active: audio thread only; pending: loader -> audio; retired: audio -> worker
+    std::unique_ptr<PartitionedConvolver> active;
+    std::atomic<PartitionedConvolver*> pending { nullptr }, retired { nullptr }, workerEngine { nullptr };
+    std::atomic<int> numUnderruns { 0 };
+    std::atomic<double> impulseSeconds { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionStage)
+};
+
+} // namespace WAVFinDSP
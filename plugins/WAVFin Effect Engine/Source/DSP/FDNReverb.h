@@ -0,0 +1,251 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    16-line feedback delay network reverb.
+
+    The lines share one interleaved ring buffer: each time step is a row of 16
+    values, so the whole network is written with contiguous SIMD stores. The network
+    runs in short runs, never longer than the shortest line, so a run only reads rows
+    written before it started. Each line's output for the run is gathered up front,
+    and the per-sample loop then runs entirely in SIMD registers across the lines:
+    fractional reads, damping, RT60 gains, the Householder feedback matrix
+    (x - 2/N * sum (x), lossless and O(N)), input injection and output taps.
+
+    Line lengths are set in milliseconds and converted at the current sample rate,
+    so the room sounds the same at any rate. Each line's feedback gain comes from
+    its length and the RT60 (gain = 10^(-3 length / (RT60 fs))), so every path
+    decays by 60 dB in the requested time. A one-pole low-pass in each loop makes
+    the highs die away sooner. Reads are fractional (linear), so a size change does
+    not snap to whole samples.
+
+    setParameters() only recomputes lengths and gains when a value has changed.
+    The output is 100% wet.
+*/
+template <typename SampleType>
+class FDNReverb
+{
+public:
+    static constexpr int numLines = 16;
+
+    FDNReverb() = default;
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        const auto longest = longestMs * sizeScale (1.0) * 0.001 * sampleRate;
+        lineSize = juce::nextPowerOfTwo ((int) std::ceil (longest) + 2);
+        lineMask = lineSize - 1;
+
+        lines.assign ((size_t) (lineSize * numLines), (SampleType) 0);
+
+        // Damping corner is fixed in Hz, so it does not move with the sample rate
+        damping = (SampleType) std::exp (-juce::MathConstants<double>::twoPi * dampingHz / sampleRate);
+
+        currentSize = currentDecay = -1.0;
+        setParameters (0.5, 2.0);
+        reset();
+    }
+
+    /** Ring length in samples: no output depends on input older than this. */
+    int getBufferSize() const noexcept      { return lineSize; }
+
+    void reset() noexcept
+    {
+        std::fill (lines.begin(), lines.end(), (SampleType) 0);
+        lowpass.fill (0);
+        writePos = 0;
+    }
+
+    /** size: 0..1 (room dimensions), decaySeconds: RT60. Does nothing if neither changed. */
+    void setParameters (double size, double decaySeconds) noexcept
+    {
+        size = juce::jlimit (0.0, 1.0, size);
+        decaySeconds = juce::jlimit (0.05, 30.0, decaySeconds);
+
+        if (size == currentSize && decaySeconds == currentDecay)
+            return;
+
+        currentSize = size;
+        currentDecay = decaySeconds;
+        shortestOffset = lineSize;
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            const auto lengthSamples = juce::jlimit (2.0, (double) (lineSize - 2), lineMs (i, size) * 0.001 * sampleRate);
+            const auto whole = (int) lengthSamples;
+
+            lineOffset[(size_t) i] = whole;
+            lineFrac[(size_t) i] = (SampleType) (lengthSamples - whole);
+            inputGain[(size_t) i] = (SampleType) (std::pow (10.0, -3.0 * lengthSamples / (decaySeconds * sampleRate)) * (1.0 - damping));
+            shortestOffset = juce::jmin (shortestOffset, whole);
+        }
+    }
+
+    /** Replaces the block with the reverb's wet signal. A mono block gets the left output. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numChannels = (int) block.getNumChannels();
+
+        if (numSamples == 0 || numChannels == 0)
+            return;
+
+        auto* left = block.getChannelPointer (0);
+        auto* right = numChannels > 1 ? block.getChannelPointer (1) : nullptr;
+
+        for (int start = 0; start < numSamples;)
+        {
+            const auto runLength = juce::jmin (numSamples - start, maxRunLength, shortestOffset);
+
+            gatherRun (runLength);
+            processRun<typename Simd::OpsFor<SampleType>::type> (left + start, right != nullptr ? right + start : nullptr, runLength);
+
+            writePos = (writePos + runLength) & lineMask;
+            start += runLength;
+        }
+
+        for (auto& z : lowpass)
+            juce::dsp::util::snapToZero (z);
+    }
+
+private:
+    //==============================================================================
+    /** Each line's output for rows writePos - length - 1 onwards, into delayed[s][line]. */
+    void gatherRun (int runLength) noexcept
+    {
+        // Row 0 is one sample older than the run; the interpolation uses it
+        for (int i = 0; i < numLines; ++i)
+        {
+            const auto* line = lines.data() + i;
+            auto index = writePos - lineOffset[(size_t) i] - 1;
+
+            for (int s = 0; s <= runLength; ++s, ++index)
+                delayed[(size_t) (s * numLines + i)] = line[(index & lineMask) * numLines];
+        }
+    }
+
+    template <typename Ops>
+    void processRun (SampleType* left, SampleType* right, int runLength) noexcept
+    {
+        static_assert (numLines % Ops::width == 0, "the lines must fill whole registers");
+        constexpr int numRegs = numLines / Ops::width;
+
+        // The loop state stays in registers for the whole run
+        typename Ops::Reg lp[numRegs];
+        for (int r = 0; r < numRegs; ++r)
+            lp[r] = Ops::load (lowpass.data() + r * Ops::width);
+
+        const auto pole = Ops::set (damping);
+
+        for (int s = 0; s < runLength; ++s)
+        {
+            const auto* older = delayed.data() + s * numLines;
+            const auto* newer = older + numLines;
+            auto* out = lines.data() + (size_t) (((writePos + s) & lineMask) * numLines);
+
+            auto outL = Ops::set (0), outR = Ops::set (0), sum = Ops::set (0);
+
+            for (int r = 0; r < numRegs; ++r)
+            {
+                const auto i = r * Ops::width;
+                const auto x0 = Ops::load (newer + i);
+                const auto x = Ops::add (x0, Ops::mul (Ops::load (lineFrac.data() + i), Ops::sub (Ops::load (older + i), x0)));
+
+                // Damping low-pass with the RT60 gain folded into its input
+                lp[r] = Ops::add (Ops::mul (x, Ops::load (inputGain.data() + i)), Ops::mul (pole, lp[r]));
+
+                outL = Ops::add (outL, Ops::mul (lp[r], Ops::load (tapLeft.data() + i)));
+                outR = Ops::add (outR, Ops::mul (lp[r], Ops::load (tapRight.data() + i)));
+                sum = Ops::add (sum, lp[r]);
+            }
+
+            const auto reflection = Ops::set (horizontalSum<Ops> (sum) * ((SampleType) -2 / (SampleType) numLines));
+            const auto inL = left[s];
+            const auto inR = right != nullptr ? right[s] : inL;
+            const auto inLeft = Ops::set (inL), inRight = Ops::set (inR);
+
+            for (int r = 0; r < numRegs; ++r)
+            {
+                // Householder reflection, plus the input spread over the lines with sign patterns
+                const auto i = r * Ops::width;
+                const auto injected = Ops::add (Ops::mul (inLeft, Ops::load (injectLeft.data() + i)),
+                                                Ops::mul (inRight, Ops::load (injectRight.data() + i)));
+                Ops::store (out + i, Ops::add (Ops::add (lp[r], reflection), injected));
+            }
+
+            left[s] = horizontalSum<Ops> (outL) * outputGain;
+            if (right != nullptr)
+                right[s] = horizontalSum<Ops> (outR) * outputGain;
+        }
+
+        for (int r = 0; r < numRegs; ++r)
+            Ops::store (lowpass.data() + r * Ops::width, lp[r]);
+    }
+
+    template <typename Ops>
+    static SampleType horizontalSum (typename Ops::Reg v) noexcept
+    {
+        alignas (32) SampleType lanes[Ops::width];
+        Ops::store (lanes, v);
+
+        SampleType total = 0;
+        for (auto lane : lanes)
+            total += lane;
+        return total;
+    }
+
+    /** Lengths spread exponentially from shortestMs to longestMs, scaled by the room size. */
+    static double lineMs (int line, double size) noexcept
+    {
+        // The sine jitter keeps neighbouring lengths from sharing common factors
+        const auto position = juce::jlimit (0.0, 1.0, (line + 0.37 * std::sin (line * 2.3)) / (numLines - 1));
+        return shortestMs * std::pow (longestMs / shortestMs, position) * sizeScale (size);
+    }
+
+    static double sizeScale (double size) noexcept     { return 0.4 + 1.2 * size; }
+
+    static constexpr std::array<SampleType, numLines> hadamardRow (int bit) noexcept
+    {
+        std::array<SampleType, numLines> row {};
+        for (int i = 0; i < numLines; ++i)
+            row[(size_t) i] = ((i >> bit) & 1) != 0 ? (SampleType) -1 : (SampleType) 1;
+        return row;
+    }
+
+    //==============================================================================
+    static constexpr double shortestMs = 17.0, longestMs = 71.0;
+    static constexpr double dampingHz = 6000.0;
+    static constexpr int maxRunLength = 64;
+
+    // Four orthogonal Hadamard rows, so the two inputs and two outputs are decorrelated
+    static constexpr SampleType outputGain = (SampleType) 0.25;    // 1 / sqrt (numLines)
+    alignas (32) static constexpr std::array<SampleType, numLines> tapLeft = hadamardRow (0);
+    alignas (32) static constexpr std::array<SampleType, numLines> tapRight = hadamardRow (1);
+    alignas (32) static constexpr std::array<SampleType, numLines> injectLeft = hadamardRow (2);
+    alignas (32) static constexpr std::array<SampleType, numLines> injectRight = hadamardRow (3);
+
+    std::vector<SampleType> lines;
+    int lineSize = 1, lineMask = 0, writePos = 0;
+
+    alignas (32) std::array<SampleType, numLines> lowpass {}, inputGain {}, lineFrac {};
+    std::array<int, numLines> lineOffset {};
+    int shortestOffset = 2;
+
+    alignas (32) std::array<SampleType, (maxRunLength + 1) * numLines> delayed {};
+
+    SampleType damping = 0;
+    double sampleRate = 44100.0;
+    double currentSize = -1.0, currentDecay = -1.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FDNReverb)
+};
+
+} // namespace WAVFinDSP
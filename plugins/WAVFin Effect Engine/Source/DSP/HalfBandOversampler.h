@@ -0,0 +1,269 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Cascaded 2x polyphase half-band oversampler (1x, 2x, 4x or 8x).
+
+    Each 2x stage is a linear-phase Kaiser-windowed half-band FIR split into its
+    two polyphase branches. Every other tap of a half-band filter is zero and the
+    centre tap is 0.5, so one branch is a pure delay and only the other branch is
+    filtered. That branch is evaluated tap-by-tap across the whole block with
+    FloatVectorOperations::addWithMultiply, which runs on SSE/AVX/NEON.
+
+    All stages are allocated in prepare() for the maximum factor; changing the
+    factor afterwards only changes how many stages run, so it is safe on the
+    audio thread.
+*/
+template <typename SampleType>
+class HalfBandOversampler
+{
+public:
+    static constexpr int maxNumStages = 3;
+
+    HalfBandOversampler() = default;
+
+    void prepare (int numChannels, int maxBlockSize)
+    {
+        int inputSize = juce::jmax (1, maxBlockSize);
+
+        for (int i = 0; i < maxNumStages; ++i)
+        {
+            stages[(size_t) i].prepare (halfTapsForStage (i), numChannels, inputSize);
+            inputSize *= 2;
+        }
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& stage : stages)
+            stage.reset();
+    }
+
+    /** 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x. Resets the filter state when it changes. */
+    void setNumStages (int newNumStages)
+    {
+        newNumStages = juce::jlimit (0, maxNumStages, newNumStages);
+
+        if (newNumStages != numStages)
+        {
+            numStages = newNumStages;
+            reset();
+        }
+    }
+
+    int getNumStages() const noexcept   { return numStages; }
+    int getFactor() const noexcept      { return 1 << numStages; }
+
+    /** Round-trip (up + down) delay in base-rate samples for the current factor. */
+    int getLatencyInSamples() const noexcept    { return getLatencyForStages (numStages); }
+
+    static constexpr int getLatencyForStages (int stageCount) noexcept
+    {
+        // Stage i runs at 2^i * fs on its low side and delays by K samples there,
+        // once on the way up and once on the way down.
+        int latency = 0;
+        for (int i = 0; i < stageCount; ++i)
+            latency += (2 * halfTapsForStage (i)) >> i;
+        return latency;
+    }
+
+    /** Upsamples the input and returns a view of the oversampled signal to process in place. */
+    juce::dsp::AudioBlock<SampleType> processSamplesUp (const juce::dsp::AudioBlock<const SampleType>& input)
+    {
+        const auto numChannels = (int) input.getNumChannels();
+        auto numSamples = (int) input.getNumSamples();
+
+        if (numStages == 0)
+            return {};
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            stages[0].upsample (ch, input.getChannelPointer ((size_t) ch), numSamples);
+
+        for (int i = 1; i < numStages; ++i)
+        {
+            numSamples *= 2;
+            for (int ch = 0; ch < numChannels; ++ch)
+                stages[(size_t) i].upsample (ch, stages[(size_t) i - 1].getUpsampled (ch), numSamples);
+        }
+
+        return stages[(size_t) numStages - 1].getUpsampledBlock (numChannels, numSamples * 2);
+    }
+
+    /** Downsamples the block returned by processSamplesUp() back into output. */
+    void processSamplesDown (juce::dsp::AudioBlock<SampleType>& output)
+    {
+        if (numStages == 0)
+            return;
+
+        const auto numChannels = (int) output.getNumChannels();
+        const auto numSamples = (int) output.getNumSamples();
+
+        for (int i = numStages - 1; i >= 0; --i)
+        {
+            const int outSamples = numSamples << i;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* source = stages[(size_t) i].getUpsampled (ch);
+                auto* dest = i == 0 ? output.getChannelPointer ((size_t) ch)
+                                    : stages[(size_t) i - 1].getUpsampled (ch);
+                stages[(size_t) i].downsample (ch, source, dest, outSamples);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    /** Half the branch length K of each stage. Later stages see a signal that is
+        already band-limited to a quarter of their rate, so they get away with
+        far fewer taps. */
+    static constexpr int halfTapsForStage (int stageIndex) noexcept
+    {
+        return stageIndex == 0 ? 16 : (stageIndex == 1 ? 8 : 4);
+    }
+
+    //==============================================================================
+    class Stage
+    {
+    public:
+        void prepare (int halfTaps, int numChannels, int maxInputSize)
+        {
+            K = halfTaps;
+            designCoefficients();
+
+            upHistory.setSize (numChannels, 2 * K - 1 + maxInputSize);
+            downOddHistory.setSize (numChannels, 2 * K + maxInputSize);
+            downEvenHistory.setSize (numChannels, K + maxInputSize);
+            branch.setSize (1, maxInputSize);
+            upsampled.setSize (numChannels, 2 * maxInputSize);
+        }
+
+        void reset()
+        {
+            upHistory.clear();
+            downOddHistory.clear();
+            downEvenHistory.clear();
+            upsampled.clear();
+        }
+
+        SampleType* getUpsampled (int channel)    { return upsampled.getWritePointer (channel); }
+
+        juce::dsp::AudioBlock<SampleType> getUpsampledBlock (int numChannels, int numSamples)
+        {
+            return juce::dsp::AudioBlock<SampleType> (upsampled)
+                       .getSubsetChannelBlock (0, (size_t) numChannels)
+                       .getSubBlock (0, (size_t) numSamples);
+        }
+
+        /** in: numIn samples at the low rate -> upsampled channel: 2 * numIn samples. */
+        void upsample (int channel, const SampleType* in, int numIn)
+        {
+            using FVO = juce::FloatVectorOperations;
+
+            const int historyLength = 2 * K - 1;
+            auto* history = upHistory.getWritePointer (channel);
+            auto* odd = branch.getWritePointer (0);
+            auto* out = upsampled.getWritePointer (channel);
+
+            FVO::copy (history + historyLength, in, numIn);
+
+            // Filtered branch: odd[n] = sum_k c[k] * x[n - 2K + 1 + k]
+            FVO::copyWithMultiply (odd, history, upCoefficients[0], numIn);
+            for (int k = 1; k < 2 * K; ++k)
+                FVO::addWithMultiply (odd, history + k, upCoefficients[(size_t) k], numIn);
+
+            // Delay branch is the centre tap: x[n - K]
+            const auto* even = history + K - 1;
+            for (int n = 0; n < numIn; ++n)
+            {
+                out[2 * n]     = even[n];
+                out[2 * n + 1] = odd[n];
+            }
+
+            std::memmove (history, history + numIn, sizeof (SampleType) * (size_t) historyLength);
+        }
+
+        /** in: 2 * numOut samples at the high rate -> out: numOut samples. in and out may alias. */
+        void downsample (int channel, const SampleType* in, SampleType* out, int numOut)
+        {
+            using FVO = juce::FloatVectorOperations;
+
+            auto* oddHistory = downOddHistory.getWritePointer (channel);
+            auto* evenHistory = downEvenHistory.getWritePointer (channel);
+            auto* oddIn = oddHistory + 2 * K;
+            auto* evenIn = evenHistory + K;
+
+            for (int n = 0; n < numOut; ++n)
+            {
+                evenIn[n] = in[2 * n];
+                oddIn[n]  = in[2 * n + 1];
+            }
+
+            // out[n] = 0.5 * even[n - K] + sum_k c[k] * odd[n - 2K + k]
+            FVO::copyWithMultiply (out, evenHistory, (SampleType) 0.5, numOut);
+            for (int k = 0; k < 2 * K; ++k)
+                FVO::addWithMultiply (out, oddHistory + k, downCoefficients[(size_t) k], numOut);
+
+            std::memmove (oddHistory, oddHistory + numOut, sizeof (SampleType) * (size_t) (2 * K));
+            std::memmove (evenHistory, evenHistory + numOut, sizeof (SampleType) * (size_t) K);
+        }
+
+    private:
+        void designCoefficients()
+        {
+            // Odd taps of a half-band lowpass, i = -(2K-1) .. (2K-1), Kaiser windowed
+            constexpr double beta = 8.0; // ~80 dB stopband
+            const double halfLength = 2.0 * K;
+
+            auto besselI0 = [] (double x)
+            {
+                double sum = 1.0, term = 1.0;
+                for (int m = 1; m < 32; ++m)
+                {
+                    term *= (x / (2.0 * m)) * (x / (2.0 * m));
+                    sum += term;
+                }
+                return sum;
+            };
+
+            std::array<double, 2 * maxHalfTaps> taps {};
+            double sum = 0.0;
+
+            for (int t = 0; t < 2 * K; ++t)
+            {
+                const int i = 2 * (t - K) + 1;
+                const double ratio = i / halfLength;
+                const double window = besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) / besselI0 (beta);
+                taps[(size_t) t] = std::sin (juce::MathConstants<double>::halfPi * i) / (juce::MathConstants<double>::pi * i) * window;
+                sum += taps[(size_t) t];
+            }
+
+            // Odd taps must sum to 0.5 for unity DC gain (centre tap supplies the other half)
+            for (int t = 0; t < 2 * K; ++t)
+            {
+                const double h = taps[(size_t) t] * 0.5 / sum;
+                downCoefficients[(size_t) t] = (SampleType) h;
+                upCoefficients[(size_t) t] = (SampleType) (2.0 * h); // compensate zero-stuffing
+            }
+        }
+
+        static constexpr int maxHalfTaps = 16;
+
+        int K = 1;
+        std::array<SampleType, 2 * maxHalfTaps> upCoefficients {}, downCoefficients {};
+        juce::AudioBuffer<SampleType> upHistory, downOddHistory, downEvenHistory, branch, upsampled;
+    };
+
+    std::array<Stage, maxNumStages> stages;
+    int numStages = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HalfBandOversampler)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Dual-voice halftime: the input is written to a ring buffer and replayed at half
+    speed by two read heads, crossfading to the freshly reset head on every trigger().
+
+    The ring is a power of two long so every wrap is a mask. Read heads are kept in
+    fixed point with one fractional bit (half-sample units), which is exact for the
+    0.5x speed at any sample rate and buffer length. Processing is block-wise per
+    channel: the block is written with at most two copies, each voice is rendered as
+    a contiguous linear-interpolation loop, and the crossfade and dry/wet blend are
+    plain vector loops. Once a crossfade has finished only the active voice is read.
+*/
+template <typename SampleType>
+class HalftimeEngine
+{
+public:
+    HalftimeEngine() = default;
+
+    /** minBufferSamples is rounded up to a power of two (see getRequiredBufferSize()).
+        Call from prepareToPlay(). */
+    void prepare (int numChannels, int maxBlockSize, int minBufferSamples)
+    {
+        maxBlock = juce::jmax (1, maxBlockSize);
+        bufferSize = juce::nextPowerOfTwo (juce::jmax (minBufferSamples, 4 * maxBlock));
+        mask = bufferSize - 1;
+        halfMask = (uint32_t) (2 * bufferSize - 1);
+
+        ring.setSize (juce::jmax (1, numChannels), bufferSize);
+        voices.setSize (2, maxBlock);
+        segment.resize ((size_t) (maxBlock / 2 + 2));
+        crossfadeGains.resize ((size_t) maxBlock);
+
+        reset();
+    }
+
+    void reset()
+    {
+        ring.clear();
+        writePos = 0;
+        readPos = { 0u, (uint32_t) bufferSize }; // voices start half a buffer apart
+        activeVoice = 0;
+        crossfade = 0;
+    }
+
+    int getBufferSize() const noexcept  { return bufferSize; }
+
+    /** Ring length that plays loops of loopSamples with crossfades up to fadeSamples.
+        A head lags the write head by half the time since its trigger, and the fading
+        voice keeps running for one fade past the next trigger. */
+    static int getRequiredBufferSize (double loopSamples, double fadeSamples, int maxBlockSize) noexcept
+    {
+        return (int) std::ceil (0.5 * (loopSamples + fadeSamples)) + maxBlockSize + 1;
+    }
+
+    /** Longest loop the prepared ring can play before the fading voice would read
+        samples that have already been overwritten. */
+    int getMaxLoopSamples (double fadeSamples) const noexcept
+    {
+        return juce::jmax (1, 2 * (bufferSize - maxBlock - 1) - (int) std::ceil (fadeSamples));
+    }
+
+    /** Length of the voice crossfade after each trigger. */
+    void setFadeTime (double seconds, double sampleRate) noexcept
+    {
+        fadeStep = (SampleType) (1.0 / juce::jmax (1.0, seconds * sampleRate));
+    }
+
+    /** Swaps voices: the new active head restarts at the current write position and
+        the old one keeps playing its tail while it fades out. */
+    void trigger() noexcept
+    {
+        activeVoice = 1 - activeVoice;
+        readPos[(size_t) activeVoice] = (uint32_t) writePos << 1;
+    }
+
+    /** Processes in place. mixRamp, if given, holds a per-sample dry/wet value. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block, SampleType mix, const SampleType* mixRamp = nullptr)
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numChannels = juce::jmin ((int) block.getNumChannels(), ring.getNumChannels());
+        jassert (numSamples <= maxBlock);
+
+        if (numSamples == 0)
+            return;
+
+        // Crossfade towards the active voice, shared by every channel
+        const auto target = (SampleType) activeVoice;
+        const bool fading = crossfade != target;
+
+        if (fading)
+        {
+            const auto step = target > crossfade ? fadeStep : -fadeStep;
+            for (int s = 0; s < numSamples; ++s)
+                crossfadeGains[(size_t) s] = juce::jlimit ((SampleType) 0, (SampleType) 1, crossfade + step * (SampleType) (s + 1));
+
+            crossfade = crossfadeGains[(size_t) numSamples - 1];
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = block.getChannelPointer ((size_t) ch);
+            writeToRing (ch, data, numSamples);
+
+            const SampleType* wet = nullptr;
+
+            if (fading)
+            {
+                auto* voice1 = voices.getWritePointer (0);
+                auto* voice2 = voices.getWritePointer (1);
+                readVoice (ch, readPos[0], numSamples, voice1);
+                readVoice (ch, readPos[1], numSamples, voice2);
+
+                for (int s = 0; s < numSamples; ++s)
+                    voice1[s] += crossfadeGains[(size_t) s] * (voice2[s] - voice1[s]);
+
+                wet = voice1;
+            }
+            else
+            {
+                auto* voice = voices.getWritePointer (activeVoice);
+                readVoice (ch, readPos[(size_t) activeVoice], numSamples, voice);
+                wet = voice;
+            }
+
+            if (mixRamp != nullptr)
+            {
+                for (int s = 0; s < numSamples; ++s)
+                    data[s] += mixRamp[s] * (wet[s] - data[s]);
+            }
+            else
+            {
+                for (int s = 0; s < numSamples; ++s)
+                    data[s] += mix * (wet[s] - data[s]);
+            }
+        }
+
+        // Write head moves one sample per sample, read heads one half-sample
+        writePos = (writePos + numSamples) & mask;
+        for (auto& pos : readPos)
+            pos = (pos + (uint32_t) numSamples) & halfMask;
+    }
+
+private:
+    //==============================================================================
+    void writeToRing (int channel, const SampleType* source, int numSamples) noexcept
+    {
+        auto* dest = ring.getWritePointer (channel);
+        const auto firstPart = juce::jmin (numSamples, bufferSize - writePos);
+
+        std::copy (source, source + firstPart, dest + writePos);
+        std::copy (source + firstPart, source + numSamples, dest);
+    }
+
+    /** Renders numSamples of a half-speed head starting at halfPosition (half-sample units). */
+    void readVoice (int channel, uint32_t halfPosition, int numSamples, SampleType* out) noexcept
+    {
+        const auto start = (int) (halfPosition >> 1);
+        const auto h = (halfPosition & 1u) != 0 ? (SampleType) 0.5 : (SampleType) 0;
+        const auto needed = (numSamples + 1) / 2 + 1;
+
+        // Contiguous view of the samples the head passes over; copied only across the wrap
+        const auto* line = ring.getReadPointer (channel);
+        const SampleType* seg = line + start;
+
+        if (start + needed > bufferSize)
+        {
+            const auto firstPart = bufferSize - start;
+            std::copy (line + start, line + bufferSize, segment.data());
+            std::copy (line, line + (needed - firstPart), segment.data() + firstPart);
+            seg = segment.data();
+        }
+
+        // Output pair k sits at positions start + k + h and start + k + h + 0.5
+        const auto pairs = numSamples / 2;
+        for (int k = 0; k < pairs; ++k)
+        {
+            const auto a = seg[k];
+            const auto d = seg[k + 1] - a;
+            out[2 * k]     = a + h * d;
+            out[2 * k + 1] = a + (h + (SampleType) 0.5) * d;
+        }
+
+        if ((numSamples & 1) != 0)
+            out[numSamples - 1] = seg[pairs] + h * (seg[pairs + 1] - seg[pairs]);
+    }
+
+    //==============================================================================
+    juce::AudioBuffer<SampleType> ring, voices;
+    std::vector<SampleType> segment, crossfadeGains;
+
+    int bufferSize = 1, mask = 0, maxBlock = 1;
+    uint32_t halfMask = 1;
+    int writePos = 0;
+    std::array<uint32_t, 2> readPos {};
+
+    int activeVoice = 0;                // 0 = Voice 1, 1 = Voice 2
+    SampleType crossfade = 0;           // 0 = Voice 1 fully active, 1 = Voice 2 fully active
+    SampleType fadeStep = (SampleType) 0.01;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HalftimeEngine)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Fixed integer delay used to keep dry paths aligned with stages that add latency.
+    Memory is reserved in prepare(); setDelay() is safe on the audio thread.
+*/
+template <typename SampleType>
+class LatencyDelay
+{
+public:
+    LatencyDelay() = default;
+
+    void prepare (int numChannels, int maxDelaySamples)
+    {
+        buffer.setSize (juce::jmax (1, numChannels), juce::jmax (1, maxDelaySamples));
+        reset();
+    }
+
+    void reset()
+    {
+        buffer.clear();
+        position = 0;
+    }
+
+    void setDelay (int newDelay)
+    {
+        newDelay = juce::jlimit (0, buffer.getNumSamples(), newDelay);
+
+        if (newDelay != delay)
+        {
+            delay = newDelay;
+            reset();
+        }
+    }
+
+    int getDelay() const noexcept   { return delay; }
+
+    /** Delays the block in place. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        if (delay == 0)
+            return;
+
+        const auto numChannels = juce::jmin ((int) block.getNumChannels(), buffer.getNumChannels());
+        const auto numSamples = (int) block.getNumSamples();
+        int endPosition = position;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = block.getChannelPointer ((size_t) ch);
+            auto* line = buffer.getWritePointer (ch);
+            int pos = position;
+
+            for (int s = 0; s < numSamples; ++s)
+            {
+                const auto delayed = line[pos];
+                line[pos] = data[s];
+                data[s] = delayed;
+
+                if (++pos == delay)
+                    pos = 0;
+            }
+
+            endPosition = pos;
+        }
+
+        position = endPosition;
+    }
+
+private:
+    juce::AudioBuffer<SampleType> buffer;
+    int delay = 0;
+    int position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyDelay)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    The levels of a stretch of audio, for the meters. Every value is linear.
+
+    The audio thread fills one per host block. merge() folds frames together, so a
+    reader can turn whatever arrived since its last display frame into one: peaks
+    and stage levels keep the maximum, RMS averages the power over the samples, and
+    the limiter gain keeps the deepest reduction.
+*/
+template <int numStages>
+struct MeterFrame
+{
+    static constexpr int maxChannels = 2;
+
+    int numSamples = 0, numChannels = 0;
+    std::array<float, maxChannels> inputPeak {}, inputRms {}, outputPeak {}, outputRms {};
+    float limiterGain = 1.0f;                               // lowest gain the limiter applied; 1 is no reduction
+    std::array<float, (size_t) numStages> stageLevels {};   // peak of each stage's wet output; 0 if it did not run
+
+    void merge (const MeterFrame& other) noexcept
+    {
+        const auto total = numSamples + other.numSamples;
+
+        if (total == 0)
+            return;
+
+        const auto weight = (float) numSamples / (float) total;
+
+        auto mergeRms = [weight] (float a, float b)
+        {
+            return std::sqrt (a * a * weight + b * b * (1.0f - weight));
+        };
+
+        for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+        {
+            inputPeak[ch] = juce::jmax (inputPeak[ch], other.inputPeak[ch]);
+            outputPeak[ch] = juce::jmax (outputPeak[ch], other.outputPeak[ch]);
+            inputRms[ch] = mergeRms (inputRms[ch], other.inputRms[ch]);
+            outputRms[ch] = mergeRms (outputRms[ch], other.outputRms[ch]);
+        }
+
+        limiterGain = juce::jmin (limiterGain, other.limiterGain);
+
+        for (size_t i = 0; i < stageLevels.size(); ++i)
+            stageLevels[i] = juce::jmax (stageLevels[i], other.stageLevels[i]);
+
+        numSamples = total;
+        numChannels = juce::jmax (numChannels, other.numChannels);
+    }
+};
+
+} // namespace WAVFinDSP
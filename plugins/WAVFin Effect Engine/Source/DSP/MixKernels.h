@@ -0,0 +1,92 @@
+#pragma once
+
+#include "WaveshaperKernels.h"
+
+namespace WAVFinDSP
+{
+namespace Kernels
+{
+
+//==============================================================================
+/**
+    A dry/wet (or gain) value that is either constant for the block or, while its
+    parameter is moving, read per sample from a smoother ramp.
+*/
+template <typename T>
+struct BlockValue
+{
+    const T* ramp = nullptr;
+    T value = 1;
+
+    template <typename Ops>
+    typename Ops::Reg at (int index) const noexcept
+    {
+        return ramp != nullptr ? Ops::load (ramp + index) : Ops::set (value);
+    }
+};
+
+/** out = dry + (wet - dry) * mix. out may alias dry or wet. */
+template <typename T>
+inline void blendBlock (T* out, const T* dry, const T* wet, int numSamples, BlockValue<T> mix) noexcept
+{
+    Simd::forEachIndex<T> (numSamples, [=] (auto ops, int i)
+    {
+        using Ops = decltype (ops);
+        const auto d = Ops::load (dry + i);
+        Ops::store (out + i, Ops::add (d, Ops::mul (Ops::sub (Ops::load (wet + i), d), mix.template at<Ops> (i))));
+    });
+}
+
+//==============================================================================
+/**
+    Everything after the last effect stage, for one channel, in a single pass:
+
+        x = data
+        x = x + (stageWet - x) * stageMix       the last stage's dry/wet, if stageWet is set
+        x = x * gain                            output gain
+        x = softLimit (x)                       see softLimitBlock(); skipped unless softLimit is set
+        x = globalDry + (x - globalDry) * globalMix     if globalDry is set
+
+    Done as separate passes each step would reload and store the whole buffer; here
+    the sample stays in a register from the first load to the final store.
+*/
+template <typename T>
+struct OutputStage
+{
+    const T* stageWet = nullptr;
+    BlockValue<T> stageMix;
+    BlockValue<T> gain;
+    bool softLimit = true;
+    T limitThreshold = (T) 0.9, limitCeiling = 1;
+    const T* globalDry = nullptr;
+    BlockValue<T> globalMix;
+};
+
+template <typename T>
+inline void outputStageBlock (T* data, int numSamples, const OutputStage<T>& stage) noexcept
+{
+    Simd::forEachIndex<T> (numSamples, [stage, data] (auto ops, int i)
+    {
+        using Ops = decltype (ops);
+        auto x = Ops::load (data + i);
+
+        if (stage.stageWet != nullptr)
+            x = Ops::add (x, Ops::mul (Ops::sub (Ops::load (stage.stageWet + i), x), stage.stageMix.template at<Ops> (i)));
+
+        x = Ops::mul (x, stage.gain.template at<Ops> (i));
+
+        if (stage.softLimit)
+            x = detail::softLimit<T, Ops> (x, stage.limitThreshold, stage.limitCeiling);
+
+        if (stage.globalDry != nullptr)
+        {
+            const auto dry = Ops::load (stage.globalDry + i);
+            x = Ops::add (dry, Ops::mul (Ops::sub (x, dry), stage.globalMix.template at<Ops> (i)));
+        }
+
+        Ops::store (data + i, x);
+    });
+}
+
+} // namespace Kernels
+} // namespace WAVFinDSP
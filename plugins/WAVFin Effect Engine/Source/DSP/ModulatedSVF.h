@@ -0,0 +1,206 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Topology-preserving state variable filter (the same structure and resonance
+    scaling as juce::dsp::StateVariableTPTFilter) whose cutoff and resonance can
+    change on every sample.
+
+    Coefficients are computed for the whole block before filtering: g = tan (pi fc / fs)
+    comes from a lookup table over normalised frequency with linear interpolation
+    (relative error below 1e-5 up to 0.48 fs and 4e-5 at the 0.49 fs limit), so a
+    per-sample cutoff costs a table read instead of a tan() call. The filter loop then runs both channels of a stereo
+    pair in the two lanes of one SIMD register, sharing the coefficients.
+
+    Low-pass, high-pass, band-pass and notch (low + high) come out of the same kernel;
+    the mode is a template parameter of the loop so there is no per-sample branch.
+*/
+template <typename SampleType>
+class ModulatedSVF
+{
+public:
+    enum class Type { lowpass = 0, highpass, bandpass, notch };
+
+    ModulatedSVF() = default;
+
+    void prepare (int numChannels, double newSampleRate, int maxBlockSize)
+    {
+        sampleRate = newSampleRate;
+        const auto blockSize = (size_t) juce::jmax (1, maxBlockSize);
+
+        s1.assign ((size_t) juce::jmax (1, numChannels), (SampleType) 0);
+        s2.assign (s1.size(), (SampleType) 0);
+
+        g.resize (blockSize);
+        gPlusR2.resize (blockSize);
+        h.resize (blockSize);
+        unusedLane.resize (blockSize);
+
+        // Every entry holds the true tan, so the last interval before the limit interpolates
+        // between exact values; only the lookup position is clamped (see lookupTan)
+        for (int i = 0; i <= tableSize; ++i)
+            tanTable[(size_t) i] = (SampleType) std::tan (juce::MathConstants<double>::pi * 0.5 * i / tableSize);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (s1.begin(), s1.end(), (SampleType) 0);
+        std::fill (s2.begin(), s2.end(), (SampleType) 0);
+    }
+
+    void setType (Type newType) noexcept    { type = newType; }
+
+    /** Filters the block in place. cutoffHz and resonance give one value per sample;
+        pass nullptr to use the constant instead. Resonance follows the JUCE SVF
+        (1 / sqrt (2) is flat, higher values peak). */
+    void process (const juce::dsp::AudioBlock<SampleType>& block,
+                  const SampleType* cutoffHz, SampleType constantCutoffHz,
+                  const SampleType* resonance, SampleType constantResonance) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numChannels = juce::jmin ((int) block.getNumChannels(), (int) s1.size());
+        jassert (numSamples <= (int) g.size());
+
+        if (numSamples == 0)
+            return;
+
+        computeCoefficients (numSamples, cutoffHz, constantCutoffHz, resonance, constantResonance);
+
+        for (int ch = 0; ch < numChannels; ch += 2)
+        {
+            auto* left = block.getChannelPointer ((size_t) ch);
+            const bool hasRight = ch + 1 < numChannels;
+            auto* right = hasRight ? block.getChannelPointer ((size_t) ch + 1) : unusedLane.data();
+
+            switch (type)
+            {
+                case Type::lowpass:   processPair<Type::lowpass>  (ch, hasRight, left, right, numSamples); break;
+                case Type::highpass:  processPair<Type::highpass> (ch, hasRight, left, right, numSamples); break;
+                case Type::bandpass:  processPair<Type::bandpass> (ch, hasRight, left, right, numSamples); break;
+                case Type::notch:     processPair<Type::notch>    (ch, hasRight, left, right, numSamples); break;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    void computeCoefficients (int numSamples,
+                              const SampleType* cutoffHz, SampleType constantCutoffHz,
+                              const SampleType* resonance, SampleType constantResonance) noexcept
+    {
+        const auto toNormalised = (SampleType) (1.0 / sampleRate);
+
+        if (cutoffHz != nullptr)
+        {
+            for (int s = 0; s < numSamples; ++s)
+                g[(size_t) s] = lookupTan (cutoffHz[s] * toNormalised);
+        }
+        else
+        {
+            std::fill (g.begin(), g.begin() + numSamples, lookupTan (constantCutoffHz * toNormalised));
+        }
+
+        const auto constantR2 = dampingFor (constantResonance);
+
+        for (int s = 0; s < numSamples; ++s)
+        {
+            const auto gs = g[(size_t) s];
+            const auto R2 = resonance != nullptr ? dampingFor (resonance[s]) : constantR2;
+            gPlusR2[(size_t) s] = gs + R2;
+            h[(size_t) s] = (SampleType) 1 / ((SampleType) 1 + R2 * gs + gs * gs);
+        }
+    }
+
+    SampleType lookupTan (SampleType normalisedCutoff) const noexcept
+    {
+        const auto position = juce::jlimit ((SampleType) 0, (SampleType) maxTablePosition,
+                                            normalisedCutoff * (SampleType) (2 * tableSize));
+        const auto index = (int) position;
+        const auto frac = position - (SampleType) index;
+        return tanTable[(size_t) index] + frac * (tanTable[(size_t) index + 1] - tanTable[(size_t) index]);
+    }
+
+    static SampleType dampingFor (SampleType resonance) noexcept
+    {
+        // JUCE asserts on zero resonance; keep the same scaling with a floor instead
+        return (SampleType) 1 / juce::jmax ((SampleType) 0.01, resonance);
+    }
+
+    template <Type mode>
+    void processPair (int channel, bool hasRight, SampleType* left, SampleType* right, int numSamples) noexcept
+    {
+        using Ops = Simd::StereoOps<SampleType>;
+
+        const auto leftIndex = (size_t) channel;
+        const auto rightIndex = hasRight ? leftIndex + 1 : leftIndex;
+
+        SampleType state1[2] = { s1[leftIndex], hasRight ? s1[rightIndex] : (SampleType) 0 };
+        SampleType state2[2] = { s2[leftIndex], hasRight ? s2[rightIndex] : (SampleType) 0 };
+
+        auto z1 = Ops::load (&state1[0], &state1[1]);
+        auto z2 = Ops::load (&state2[0], &state2[1]);
+
+        for (int s = 0; s < numSamples; ++s)
+        {
+            const auto gs = Ops::set (g[(size_t) s]);
+            const auto x = Ops::load (left + s, right + s);
+
+            const auto hp = Ops::mul (Ops::set (h[(size_t) s]),
+                                      Ops::sub (Ops::sub (x, Ops::mul (z1, Ops::set (gPlusR2[(size_t) s]))), z2));
+            const auto hpg = Ops::mul (hp, gs);
+            const auto bp = Ops::add (hpg, z1);
+            z1 = Ops::add (hpg, bp);
+
+            const auto bpg = Ops::mul (bp, gs);
+            const auto lp = Ops::add (bpg, z2);
+            z2 = Ops::add (bpg, lp);
+
+            if constexpr (mode == Type::lowpass)        Ops::store (left + s, right + s, lp);
+            else if constexpr (mode == Type::highpass)  Ops::store (left + s, right + s, hp);
+            else if constexpr (mode == Type::bandpass)  Ops::store (left + s, right + s, bp);
+            else                                        Ops::store (left + s, right + s, Ops::add (lp, hp));
+        }
+
+        Ops::store (&state1[0], &state1[1], z1);
+        Ops::store (&state2[0], &state2[1], z2);
+
+        for (auto* state : { state1, state2 })
+        {
+            juce::dsp::util::snapToZero (state[0]);
+            juce::dsp::util::snapToZero (state[1]);
+        }
+
+        s1[leftIndex] = state1[0];
+        s2[leftIndex] = state2[0];
+
+        if (hasRight)
+        {
+            s1[rightIndex] = state1[1];
+            s2[rightIndex] = state2[1];
+        }
+    }
+
+    //==============================================================================
+    static constexpr int tableSize = 4096;                  // intervals over 0 .. 0.5 fs
+    static constexpr double maxNormalisedCutoff = 0.49;
+    static constexpr double maxTablePosition = maxNormalisedCutoff * 2 * tableSize;
+
+    std::array<SampleType, tableSize + 1> tanTable {};
+    std::vector<SampleType> g, gPlusR2, h, unusedLane;
+    std::vector<SampleType> s1, s2;
+
+    Type type = Type::lowpass;
+    double sampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModulatedSVF)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Central LFO source: every modulation stream in the chain (filter LFO, autopan,
+    wow, flutter) is generated here once per block into its own buffer, and stages
+    read the buffer instead of evaluating trig per sample.
+
+    Sine is read from a shared wavetable with linear interpolation, triangle is a
+    branch-free function of phase, and random is a smoothed sample-and-hold that
+    draws a new target every cycle from a per-stream xorshift generator seeded by
+    the stream index, so renders are repeatable.
+
+    A stream can be locked to the host tempo. Its rate is then quantised to the
+    nearest power-of-two number of cycles per beat, and while the transport plays
+    its phase is derived from the song position, so it lines up with the beat.
+
+    process() only advances the phases. A stream's buffer is rendered on the first
+    getStream() call in that block, so modules that are switched off cost nothing.
+*/
+template <typename SampleType>
+class ModulationBank
+{
+public:
+    enum class Shape { sine = 0, triangle, random };
+
+    ModulationBank() = default;
+
+    void prepare (int numStreams, double newSampleRate, int maxBlockSize)
+    {
+        sampleRate = newSampleRate;
+        streams.resize ((size_t) juce::jmax (0, numStreams));
+        buffers.setSize (juce::jmax (1, numStreams), juce::jmax (1, maxBlockSize));
+
+        for (int i = 0; i <= tableSize; ++i)
+            sineTable[(size_t) i] = (SampleType) std::sin (juce::MathConstants<double>::twoPi * i / tableSize);
+
+        reset();
+    }
+
+    /** Restarts every stream at phase 0 with its initial random seed. */
+    void reset()
+    {
+        for (size_t i = 0; i < streams.size(); ++i)
+        {
+            auto& stream = streams[i];
+            stream.phase = 0.0;
+            stream.randomState = (uint32_t) (0x9e3779b9u * (i + 1));
+            stream.randomFrom = 0;
+            stream.randomTo = nextRandom (stream.randomState);
+            stream.start = stream;
+            stream.rendered = true;
+        }
+    }
+
+    void setRate (int index, double hz) noexcept                { streams[(size_t) index].rateHz = juce::jmax (0.0, hz); }
+    void setShape (int index, Shape newShape) noexcept          { streams[(size_t) index].shape = newShape; }
+    void setTempoSync (int index, bool shouldSync) noexcept     { streams[(size_t) index].tempoSync = shouldSync; }
+
+    /** Host position at the start of the next block; call before process(). */
+    void setTransport (double ppqPosition, double bpm, bool isPlaying) noexcept
+    {
+        hostPpq = ppqPosition;
+        hostBpm = bpm > 0.0 ? bpm : 120.0;
+        hostPlaying = isPlaying;
+    }
+
+    /** Advances every stream by numSamples. */
+    void process (int numSamples) noexcept
+    {
+        jassert (numSamples <= buffers.getNumSamples());
+        blockSize = numSamples;
+
+        for (auto& stream : streams)
+        {
+            double increment = stream.rateHz / sampleRate;
+
+            if (stream.tempoSync)
+            {
+                const auto cyclesPerBeat = quantisedCyclesPerBeat (stream.rateHz);
+                increment = cyclesPerBeat * hostBpm / (60.0 * sampleRate);
+
+                if (hostPlaying)
+                    stream.phase = wrap (hostPpq * cyclesPerBeat);
+            }
+
+            stream.increment = increment;
+            stream.start = stream;
+            stream.rendered = false;
+
+            // Random targets advance here so they stay in step whether or not the stream is read
+            const double end = stream.phase + increment * numSamples;
+            for (auto wraps = (int) end; wraps > 0; --wraps)
+            {
+                stream.randomFrom = stream.randomTo;
+                stream.randomTo = nextRandom (stream.randomState);
+            }
+
+            stream.phase = wrap (end);
+        }
+    }
+
+    /** The stream's values for the current block, in [-1, 1]. */
+    const SampleType* getStream (int index) noexcept
+    {
+        auto& stream = streams[(size_t) index];
+        auto* out = buffers.getWritePointer (index);
+
+        if (! stream.rendered)
+        {
+            render (stream.start, out);
+            stream.rendered = true;
+        }
+
+        return out;
+    }
+
+private:
+    //==============================================================================
+    struct StreamState
+    {
+        double phase = 0.0, increment = 0.0;
+        uint32_t randomState = 1;
+        SampleType randomFrom = 0, randomTo = 0;
+        Shape shape = Shape::sine;
+    };
+
+    struct Stream : StreamState
+    {
+        double rateHz = 1.0;
+        bool tempoSync = false;
+        bool rendered = true;
+        StreamState start;     // state at the start of the current block
+    };
+
+    void render (StreamState state, SampleType* out) noexcept
+    {
+        const auto phase0 = (SampleType) state.phase;
+        const auto increment = (SampleType) state.increment;
+
+        switch (state.shape)
+        {
+            case Shape::sine:
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    auto p = phase0 + increment * (SampleType) s;
+                    p -= (SampleType) (int) p;
+
+                    const auto position = p * (SampleType) tableSize;
+                    const auto index = (int) position;
+                    const auto frac = position - (SampleType) index;
+                    out[s] = sineTable[(size_t) index] + frac * (sineTable[(size_t) index + 1] - sineTable[(size_t) index]);
+                }
+                break;
+
+            case Shape::triangle:
+                // Starts at 0 rising, like the sine: 1 - 4 |frac (p + 0.25) - 0.5|
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    auto p = phase0 + increment * (SampleType) s + (SampleType) 0.25;
+                    p -= (SampleType) (int) p;
+                    out[s] = (SampleType) 1 - (SampleType) 4 * std::abs (p - (SampleType) 0.5);
+                }
+                break;
+
+            case Shape::random:
+            {
+                // Smoothstep between one random target per cycle
+                // Phase in double here so cycle counts match the draws made in process()
+                int cycle = 0;
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    const auto position = state.phase + state.increment * s;
+                    const auto whole = (int) position;
+                    const auto p = (SampleType) (position - whole);
+
+                    for (; cycle < whole; ++cycle)
+                    {
+                        state.randomFrom = state.randomTo;
+                        state.randomTo = nextRandom (state.randomState);
+                    }
+
+                    const auto eased = p * p * ((SampleType) 3 - (SampleType) 2 * p);
+                    out[s] = state.randomFrom + (state.randomTo - state.randomFrom) * eased;
+                }
+                break;
+            }
+        }
+    }
+
+    /** Rate snapped to the nearest power-of-two cycles per beat (1/16 .. 16). */
+    double quantisedCyclesPerBeat (double rateHz) const noexcept
+    {
+        if (rateHz <= 0.0)
+            return 0.0;
+
+        const auto exponent = std::round (std::log2 (rateHz * 60.0 / hostBpm));
+        return std::exp2 (juce::jlimit (-4.0, 4.0, exponent));
+    }
+
+    static double wrap (double phase) noexcept      { return phase - std::floor (phase); }
+
+    static SampleType nextRandom (uint32_t& state) noexcept
+    {
+        // xorshift32, mapped to [-1, 1)
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (SampleType) ((double) state * (2.0 / 4294967296.0) - 1.0);
+    }
+
+    //==============================================================================
+    static constexpr int tableSize = 1024;
+    std::array<SampleType, tableSize + 1> sineTable {};
+
+    std::vector<Stream> streams;
+    juce::AudioBuffer<SampleType> buffers;
+
+    double sampleRate = 44100.0;
+    double hostPpq = 0.0, hostBpm = 120.0;
+    bool hostPlaying = false;
+    int blockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModulationBank)
+};
+
+} // namespace WAVFinDSP
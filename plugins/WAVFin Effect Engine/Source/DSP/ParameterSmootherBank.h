@@ -0,0 +1,163 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Linear ramps for a fixed set of continuous parameters, stored structure-of-arrays.
+
+    Targets are set once per host block; process() then advances every ramp at once
+    (one SIMD lane per parameter) and writes a per-sample control buffer for each
+    parameter that is still moving. Stages check isSmoothing() and only take the
+    per-sample path while a ramp is active; a steady parameter is read as a single
+    value with getValue(), so the common case costs nothing extra.
+
+    Ramps land exactly on their target: the value is always derived as
+    target - step * samplesRemaining, so there is no accumulated rounding drift.
+*/
+template <typename SampleType>
+class ParameterSmootherBank
+{
+public:
+    ParameterSmootherBank() = default;
+
+    /** Allocates state for numParameters ramps and their control buffers. Call from prepareToPlay(). */
+    void prepare (int numParameters, double newSampleRate, int maxBlockSize, double defaultRampSeconds = 0.02)
+    {
+        numParams = juce::jmax (0, numParameters);
+        sampleRate = newSampleRate;
+
+        // Pad to a whole number of the widest register so process() needs no scalar tail
+        constexpr int padding = 8;
+        const auto paddedSize = (size_t) ((numParams + padding - 1) / padding * padding);
+
+        for (auto* state : { &current, &target, &step, &remaining, &remainingAtBlockStart })
+            state->assign (paddedSize, (SampleType) 0);
+
+        rampLength.assign ((size_t) numParams, 0);
+
+        ramps.setSize (juce::jmax (1, numParams), juce::jmax (1, maxBlockSize));
+        sampleIndex.resize ((size_t) juce::jmax (1, maxBlockSize));
+        for (size_t i = 0; i < sampleIndex.size(); ++i)
+            sampleIndex[i] = (SampleType) i;
+
+        for (int i = 0; i < numParams; ++i)
+            setRampDuration (i, defaultRampSeconds);
+    }
+
+    void setRampDuration (int index, double seconds)
+    {
+        jassert (juce::isPositiveAndBelow (index, numParams));
+        rampLength[(size_t) index] = juce::jmax (0, juce::roundToInt (seconds * sampleRate));
+    }
+
+    /** Jumps straight to value with no ramp. */
+    void setCurrentAndTargetValue (int index, SampleType value) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, numParams));
+        const auto i = (size_t) index;
+        current[i] = target[i] = value;
+        step[i] = remaining[i] = remainingAtBlockStart[i] = 0;
+    }
+
+    /** Starts a ramp from the current value if value differs from the current target. */
+    void setTargetValue (int index, SampleType value) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, numParams));
+        const auto i = (size_t) index;
+
+        if (value == target[i])
+            return;
+
+        if (rampLength[i] == 0)
+        {
+            setCurrentAndTargetValue (index, value);
+            return;
+        }
+
+        target[i] = value;
+        remaining[i] = (SampleType) rampLength[i];
+        step[i] = (value - current[i]) / remaining[i];
+    }
+
+    /** Advances every ramp by numSamples and fills the control buffers of those still moving. */
+    void process (int numSamples) noexcept
+    {
+        using Ops = typename Simd::OpsFor<SampleType>::type;
+
+        jassert (numSamples <= ramps.getNumSamples());
+        const auto count = Ops::set ((SampleType) numSamples);
+
+        for (size_t i = 0; i < current.size(); i += (size_t) Ops::width)
+        {
+            auto left = Ops::load (remaining.data() + i);
+            Ops::store (remainingAtBlockStart.data() + i, left);
+
+            left = Ops::sub (left, Ops::min (left, count));
+            Ops::store (remaining.data() + i, left);
+            Ops::store (current.data() + i, Ops::sub (Ops::load (target.data() + i),
+                                                      Ops::mul (Ops::load (step.data() + i), left)));
+        }
+
+        for (int p = 0; p < numParams; ++p)
+            if (isSmoothing (p))
+                fillRamp (p, numSamples);
+    }
+
+    /** True if the parameter moved during the last processed block. */
+    bool isSmoothing (int index) const noexcept     { return remainingAtBlockStart[(size_t) index] > 0; }
+
+    /** Value at the end of the last processed block (the steady value when not smoothing). */
+    SampleType getValue (int index) const noexcept  { return current[(size_t) index]; }
+
+    SampleType getTargetValue (int index) const noexcept    { return target[(size_t) index]; }
+
+    /** Per-sample values for the last processed block. Only valid while isSmoothing(). */
+    const SampleType* getRamp (int index) const noexcept
+    {
+        jassert (isSmoothing (index));
+        return ramps.getReadPointer (index);
+    }
+
+    /** The ramp while smoothing, otherwise nullptr so callers can take their scalar path. */
+    const SampleType* getRampIfSmoothing (int index) const noexcept
+    {
+        return isSmoothing (index) ? ramps.getReadPointer (index) : nullptr;
+    }
+
+private:
+    void fillRamp (int index, int numSamples) noexcept
+    {
+        const auto i = (size_t) index;
+        const auto end = target[i];
+        const auto delta = step[i];
+        const auto lastRampSample = remainingAtBlockStart[i] - (SampleType) 1;
+
+        // value[s] = target - step * max (samplesLeftAfter (s), 0)
+        auto* row = ramps.getWritePointer (index);
+        juce::FloatVectorOperations::copy (row, sampleIndex.data(), numSamples);
+
+        Simd::forEachRegister (row, numSamples, [=] (auto ops, auto s)
+        {
+            using Ops = decltype (ops);
+            const auto left = Ops::max (Ops::sub (Ops::set (lastRampSample), s), Ops::set ((SampleType) 0));
+            return Ops::sub (Ops::set (end), Ops::mul (Ops::set (delta), left));
+        });
+    }
+
+    int numParams = 0;
+    double sampleRate = 44100.0;
+
+    std::vector<SampleType> current, target, step, remaining, remainingAtBlockStart;
+    std::vector<int> rampLength;
+    std::vector<SampleType> sampleIndex;
+    juce::AudioBuffer<SampleType> ramps;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSmootherBank)
+};
+
+} // namespace WAVFinDSP
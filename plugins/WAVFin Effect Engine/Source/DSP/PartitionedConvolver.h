@@ -0,0 +1,445 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Zero-latency convolution with a non-uniformly partitioned impulse response.
+
+    The IR is split into a head and three levels of partitions:
+    - taps 0 .. 63: a direct-form FIR, run on every sample of the audio callback
+    - taps 64 .. 2047: 64-sample partitions, FFT overlap-save on the audio thread
+    - taps 2048 .. 16383: 1024-sample partitions, on the tail worker
+    - taps 16384 onwards: 8192-sample partitions, on the tail worker
+
+    Every level uses uniformly partitioned overlap-save: each finished input block is
+    transformed once into a frequency-domain delay line, and the block's output is the
+    sum of the delay line multiplied by the IR partition spectra. A tail level with
+    partition size P starts at tap 2P, so the output of input block j is not needed
+    until one whole block after j is complete; that block period is the worker's budget.
+
+    The audio thread and the worker only share ring buffers and two counters per level:
+    the audio thread publishes each finished input block with blocksWritten (release),
+    the worker publishes each output block with blocksDone (release). Neither side
+    waits. If a tail block is not done when it is due, that block's tail is left out
+    and getNumUnderruns() counts it.
+
+    With processTailInline set (offline rendering), tail blocks are computed on the
+    audio thread as soon as their input is complete, so the output never depends on
+    worker timing.
+
+    reset() restarts the output from silence without stopping the worker. Each level
+    records the first block after the reset and counts the reset; output blocks before
+    it are never played. The worker clears its delay line itself on every reset it has
+    not seen yet, before it computes that block.
+
+    A mono IR is used for every channel, a stereo IR channel by channel. Float only,
+    because juce::dsp::FFT is.
+*/
+class PartitionedConvolver
+{
+public:
+    static constexpr int headSize = 64;
+
+    /** Builds the partition spectra. This allocates; call it off the audio thread. */
+    PartitionedConvolver (const juce::AudioBuffer<float>& impulse, int numChannels, bool processTailInline)
+        : inlineTail (processTailInline),
+          irLength (impulse.getNumSamples())
+    {
+        const auto numIrChannels = juce::jmax (1, impulse.getNumChannels());
+        const auto numPaths = juce::jmax (1, numChannels);
+
+        head.assign ((size_t) (numIrChannels * headSize), 0.0f);
+
+        for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            std::copy_n (impulse.getReadPointer (ch), juce::jmin (headSize, irLength), head.data() + ch * headSize);
+
+        paths.resize ((size_t) numPaths);
+
+        for (int ch = 0; ch < numPaths; ++ch)
+        {
+            paths[(size_t) ch].irChannel = juce::jmin (ch, numIrChannels - 1);
+            paths[(size_t) ch].history.assign ((size_t) (2 * headSize - 1), 0.0f);
+        }
+
+        int levelStart = headSize;
+
+        for (auto partitionSize : partitionSizes)
+        {
+            if (levelStart >= irLength)
+                break;
+
+            const auto delayBlocks = levelStart / partitionSize;
+            const auto levelEnd = partitionSize == partitionSizes.back() ? irLength
+                                                                         : juce::jmin (irLength, 2 * nextPartitionSize (partitionSize));
+            levels.push_back (std::make_unique<Level> (impulse, numPaths, partitionSize, delayBlocks, levelStart, levelEnd));
+            levelStart = levelEnd;
+        }
+    }
+
+    int getLength() const noexcept                 { return irLength; }
+
+    /** Tail blocks that were not ready when due (each one drops that block's tail). */
+    int getNumUnderruns() const noexcept           { return underruns.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Replaces the block with the convolution output. Audio thread only. */
+    void process (const juce::dsp::AudioBlock<float>& block) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numChannels = juce::jmin ((int) block.getNumChannels(), (int) paths.size());
+
+        for (int start = 0; start < numSamples;)
+        {
+            // Chunks never cross a head boundary, so they never cross a block of any level
+            const auto phase = (int) (samplesProcessed & (headSize - 1));
+            const auto length = juce::jmin (numSamples - start, headSize - phase);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                processChunk (paths[(size_t) ch], ch, block.getChannelPointer ((size_t) ch) + start, length);
+
+            samplesProcessed += length;
+            start += length;
+
+            if ((samplesProcessed & (headSize - 1)) == 0)
+                finishBlocks();
+        }
+    }
+
+    /** Forgets all past input, so the output restarts from silence. Audio thread only. */
+    void reset() noexcept
+    {
+        for (auto& path : paths)
+            std::fill (path.history.begin(), path.history.end(), 0.0f);
+
+        for (auto& level : levels)
+        {
+            const auto current = samplesProcessed / level->partitionSize;
+
+            // The block being filled is not read until it is finished, so it can be cleared here
+            for (auto& channel : level->channels)
+                std::fill_n (channel.input.data() + level->ringSlot (current), level->partitionSize, 0.0f);
+
+            level->firstFreshBlock.store (current, std::memory_order_relaxed);
+            level->numResets.fetch_add (1, std::memory_order_release);
+            level->outputReady = false;
+
+            // The worker may still be reading the earlier blocks, so it forgets its own (see processTail)
+            if (inlineTail || level->delayBlocks < 2)
+                level->forgetBlocksBefore (current);
+        }
+    }
+
+    /** Computes every tail block the audio thread has finished. Worker thread only. */
+    void processTail() noexcept
+    {
+        if (inlineTail)
+            return;
+
+        for (auto& level : levels)
+        {
+            if (level->delayBlocks < 2)
+                continue;
+
+            for (;;)
+            {
+                const auto written = level->blocksWritten.load (std::memory_order_acquire);
+                auto next = level->blocksDone.load (std::memory_order_relaxed);
+
+                if (next >= written)
+                    break;
+
+                // The audio thread was reset: the fresh block is computed from silence, and the
+                // blocks before it are never played. A caught-up worker is already at the fresh block.
+                if (const auto resets = level->numResets.load (std::memory_order_acquire); resets != level->resetsHandled)
+                {
+                    level->resetsHandled = resets;
+
+                    if (const auto fresh = level->firstFreshBlock.load (std::memory_order_relaxed); next <= fresh)
+                    {
+                        level->forgetBlocksBefore (fresh);
+
+                        if (next < fresh)
+                        {
+                            level->blocksDone.store (fresh, std::memory_order_release);
+                            continue;
+                        }
+                    }
+                }
+
+                // Block next - 1 is already being overwritten; restart from the newest block
+                if (written - next > ringBlocks - 2)
+                {
+                    level->clearDelayLine();
+                    next = written - 1;
+                }
+
+                level->processBlock (next);
+                level->blocksDone.store (next + 1, std::memory_order_release);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    using Ops = Simd::OpsFor<float>::type;
+
+    static constexpr std::array<int, 3> partitionSizes { 64, 1024, 8192 };
+    static constexpr int ringBlocks = 4;            // input and output blocks kept per level
+    static constexpr int binAlignment = 8;          // bins padded to the widest register
+
+    static int nextPartitionSize (int size) noexcept
+    {
+        for (size_t i = 0; i + 1 < partitionSizes.size(); ++i)
+            if (partitionSizes[i] == size)
+                return partitionSizes[i + 1];
+
+        return size;
+    }
+
+    //==============================================================================
+    struct Level
+    {
+        Level (const juce::AudioBuffer<float>& impulse, int numPaths, int size, int delay, int firstTap, int endTap)
+            : partitionSize (size),
+              delayBlocks (delay),
+              numPartitions ((endTap - firstTap + size - 1) / size),
+              numBins ((size + 1 + binAlignment - 1) / binAlignment * binAlignment),
+              fft (juce::roundToInt (std::log2 (2 * size)))
+        {
+            const auto numIrChannels = juce::jmax (1, impulse.getNumChannels());
+            const auto spectrumSize = (size_t) (numPartitions * numBins);
+
+            work.assign ((size_t) (4 * size), 0.0f);
+            accRe.assign ((size_t) numBins, 0.0f);
+            accIm.assign ((size_t) numBins, 0.0f);
+            irRe.assign (spectrumSize * (size_t) numIrChannels, 0.0f);
+            irIm.assign (irRe.size(), 0.0f);
+
+            for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            {
+                for (int k = 0; k < numPartitions; ++k)
+                {
+                    const auto tap = firstTap + k * size;
+                    std::fill (work.begin(), work.end(), 0.0f);
+                    std::copy_n (impulse.getReadPointer (ch, tap), juce::jmin (size, endTap - tap), work.data());
+
+                    fft.performRealOnlyForwardTransform (work.data(), true);
+                    deinterleave (irRe.data() + spectrumOffset (ch, k), irIm.data() + spectrumOffset (ch, k));
+                }
+            }
+
+            channels.resize ((size_t) numPaths);
+
+            for (int ch = 0; ch < numPaths; ++ch)
+            {
+                auto& channel = channels[(size_t) ch];
+                channel.irChannel = juce::jmin (ch, numIrChannels - 1);
+                channel.input.assign ((size_t) (ringBlocks * size), 0.0f);
+                channel.output.assign (channel.input.size(), 0.0f);
+                channel.fdlRe.assign (spectrumSize, 0.0f);
+                channel.fdlIm.assign (spectrumSize, 0.0f);
+            }
+        }
+
+        size_t spectrumOffset (int irChannel, int partition) const noexcept
+        {
+            return (size_t) ((irChannel * numPartitions + partition) * numBins);
+        }
+
+        int ringSlot (juce::int64 blockIndex) const noexcept    { return (int) (blockIndex & (ringBlocks - 1)) * partitionSize; }
+
+        void deinterleave (float* re, float* im) const noexcept
+        {
+            for (int b = 0; b <= partitionSize; ++b)
+            {
+                re[b] = work[(size_t) (2 * b)];
+                im[b] = work[(size_t) (2 * b + 1)];
+            }
+        }
+
+        void clearDelayLine() noexcept
+        {
+            for (auto& channel : channels)
+            {
+                std::fill (channel.fdlRe.begin(), channel.fdlRe.end(), 0.0f);
+                std::fill (channel.fdlIm.begin(), channel.fdlIm.end(), 0.0f);
+            }
+        }
+
+        /** Clears the delay line and the input block before j, so block j is computed from silence. */
+        void forgetBlocksBefore (juce::int64 j) noexcept
+        {
+            clearDelayLine();
+
+            for (auto& channel : channels)
+                std::fill_n (channel.input.data() + ringSlot (j - 1), partitionSize, 0.0f);
+        }
+
+        /** Transforms input block j into the delay line and writes output block j. */
+        void processBlock (juce::int64 j) noexcept
+        {
+            const auto slot = (int) (j % numPartitions);
+
+            for (auto& channel : channels)
+            {
+                // Overlap-save frame: [block j - 1 | block j]
+                std::copy_n (channel.input.data() + ringSlot (j - 1), partitionSize, work.data());
+                std::copy_n (channel.input.data() + ringSlot (j), partitionSize, work.data() + partitionSize);
+
+                fft.performRealOnlyForwardTransform (work.data(), true);
+                deinterleave (channel.fdlRe.data() + slot * numBins, channel.fdlIm.data() + slot * numBins);
+
+                std::fill (accRe.begin(), accRe.end(), 0.0f);
+                std::fill (accIm.begin(), accIm.end(), 0.0f);
+
+                for (int k = 0; k < numPartitions; ++k)
+                {
+                    const auto input = (size_t) (((slot - k + numPartitions) % numPartitions) * numBins);
+                    const auto filter = spectrumOffset (channel.irChannel, k);
+
+                    multiplyAccumulate (channel.fdlRe.data() + input, channel.fdlIm.data() + input,
+                                        irRe.data() + filter, irIm.data() + filter);
+                }
+
+                for (int b = 0; b <= partitionSize; ++b)
+                {
+                    work[(size_t) (2 * b)] = accRe[(size_t) b];
+                    work[(size_t) (2 * b + 1)] = accIm[(size_t) b];
+                }
+
+                fft.performRealOnlyInverseTransform (work.data());
+
+                // The second half of the frame is the part without circular wrap-around
+                std::copy_n (work.data() + partitionSize, partitionSize, channel.output.data() + ringSlot (j));
+            }
+        }
+
+        /** acc += x * h over every bin. */
+        void multiplyAccumulate (const float* xRe, const float* xIm, const float* hRe, const float* hIm) noexcept
+        {
+            auto* re = accRe.data();
+            auto* im = accIm.data();
+
+            for (int b = 0; b < numBins; b += Ops::width)
+            {
+                const auto xr = Ops::load (xRe + b), xi = Ops::load (xIm + b);
+                const auto hr = Ops::load (hRe + b), hi = Ops::load (hIm + b);
+
+                Ops::store (re + b, Ops::add (Ops::load (re + b), Ops::sub (Ops::mul (xr, hr), Ops::mul (xi, hi))));
+                Ops::store (im + b, Ops::add (Ops::load (im + b), Ops::add (Ops::mul (xr, hi), Ops::mul (xi, hr))));
+            }
+        }
+
+        struct Channel
+        {
+            int irChannel = 0;
+            std::vector<float> input, output;       // ringBlocks blocks each
+            std::vector<float> fdlRe, fdlIm;        // [partition][bin], a ring indexed by block
+        };
+
+        const int partitionSize, delayBlocks, numPartitions, numBins;
+        juce::dsp::FFT fft;
+
+        std::vector<float> irRe, irIm;              // [irChannel][partition][bin]
+        std::vector<float> work, accRe, accIm;
+        std::vector<Channel> channels;
+
+        std::atomic<juce::int64> blocksWritten { 0 }, blocksDone { 0 };
+        std::atomic<juce::int64> firstFreshBlock { 0 };     // written by reset(), published with numResets
+        std::atomic<int> numResets { 0 };
+        int resetsHandled = 0;                      // worker thread: the last numResets it has cleared for
+        bool outputReady = true;                    // audio thread: the block being played is complete
+    };
+
+    struct Path
+    {
+        int irChannel = 0;
+        std::vector<float> history;                 // headSize - 1 past samples, then the chunk
+        std::array<float, headSize> wet {};
+    };
+
+    //==============================================================================
+    void processChunk (Path& path, int channel, float* io, int length) noexcept
+    {
+        auto* history = path.history.data();
+        auto* wet = path.wet.data();
+        const auto* taps = head.data() + path.irChannel * headSize;
+
+        std::copy_n (io, length, history + headSize - 1);
+        std::fill_n (wet, length, 0.0f);
+
+        // Direct-form head: y[n] = sum h[k] x[n - k], one vector pass per tap
+        for (int k = 0; k < headSize; ++k)
+            juce::FloatVectorOperations::addWithMultiply (wet, history + headSize - 1 - k, taps[k], length);
+
+        std::copy (history + length, history + length + headSize - 1, history);
+
+        for (auto& level : levels)
+        {
+            const auto size = level->partitionSize;
+            const auto block = samplesProcessed / size;
+            const auto position = (int) (samplesProcessed & (size - 1));
+            auto& state = level->channels[(size_t) channel];
+
+            std::copy_n (io, length, state.input.data() + level->ringSlot (block) + position);
+
+            if (level->outputReady)
+                juce::FloatVectorOperations::add (wet, state.output.data() + level->ringSlot (block - level->delayBlocks) + position, length);
+        }
+
+        std::copy_n (wet, length, io);
+    }
+
+    /** Called on every head boundary: hands finished input blocks on and checks the next outputs. */
+    void finishBlocks() noexcept
+    {
+        for (auto& level : levels)
+        {
+            const auto size = level->partitionSize;
+
+            if ((samplesProcessed & (size - 1)) != 0)
+                continue;
+
+            const auto finished = samplesProcessed / size - 1;
+
+            if (inlineTail || level->delayBlocks < 2)
+            {
+                level->processBlock (finished);
+                level->blocksDone.store (finished + 1, std::memory_order_release);
+            }
+            else
+            {
+                level->blocksWritten.store (finished + 1, std::memory_order_release);
+            }
+
+            // Checked once per block, so a block is either played whole or not at all. Blocks
+            // before the start or a reset() hold no output of the current input.
+            const auto playing = samplesProcessed / size - level->delayBlocks;
+            const auto due = playing >= level->firstFreshBlock.load (std::memory_order_relaxed);
+            level->outputReady = due && level->blocksDone.load (std::memory_order_acquire) > playing;
+
+            if (due && ! level->outputReady)
+                underruns.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    //==============================================================================
+    const bool inlineTail;
+    const int irLength;
+
+    std::vector<float> head;                        // [irChannel][tap]
+    std::vector<Path> paths;
+    std::vector<std::unique_ptr<Level>> levels;
+
+    juce::int64 samplesProcessed = 0;
+    std::atomic<int> underruns { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
+
+} // namespace WAVFinDSP
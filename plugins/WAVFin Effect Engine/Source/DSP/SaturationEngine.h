@@ -0,0 +1,276 @@
+#pragma once
+
+#include "HalfBandOversampler.h"
+#include "LatencyDelay.h"
+#include "MixKernels.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Saturation stage: Tube / Tape / Diode / Digital waveshapers running inside a
+    selectable 1x-8x half-band oversampler.
+
+    The stage reports a constant latency for the chosen oversampling factor whether
+    or not it is enabled: when bypassed it simply delays the signal, so toggling
+    the module never shifts the timing of the rest of the chain.
+*/
+template <typename SampleType>
+class SaturationEngine
+{
+public:
+    enum class Type { tube = 0, tape, diode, digital };
+
+    SaturationEngine() = default;
+
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = (int) spec.numChannels;
+        sampleRate = spec.sampleRate;
+
+        oversampler.prepare (numChannels, (int) spec.maximumBlockSize);
+        dryDelay.prepare (numChannels, maxLatency());
+        dcState.assign ((size_t) numChannels, {});
+        tapeState.assign ((size_t) numChannels, {});
+
+        // 10 Hz one-pole DC blocker for the asymmetric curves
+        dcCoefficient = (SampleType) (1.0 - juce::MathConstants<double>::twoPi * 10.0 / sampleRate);
+
+        updateLatency();
+        reset();
+    }
+
+    void reset()
+    {
+        oversampler.reset();
+        dryDelay.reset();
+        std::fill (dcState.begin(), dcState.end(), DCState {});
+        std::fill (tapeState.begin(), tapeState.end(), (SampleType) 0);
+    }
+
+    /** 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x. */
+    void setOversampling (int stageIndex)
+    {
+        if (stageIndex != oversampler.getNumStages())
+        {
+            oversampler.setNumStages (stageIndex);
+            updateLatency();
+        }
+    }
+
+    int getOversamplingFactor() const noexcept   { return oversampler.getFactor(); }
+    int getLatencyInSamples() const noexcept     { return oversampler.getLatencyInSamples(); }
+
+    void setParameters (Type newType, SampleType newDriveDecibels, SampleType newMix)
+    {
+        type = newType;
+        driveDecibels = newDriveDecibels;
+        drive = juce::Decibels::decibelsToGain (driveDecibels);
+        mix = juce::jlimit ((SampleType) 0, (SampleType) 1, newMix);
+
+        // Output normalisation so a full-scale input comes out at full scale.
+        // Computed once here rather than per sample.
+        switch (type)
+        {
+            case Type::tube:
+                // Average of the two (unequal) peaks, so the DC-blocked output sits near +/-1
+                makeup = (SampleType) 2 / (std::tanh (drive + bias) - std::tanh (bias - drive));
+                break;
+
+            case Type::tape:
+            {
+                const auto peak = std::tanh (drive);
+                makeup = (SampleType) 1 / (peak * ((SampleType) 1 - tapeCompression * peak * peak));
+                break;
+            }
+
+            case Type::diode:
+            {
+                const auto peak = juce::jmin (drive, (SampleType) 1);
+                makeup = (SampleType) 1 / (((SampleType) 1.5 - (SampleType) 0.5 * peak * peak) * peak);
+                break;
+            }
+
+            case Type::digital:
+            {
+                makeup = (SampleType) 1 / juce::jmin (drive, (SampleType) 1);
+
+                // 0 dB drive -> 16 bits, 48 dB -> 4 bits
+                const auto bits = (SampleType) 16 - driveDecibels * (SampleType) 0.25;
+                quantiseLevels = std::pow ((SampleType) 2, juce::jmax ((SampleType) 4, bits) - (SampleType) 1);
+                break;
+            }
+        }
+    }
+
+    /** Processes in place. dryScratch must hold at least as many channels/samples as the block.
+
+        driveRampDecibels and mixRamp are optional per-sample values for a parameter that
+        is moving; the block then ramps towards the values last passed to setParameters().
+    */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context,
+                  juce::dsp::AudioBlock<SampleType> dryScratch,
+                  const SampleType* driveRampDecibels = nullptr,
+                  const SampleType* mixRamp = nullptr)
+    {
+        auto block = context.getOutputBlock();
+
+        if (context.isBypassed)
+        {
+            dryDelay.process (block);
+            return;
+        }
+
+        dryScratch.copyFrom (block);
+        dryDelay.process (dryScratch);
+
+        // The shapers take a constant drive, so a moving drive is applied as a base-rate
+        // gain relative to the block-end drive before upsampling.
+        if (driveRampDecibels != nullptr)
+            applyDriveRamp (block, driveRampDecibels);
+
+        if (oversampler.getNumStages() > 0)
+        {
+            auto oversampled = oversampler.processSamplesUp (block);
+            shape (oversampled);
+            oversampler.processSamplesDown (block);
+        }
+        else
+        {
+            shape (block);
+        }
+
+        // DC blocking and the dry/wet blend share one pass over each channel
+        const bool removeDC = type == Type::tube || type == Type::tape;
+        const Kernels::BlockValue<SampleType> mixValue { mixRamp, mix };
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            auto* wet = block.getChannelPointer (ch);
+            const auto* dry = dryScratch.getChannelPointer (ch);
+            const auto numSamples = (int) block.getNumSamples();
+
+            if (removeDC)
+            {
+                // Recursive, so scalar; the blend rides along while the sample is in a register
+                auto dc = dcState[ch];
+                for (int s = 0; s < numSamples; ++s)
+                {
+                    const auto x = wet[s];
+                    dc.y = x - dc.x + dcCoefficient * dc.y;
+                    dc.x = x;
+
+                    const auto m = mixRamp != nullptr ? mixRamp[s] : mix;
+                    wet[s] = dry[s] + (dc.y - dry[s]) * m;
+                }
+                dcState[ch] = dc;
+            }
+            else
+            {
+                Kernels::blendBlock (wet, dry, wet, numSamples, mixValue);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    void shape (juce::dsp::AudioBlock<SampleType>& block)
+    {
+        const auto numSamples = (int) block.getNumSamples();
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            auto* x = block.getChannelPointer (ch);
+
+            switch (type)
+            {
+                case Type::tube:
+                    // Asymmetric soft clip: bias shifts the operating point like a triode
+                    Kernels::tanhBlock (x, numSamples, drive, bias, -std::tanh (bias), makeup);
+                    break;
+
+                case Type::tape:
+                {
+                    // Slope-dependent term widens the transfer curve on fast edges, a cheap
+                    // stand-in for hysteresis; scaled so it is factor-independent.
+                    const auto hysteresis = (SampleType) 0.03 * (SampleType) oversampler.getFactor();
+                    auto previous = tapeState[ch];
+                    for (int s = 0; s < numSamples; ++s)
+                    {
+                        const auto driven = x[s] * drive;
+                        x[s] = driven + hysteresis * (driven - previous);
+                        previous = driven;
+                    }
+                    tapeState[ch] = previous;
+
+                    Kernels::tanhBlock (x, numSamples);
+
+                    // Gentle peak compression on the saturated curve
+                    for (int s = 0; s < numSamples; ++s)
+                        x[s] = x[s] * ((SampleType) 1 - tapeCompression * x[s] * x[s]) * makeup;
+                    break;
+                }
+
+                case Type::diode:
+                    // Hard-knee cubic: linear-ish up to the knee, flat beyond +/-1
+                    Kernels::softClipBlock (x, numSamples, drive, makeup);
+                    break;
+
+                case Type::digital:
+                {
+                    // Hard clip and bit reduction
+                    Kernels::hardClipBlock (x, numSamples, drive, (SampleType) 1);
+
+                    const auto step = makeup / quantiseLevels;
+                    for (int s = 0; s < numSamples; ++s)
+                        x[s] = std::round (x[s] * quantiseLevels) * step;
+                    break;
+                }
+            }
+        }
+    }
+
+    void applyDriveRamp (juce::dsp::AudioBlock<SampleType>& block, const SampleType* rampDecibels)
+    {
+        constexpr auto decibelsToNepers = (SampleType) 0.11512925464970229; // ln (10) / 20
+        const auto numSamples = (int) block.getNumSamples();
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            auto* x = block.getChannelPointer (ch);
+            for (int s = 0; s < numSamples; ++s)
+                x[s] *= std::exp ((rampDecibels[s] - driveDecibels) * decibelsToNepers);
+        }
+    }
+
+    void updateLatency()
+    {
+        dryDelay.setDelay (oversampler.getLatencyInSamples());
+    }
+
+    static int maxLatency()
+    {
+        return HalfBandOversampler<SampleType>::getLatencyForStages (HalfBandOversampler<SampleType>::maxNumStages);
+    }
+
+    static constexpr SampleType bias = (SampleType) 0.25;
+    static constexpr SampleType tapeCompression = (SampleType) 0.15;
+
+    struct DCState { SampleType x = 0, y = 0; };
+
+    HalfBandOversampler<SampleType> oversampler;
+    LatencyDelay<SampleType> dryDelay;
+    std::vector<DCState> dcState;
+    std::vector<SampleType> tapeState;
+
+    Type type = Type::tube;
+    SampleType driveDecibels = 0, drive = 1, mix = 1, makeup = 1;
+    SampleType quantiseLevels = 32768, dcCoefficient = (SampleType) 0.999;
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SaturationEngine)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Per-instance pool of scratch audio buffers.
+
+    All memory is reserved in prepare() for a fixed number of slots, each sized to
+    the maximum channel count and block size. During processing a stage asks for a
+    slot and receives an AudioBlock view onto that memory, so the audio callback
+    never has to allocate a temporary buffer.
+*/
+template <typename SampleType>
+class ScratchArena
+{
+public:
+    ScratchArena() = default;
+
+    /** Reserves numSlots buffers of maxChannels x maxSamples. Call from prepareToPlay(). */
+    void prepare (int numSlots, int maxChannels, int maxSamples)
+    {
+        slotCount = juce::jmax (1, numSlots);
+        channelsPerSlot = juce::jmax (1, maxChannels);
+        samplesPerSlot = juce::jmax (1, maxSamples);
+
+        storage.setSize (slotCount * channelsPerSlot, samplesPerSlot, false, true, false);
+    }
+
+    /** Frees the reserved memory. Call from releaseResources(). */
+    void release()
+    {
+        storage.setSize (0, 0);
+        slotCount = channelsPerSlot = samplesPerSlot = 0;
+    }
+
+    /** Returns a view of numChannels x numSamples from the given slot. Contents are undefined. */
+    juce::dsp::AudioBlock<SampleType> getBlock (int slot, int numChannels, int numSamples)
+    {
+        jassert (slot >= 0 && slot < slotCount);
+        jassert (numChannels <= channelsPerSlot);
+        jassert (numSamples <= samplesPerSlot);
+
+        return juce::dsp::AudioBlock<SampleType> (storage)
+                   .getSubsetChannelBlock ((size_t) (slot * channelsPerSlot), (size_t) numChannels)
+                   .getSubBlock (0, (size_t) numSamples);
+    }
+
+    /** Returns a slot view holding a copy of the given buffer. */
+    juce::dsp::AudioBlock<SampleType> copyOf (int slot, const juce::AudioBuffer<SampleType>& source)
+    {
+        auto block = getBlock (slot, source.getNumChannels(), source.getNumSamples());
+        block.copyFrom (source);
+        return block;
+    }
+
+    int getMaxChannels() const noexcept    { return channelsPerSlot; }
+    int getMaxBlockSize() const noexcept   { return samplesPerSlot; }
+
+private:
+    juce::AudioBuffer<SampleType> storage;
+    int slotCount = 0;
+    int channelsPerSlot = 0;
+    int samplesPerSlot = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScratchArena)
+};
+
+} // namespace WAVFinDSP
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined (__AVX__)
+ #include <immintrin.h>
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define WAVFIN_SIMD_SSE2 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define WAVFIN_SIMD_NEON 1
+#endif
+
+namespace WAVFinDSP
+{
+
+/**
+    Register-width arithmetic for the SIMD kernels.
+
+    OpsFor<T>::type is the widest register available for T on the build target
+    (AVX, SSE2 or NEON), or ScalarOps<T> where there is none. Kernels are written
+    once against the Ops interface and run unchanged on every ISA, with ScalarOps
+    handling the remainder of each block.
+*/
+namespace Simd
+{
+
+    /** Register-width operations for one ISA. Width 1 is the scalar fallback. */
+    template <typename T>
+    struct ScalarOps
+    {
+        using Reg = T;
+        static constexpr int width = 1;
+
+        static Reg load (const T* p) noexcept       { return *p; }
+        static void store (T* p, Reg v) noexcept    { *p = v; }
+        static Reg set (T v) noexcept               { return v; }
+        static Reg add (Reg a, Reg b) noexcept      { return a + b; }
+        static Reg sub (Reg a, Reg b) noexcept      { return a - b; }
+        static Reg mul (Reg a, Reg b) noexcept      { return a * b; }
+        static Reg div (Reg a, Reg b) noexcept      { return a / b; }
+        static Reg min (Reg a, Reg b) noexcept      { return std::min (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return std::max (a, b); }
+        static Reg abs (Reg a) noexcept             { return std::abs (a); }
+        static Reg copySign (Reg mag, Reg sgn) noexcept { return std::copysign (mag, sgn); }
+        static bool anyGreater (Reg a, Reg b) noexcept  { return a > b; }
+    };
+
+   #if defined (__AVX__)
+    template <typename T> struct VectorOps;
+
+    template <>
+    struct VectorOps<float>
+    {
+        using Reg = __m256;
+        static constexpr int width = 8;
+
+        static Reg load (const float* p) noexcept   { return _mm256_loadu_ps (p); }
+        static void store (float* p, Reg v) noexcept { _mm256_storeu_ps (p, v); }
+        static Reg set (float v) noexcept           { return _mm256_set1_ps (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return _mm256_add_ps (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return _mm256_sub_ps (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return _mm256_mul_ps (a, b); }
+        static Reg div (Reg a, Reg b) noexcept      { return _mm256_div_ps (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return _mm256_min_ps (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return _mm256_max_ps (a, b); }
+        static Reg abs (Reg a) noexcept             { return _mm256_andnot_ps (_mm256_set1_ps (-0.0f), a); }
+        static bool anyGreater (Reg a, Reg b) noexcept { return _mm256_movemask_ps (_mm256_cmp_ps (a, b, _CMP_GT_OQ)) != 0; }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            const auto signMask = _mm256_set1_ps (-0.0f);
+            return _mm256_or_ps (_mm256_andnot_ps (signMask, mag), _mm256_and_ps (signMask, sgn));
+        }
+    };
+
+    template <>
+    struct VectorOps<double>
+    {
+        using Reg = __m256d;
+        static constexpr int width = 4;
+
+        static Reg load (const double* p) noexcept  { return _mm256_loadu_pd (p); }
+        static void store (double* p, Reg v) noexcept { _mm256_storeu_pd (p, v); }
+        static Reg set (double v) noexcept          { return _mm256_set1_pd (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return _mm256_add_pd (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return _mm256_sub_pd (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return _mm256_mul_pd (a, b); }
+        static Reg div (Reg a, Reg b) noexcept      { return _mm256_div_pd (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return _mm256_min_pd (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return _mm256_max_pd (a, b); }
+        static Reg abs (Reg a) noexcept             { return _mm256_andnot_pd (_mm256_set1_pd (-0.0), a); }
+        static bool anyGreater (Reg a, Reg b) noexcept { return _mm256_movemask_pd (_mm256_cmp_pd (a, b, _CMP_GT_OQ)) != 0; }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            const auto signMask = _mm256_set1_pd (-0.0);
+            return _mm256_or_pd (_mm256_andnot_pd (signMask, mag), _mm256_and_pd (signMask, sgn));
+        }
+    };
+
+    #define WAVFIN_SIMD_HAS_DOUBLE 1
+
+   #elif WAVFIN_SIMD_SSE2
+    template <typename T> struct VectorOps;
+
+    template <>
+    struct VectorOps<float>
+    {
+        using Reg = __m128;
+        static constexpr int width = 4;
+
+        static Reg load (const float* p) noexcept   { return _mm_loadu_ps (p); }
+        static void store (float* p, Reg v) noexcept { _mm_storeu_ps (p, v); }
+        static Reg set (float v) noexcept           { return _mm_set1_ps (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return _mm_add_ps (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return _mm_sub_ps (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return _mm_mul_ps (a, b); }
+        static Reg div (Reg a, Reg b) noexcept      { return _mm_div_ps (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return _mm_min_ps (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return _mm_max_ps (a, b); }
+        static Reg abs (Reg a) noexcept             { return _mm_andnot_ps (_mm_set1_ps (-0.0f), a); }
+        static bool anyGreater (Reg a, Reg b) noexcept { return _mm_movemask_ps (_mm_cmpgt_ps (a, b)) != 0; }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            const auto signMask = _mm_set1_ps (-0.0f);
+            return _mm_or_ps (_mm_andnot_ps (signMask, mag), _mm_and_ps (signMask, sgn));
+        }
+    };
+
+    template <>
+    struct VectorOps<double>
+    {
+        using Reg = __m128d;
+        static constexpr int width = 2;
+
+        static Reg load (const double* p) noexcept  { return _mm_loadu_pd (p); }
+        static void store (double* p, Reg v) noexcept { _mm_storeu_pd (p, v); }
+        static Reg set (double v) noexcept          { return _mm_set1_pd (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return _mm_add_pd (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return _mm_sub_pd (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return _mm_mul_pd (a, b); }
+        static Reg div (Reg a, Reg b) noexcept      { return _mm_div_pd (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return _mm_min_pd (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return _mm_max_pd (a, b); }
+        static Reg abs (Reg a) noexcept             { return _mm_andnot_pd (_mm_set1_pd (-0.0), a); }
+        static bool anyGreater (Reg a, Reg b) noexcept { return _mm_movemask_pd (_mm_cmpgt_pd (a, b)) != 0; }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            const auto signMask = _mm_set1_pd (-0.0);
+            return _mm_or_pd (_mm_andnot_pd (signMask, mag), _mm_and_pd (signMask, sgn));
+        }
+    };
+
+    #define WAVFIN_SIMD_HAS_DOUBLE 1
+
+   #elif WAVFIN_SIMD_NEON
+    template <typename T> struct VectorOps;
+
+    template <>
+    struct VectorOps<float>
+    {
+        using Reg = float32x4_t;
+        static constexpr int width = 4;
+
+        static Reg load (const float* p) noexcept   { return vld1q_f32 (p); }
+        static void store (float* p, Reg v) noexcept { vst1q_f32 (p, v); }
+        static Reg set (float v) noexcept           { return vdupq_n_f32 (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return vaddq_f32 (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return vsubq_f32 (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return vmulq_f32 (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return vminq_f32 (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return vmaxq_f32 (a, b); }
+        static Reg abs (Reg a) noexcept             { return vabsq_f32 (a); }
+        static bool anyGreater (Reg a, Reg b) noexcept
+        {
+            const auto mask = vcgtq_f32 (a, b);
+           #if defined (__aarch64__)
+            return vmaxvq_u32 (mask) != 0;
+           #else
+            const auto half = vorr_u32 (vget_low_u32 (mask), vget_high_u32 (mask));
+            return vget_lane_u32 (vpmax_u32 (half, half), 0) != 0;
+           #endif
+        }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            return vbslq_f32 (vdupq_n_u32 (0x80000000u), sgn, vabsq_f32 (mag));
+        }
+
+        static Reg div (Reg a, Reg b) noexcept
+        {
+           #if defined (__aarch64__)
+            return vdivq_f32 (a, b);
+           #else
+            // ARMv7 has no vector divide: reciprocal estimate + two Newton steps
+            auto r = vrecpeq_f32 (b);
+            r = vmulq_f32 (vrecpsq_f32 (b, r), r);
+            r = vmulq_f32 (vrecpsq_f32 (b, r), r);
+            return vmulq_f32 (a, r);
+           #endif
+        }
+    };
+
+   #if defined (__aarch64__)
+    template <>
+    struct VectorOps<double>
+    {
+        using Reg = float64x2_t;
+        static constexpr int width = 2;
+
+        static Reg load (const double* p) noexcept  { return vld1q_f64 (p); }
+        static void store (double* p, Reg v) noexcept { vst1q_f64 (p, v); }
+        static Reg set (double v) noexcept          { return vdupq_n_f64 (v); }
+        static Reg add (Reg a, Reg b) noexcept      { return vaddq_f64 (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept      { return vsubq_f64 (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept      { return vmulq_f64 (a, b); }
+        static Reg div (Reg a, Reg b) noexcept      { return vdivq_f64 (a, b); }
+        static Reg min (Reg a, Reg b) noexcept      { return vminq_f64 (a, b); }
+        static Reg max (Reg a, Reg b) noexcept      { return vmaxq_f64 (a, b); }
+        static Reg abs (Reg a) noexcept             { return vabsq_f64 (a); }
+        static bool anyGreater (Reg a, Reg b) noexcept { return vmaxvq_u32 (vreinterpretq_u32_u64 (vcgtq_f64 (a, b))) != 0; }
+        static Reg copySign (Reg mag, Reg sgn) noexcept
+        {
+            return vbslq_f64 (vdupq_n_u64 (0x8000000000000000ull), sgn, vabsq_f64 (mag));
+        }
+    };
+
+    #define WAVFIN_SIMD_HAS_DOUBLE 1
+   #endif
+   #endif
+
+    /** Picks the widest register type available for T. */
+   #if defined (__AVX__) || WAVFIN_SIMD_SSE2 || WAVFIN_SIMD_NEON
+    template <typename T, typename = void> struct OpsFor            { using type = ScalarOps<T>; };
+    template <> struct OpsFor<float>                                { using type = VectorOps<float>; };
+   #if WAVFIN_SIMD_HAS_DOUBLE
+    template <> struct OpsFor<double>                               { using type = VectorOps<double>; };
+   #endif
+   #else
+    template <typename T> struct OpsFor                             { using type = ScalarOps<T>; };
+   #endif
+
+    //==============================================================================
+    /** Two-lane operations holding one sample of a left and a right channel, for
+        recursive filters that cannot be vectorised along time but can across a stereo pair.
+        The scalar fallback keeps the two lanes in a plain struct. */
+    template <typename T>
+    struct ScalarStereoOps
+    {
+        struct Reg { T l, r; };
+
+        static Reg set (T v) noexcept                           { return { v, v }; }
+        static Reg load (const T* l, const T* r) noexcept       { return { *l, *r }; }
+        static void store (T* l, T* r, Reg v) noexcept          { *l = v.l; *r = v.r; }
+        static Reg add (Reg a, Reg b) noexcept                  { return { a.l + b.l, a.r + b.r }; }
+        static Reg sub (Reg a, Reg b) noexcept                  { return { a.l - b.l, a.r - b.r }; }
+        static Reg mul (Reg a, Reg b) noexcept                  { return { a.l * b.l, a.r * b.r }; }
+    };
+
+   #if defined (__AVX__) || WAVFIN_SIMD_SSE2
+    template <typename T> struct StereoOps                      : ScalarStereoOps<T> {};
+
+    template <>
+    struct StereoOps<float>
+    {
+        using Reg = __m128; // lanes 0 and 1
+
+        static Reg set (float v) noexcept                       { return _mm_set1_ps (v); }
+        static Reg load (const float* l, const float* r) noexcept { return _mm_unpacklo_ps (_mm_load_ss (l), _mm_load_ss (r)); }
+        static void store (float* l, float* r, Reg v) noexcept
+        {
+            _mm_store_ss (l, v);
+            _mm_store_ss (r, _mm_shuffle_ps (v, v, _MM_SHUFFLE (1, 1, 1, 1)));
+        }
+        static Reg add (Reg a, Reg b) noexcept                  { return _mm_add_ps (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept                  { return _mm_sub_ps (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept                  { return _mm_mul_ps (a, b); }
+    };
+
+    template <>
+    struct StereoOps<double>
+    {
+        using Reg = __m128d;
+
+        static Reg set (double v) noexcept                      { return _mm_set1_pd (v); }
+        static Reg load (const double* l, const double* r) noexcept { return _mm_loadh_pd (_mm_load_sd (l), r); }
+        static void store (double* l, double* r, Reg v) noexcept { _mm_storel_pd (l, v); _mm_storeh_pd (r, v); }
+        static Reg add (Reg a, Reg b) noexcept                  { return _mm_add_pd (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept                  { return _mm_sub_pd (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept                  { return _mm_mul_pd (a, b); }
+    };
+   #elif WAVFIN_SIMD_NEON
+    template <typename T> struct StereoOps                      : ScalarStereoOps<T> {};
+
+    template <>
+    struct StereoOps<float>
+    {
+        using Reg = float32x2_t;
+
+        static Reg set (float v) noexcept                       { return vdup_n_f32 (v); }
+        static Reg load (const float* l, const float* r) noexcept { return vld1_lane_f32 (r, vld1_dup_f32 (l), 1); }
+        static void store (float* l, float* r, Reg v) noexcept  { vst1_lane_f32 (l, v, 0); vst1_lane_f32 (r, v, 1); }
+        static Reg add (Reg a, Reg b) noexcept                  { return vadd_f32 (a, b); }
+        static Reg sub (Reg a, Reg b) noexcept                  { return vsub_f32 (a, b); }
+        static Reg mul (Reg a, Reg b) noexcept                  { return vmul_f32 (a, b); }
+    };
+   #else
+    template <typename T> struct StereoOps                      : ScalarStereoOps<T> {};
+   #endif
+
+    //==============================================================================
+    /** Runs fn over the block in full registers, then the remainder with the scalar ops. */
+    template <typename T, typename Fn>
+    inline void forEachRegister (T* data, int numSamples, Fn&& fn) noexcept
+    {
+        using Ops = typename OpsFor<T>::type;
+        int i = 0;
+
+        if constexpr (Ops::width > 1)
+            for (; i + Ops::width <= numSamples; i += Ops::width)
+                Ops::store (data + i, fn (Ops {}, Ops::load (data + i)));
+
+        for (; i < numSamples; ++i)
+            data[i] = fn (ScalarOps<T> {}, data[i]);
+    }
+
+    /** Calls fn (ops, index) for each full register of a block, then for each remaining
+        sample with the scalar ops. For kernels that read several buffers at once. */
+    template <typename T, typename Fn>
+    inline void forEachIndex (int numSamples, Fn&& fn) noexcept
+    {
+        using Ops = typename OpsFor<T>::type;
+        int i = 0;
+
+        if constexpr (Ops::width > 1)
+            for (; i + Ops::width <= numSamples; i += Ops::width)
+                fn (Ops {}, i);
+
+        for (; i < numSamples; ++i)
+            fn (ScalarOps<T> {}, i);
+    }
+
+} // namespace Simd
+} // namespace WAVFinDSP
@@ -0,0 +1,249 @@
+#include "SpectrumAnalyzer.h"
+
+namespace WAVFinDSP
+{
+
+namespace
+{
+    // The displayed range; the top is lowered to Nyquist at low sample rates
+    constexpr double minDisplayHz = 20.0, maxDisplayHz = 20000.0;
+
+    // Time constant of the per-band power average
+    constexpr double averagingSeconds = 0.1;
+
+    // Quieter bands are shown at this level
+    constexpr float floorDb = -120.0f;
+
+    // How long the worker sleeps between passes; well under a frame at maxFramesPerSecond
+    constexpr int pollIntervalMs = 10;
+}
+
+//==============================================================================
+class SpectrumAnalyzer::AnalysisThread  : public juce::Thread
+{
+public:
+    explicit AnalysisThread (SpectrumAnalyzer& a) : juce::Thread ("WAVFin spectrum"), analyzer (a) {}
+
+    void run() override
+    {
+        // Whatever queued up before this reader attached is stale
+        analyzer.discardQueuedSamples();
+
+        // Polls, so the audio thread never has to signal it
+        while (! threadShouldExit())
+        {
+            analyzer.analyse();
+            wait (pollIntervalMs);
+        }
+    }
+
+private:
+    SpectrumAnalyzer& analyzer;
+};
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : window ((size_t) fftSize), fftData ((size_t) fftSize * 2),
+      worker (std::make_unique<AnalysisThread> (*this))
+{
+    for (auto& ring : rings)
+        ring.samples.resize ((size_t) ringSize);
+
+    for (auto& samples : history)
+        samples.resize ((size_t) fftSize);
+
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) fftSize,
+                                                              juce::dsp::WindowingFunction<float>::hann, false);
+
+    // A sine of amplitude A peaks at A * sum (window) / 2 in its bin
+    float windowSum = 0;
+    for (auto w : window)
+        windowSum += w;
+
+    magnitudeScale = 2.0f / windowSum;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    active.store (false, std::memory_order_relaxed);
+    worker->stopThread (1000);
+}
+
+void SpectrumAnalyzer::attachReader()
+{
+    if (numReaders++ == 0)
+    {
+        active.store (true, std::memory_order_relaxed);
+        worker->startThread (juce::Thread::Priority::low);
+    }
+}
+
+void SpectrumAnalyzer::detachReader()
+{
+    jassert (numReaders > 0);
+
+    if (--numReaders == 0)
+    {
+        active.store (false, std::memory_order_relaxed);
+        worker->stopThread (1000);
+    }
+}
+
+void SpectrumAnalyzer::setOverlap (int overlap) noexcept
+{
+    int hops = 1;
+
+    while (hops * 2 <= juce::jmin (overlap, maxOverlap))
+        hops *= 2;
+
+    hopsPerWindow.store (hops, std::memory_order_relaxed);
+}
+
+bool SpectrumAnalyzer::getLatestFrame (Frame& frame) noexcept
+{
+    if (! frames.update())
+        return false;
+
+    frame = frames.read();
+    return true;
+}
+
+//==============================================================================
+void SpectrumAnalyzer::discardQueuedSamples() noexcept
+{
+    for (auto& ring : rings)
+        ring.fifo.finishedRead (ring.fifo.getNumReady());
+
+    historyFill = {};
+
+    for (auto& power : bandPower)
+        power.fill (0.0f);
+}
+
+void SpectrumAnalyzer::analyse() noexcept
+{
+    const auto sampleRate = currentSampleRate.load (std::memory_order_relaxed);
+    const auto useLog = logFrequency.load (std::memory_order_relaxed);
+
+    if (sampleRate != mappedSampleRate || useLog != mappedLog)
+        mapBands (sampleRate, useLog);
+
+    const auto hop = fftSize / hopsPerWindow.load (std::memory_order_relaxed);
+    const auto smoothing = (float) (1.0 - std::exp (-(double) hop / (sampleRate * averagingSeconds)));
+
+    for (int tap = 0; tap < numTaps; ++tap)
+    {
+        auto& ring = rings[(size_t) tap];
+        auto& samples = history[(size_t) tap];
+
+        // After a stall only the newest window matters; the older samples are skipped
+        if (const auto excess = ring.fifo.getNumReady() - fftSize; excess > 0)
+            ring.fifo.finishedRead (excess);
+
+        while (ring.fifo.getNumReady() >= hop)
+        {
+            std::copy (samples.begin() + hop, samples.end(), samples.begin());
+
+            const auto scope = ring.fifo.read (hop);
+            auto* dest = samples.data() + fftSize - hop;
+            std::copy_n (ring.samples.data() + scope.startIndex1, scope.blockSize1, dest);
+            std::copy_n (ring.samples.data() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+
+            auto& fill = historyFill[(size_t) tap];
+            fill = juce::jmin (fftSize, fill + hop);
+
+            if (fill == fftSize)
+                analyseTap (tap, smoothing);
+        }
+    }
+
+    const auto nowMs = juce::Time::getMillisecondCounterHiRes();
+
+    if (hasNewPower && nowMs - lastPublishMs >= 1000.0 / maxFramesPerSecond)
+    {
+        publishFrame();
+        lastPublishMs = nowMs;
+    }
+}
+
+void SpectrumAnalyzer::analyseTap (int tap, float smoothing) noexcept
+{
+    juce::FloatVectorOperations::multiply (fftData.data(), history[(size_t) tap].data(), window.data(), fftSize);
+    juce::FloatVectorOperations::clear (fftData.data() + fftSize, fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    // Each band takes its loudest bin, so a sine reads the same in a narrow band as in a wide one
+    auto& power = bandPower[(size_t) tap];
+
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        const auto& band = bands[b];
+        float magnitude = 0;
+
+        if (band.firstBin < band.endBin)
+        {
+            magnitude = juce::FloatVectorOperations::findMaximum (fftData.data() + band.firstBin, band.endBin - band.firstBin);
+        }
+        else
+        {
+            const auto bin = juce::jmin ((int) band.centreBin, fftSize / 2 - 1);
+            const auto fraction = band.centreBin - (float) bin;
+            magnitude = fftData[(size_t) bin] + fraction * (fftData[(size_t) bin + 1] - fftData[(size_t) bin]);
+        }
+
+        const auto bandLevel = juce::square (magnitude * magnitudeScale);
+        power[b] += smoothing * (bandLevel - power[b]);
+    }
+
+    hasNewPower = true;
+}
+
+void SpectrumAnalyzer::mapBands (double sampleRate, bool useLog) noexcept
+{
+    mappedSampleRate = sampleRate;
+    mappedLog = useLog;
+
+    minHz = (float) minDisplayHz;
+    maxHz = (float) juce::jmin (maxDisplayHz, sampleRate * 0.5);
+    const auto binHz = sampleRate / fftSize;
+
+    auto edgeHz = [&] (int edge)
+    {
+        const auto proportion = (double) edge / numBands;
+        return useLog ? minHz * std::pow ((double) maxHz / minHz, proportion)
+                      : minHz + (maxHz - minHz) * proportion;
+    };
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        const auto low = edgeHz (b), high = edgeHz (b + 1);
+        auto& band = bands[(size_t) b];
+
+        band.firstBin = juce::jmin ((int) std::ceil (low / binHz), fftSize / 2 + 1);
+        band.endBin = juce::jmin ((int) std::ceil (high / binHz), fftSize / 2 + 1);
+        band.centreBin = (float) ((useLog ? std::sqrt (low * high) : (low + high) * 0.5) / binHz);
+    }
+
+    // The averages belong to the old bands
+    for (auto& power : bandPower)
+        power.fill (0.0f);
+}
+
+void SpectrumAnalyzer::publishFrame() noexcept
+{
+    auto& frame = frames.getWriteSlot();
+
+    for (size_t tap = 0; tap < bandPower.size(); ++tap)
+        for (size_t b = 0; b < (size_t) numBands; ++b)
+            frame.levels[tap][b] = juce::jmax (floorDb, 10.0f * std::log10 (bandPower[tap][b] + 1.0e-20f));
+
+    frame.minHz = minHz;
+    frame.maxHz = maxHz;
+    frame.logFrequency = mappedLog;
+    frame.frameNumber = ++framesPublished;
+    frames.publish();
+
+    hasNewPower = false;
+}
+
+} // namespace WAVFinDSP
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "TripleBuffer.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Spectrum of the chain's input and output for the editor, analysed off the audio thread.
+
+    The audio thread only copies the mono mix of each block into a ring per tap, a fixed
+    buffer indexed by juce::AbstractFifo; if a ring is full the rest of the block is dropped.
+    A worker thread takes the samples a hop at a time, runs a Hann-windowed FFT over the
+    last fftSize samples of each tap, groups the bins into bands (log or linear spaced) and
+    averages each band's power over time. At most maxFramesPerSecond times a second it
+    publishes the band levels through a TripleBuffer.
+
+    Everything is allocated by the constructor, so the memory used is the same whatever the
+    sample rate or settings. The worker only runs while a reader is attached; with none,
+    pushSamples() returns straight away and no thread is running.
+*/
+class SpectrumAnalyzer
+{
+public:
+    enum Tap
+    {
+        inputTap = 0,       // before the chain
+        outputTap,          // after the output gain, limiter and global mix
+        numTaps
+    };
+
+    static constexpr int fftOrder = 12, fftSize = 1 << fftOrder;
+    static constexpr int numBands = 128;
+    static constexpr int maxOverlap = 8;
+    static constexpr int maxFramesPerSecond = 30;
+
+    /** Samples each tap's ring holds: over 80 ms at 192 kHz, several times the worker's poll interval. */
+    static constexpr int ringSize = 1 << 14;
+
+    /** Band levels of both taps in dBFS. A full-scale sine reads 0 dB in the band holding it. */
+    struct Frame
+    {
+        std::array<std::array<float, numBands>, numTaps> levels {};
+        float minHz = 0, maxHz = 0;     // lower edge of the first band, upper edge of the last
+        bool logFrequency = true;       // bands evenly spaced in log frequency; otherwise in Hz
+        juce::uint32 frameNumber = 0;   // counts up from 1; 0 until the first frame
+    };
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer();
+
+    /** Sets the rate of the incoming audio. Any thread; the worker picks it up on its next pass. */
+    void prepare (double sampleRate) noexcept       { currentSampleRate.store (sampleRate, std::memory_order_relaxed); }
+
+    /** Audio thread: queues the block's mono mix for the tap, while a reader is attached. */
+    template <typename SampleType>
+    void pushSamples (Tap tap, const juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        const auto numChannels = buffer.getNumChannels();
+
+        if (! active.load (std::memory_order_relaxed) || numChannels == 0)
+            return;
+
+        auto& ring = rings[(size_t) tap];
+        const auto scope = ring.fifo.write (juce::jmin (buffer.getNumSamples(), ring.fifo.getFreeSpace()));
+        const auto gain = (SampleType) 1 / (SampleType) numChannels;
+
+        auto mixInto = [&] (int start, int count, int offset)
+        {
+            auto* dest = ring.samples.data() + start;
+
+            for (int i = 0; i < count; ++i)
+            {
+                SampleType sum = 0;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    sum += buffer.getReadPointer (ch)[offset + i];
+
+                dest[i] = (float) (sum * gain);
+            }
+        };
+
+        mixInto (scope.startIndex1, scope.blockSize1, 0);
+        mixInto (scope.startIndex2, scope.blockSize2, scope.blockSize1);
+    }
+
+    //==============================================================================
+    /** Message thread: the first reader starts the worker and the last one to leave stops it. */
+    void attachReader();
+    void detachReader();
+
+    /** FFTs per fftSize samples: 1, 2, 4 or 8 (other values round down to one of these). Any thread. */
+    void setOverlap (int overlap) noexcept;
+
+    /** Log-spaced bands (the default) or linear ones. Any thread. */
+    void setLogFrequency (bool shouldUseLog) noexcept      { logFrequency.store (shouldUseLog, std::memory_order_relaxed); }
+
+    /** Reader: copies the newest frame, returning false if none arrived since the last call.
+        One reader thread only, normally the message thread. */
+    bool getLatestFrame (Frame& frame) noexcept;
+
+private:
+    //==============================================================================
+    class AnalysisThread;
+
+    void discardQueuedSamples() noexcept;
+    void analyse() noexcept;
+    void analyseTap (int tap, float smoothing) noexcept;
+    void mapBands (double sampleRate, bool useLog) noexcept;
+    void publishFrame() noexcept;
+
+    //==============================================================================
+    // Audio thread -> worker
+    struct Ring
+    {
+        juce::AbstractFifo fifo { ringSize };
+        std::vector<float> samples;
+    };
+
+    std::array<Ring, numTaps> rings;
+    std::atomic<bool> active { false };
+    int numReaders = 0;
+
+    std::atomic<double> currentSampleRate { 44100.0 };
+    std::atomic<int> hopsPerWindow { 4 };
+    std::atomic<bool> logFrequency { true };
+
+    // Worker thread only
+    struct Band
+    {
+        int firstBin = 0, endBin = 0;   // bins whose centres fall inside the band
+        float centreBin = 0;            // where a band too narrow to hold a bin is interpolated
+    };
+
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> window, fftData;
+    std::array<std::vector<float>, numTaps> history;            // the last fftSize samples of each tap
+    std::array<int, numTaps> historyFill {};
+    std::array<std::array<float, numBands>, numTaps> bandPower {};
+    std::array<Band, numBands> bands {};
+    float magnitudeScale = 0, minHz = 0, maxHz = 0;
+    double mappedSampleRate = 0;
+    bool mappedLog = true, hasNewPower = false;
+    double lastPublishMs = 0;
+    juce::uint32 framesPublished = 0;
+
+    TripleBuffer<Frame> frames;
+    std::unique_ptr<AnalysisThread> worker;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
+
+} // namespace WAVFinDSP
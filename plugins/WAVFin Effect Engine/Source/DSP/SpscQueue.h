@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    A fixed-capacity queue from one writer thread to one reader thread.
+
+    The slots are allocated by the constructor, and push() and pop() only copy into
+    and out of them under juce::AbstractFifo's atomic indices, so either side can be
+    the audio thread. A full queue refuses the push rather than overwriting, which
+    leaves the writer to decide what to do with the item.
+
+    T should be cheap to copy and hold no heap memory.
+*/
+template <typename T>
+class SpscQueue
+{
+public:
+    /** Room for capacity items. */
+    explicit SpscQueue (int capacity)
+        : fifo (capacity + 1), items ((size_t) capacity + 1)
+    {
+    }
+
+    //==============================================================================
+    /** Writer: appends the item, or returns false if the queue is full. */
+    bool push (const T& item) noexcept
+    {
+        const auto scope = fifo.write (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        items[(size_t) scope.startIndex1] = item;
+        return true;
+    }
+
+    /** Reader: takes the oldest item, or returns false if the queue is empty. */
+    bool pop (T& item) noexcept
+    {
+        const auto scope = fifo.read (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        item = items[(size_t) scope.startIndex1];
+        return true;
+    }
+
+    /** Items waiting. Exact for the reader; a lower bound for anyone else. */
+    int getNumReady() const noexcept        { return fifo.getNumReady(); }
+
+private:
+    //==============================================================================
+    juce::AbstractFifo fifo;
+    std::vector<T> items;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpscQueue)
+};
+
+} // namespace WAVFinDSP
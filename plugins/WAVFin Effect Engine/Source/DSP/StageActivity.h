@@ -0,0 +1,138 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Puts the stages of a serial chain to sleep on silence.
+
+    The peak of the signal between stages is measured once per chunk at the chain
+    input and again after every stage that runs. A stage falls asleep once its input
+    has been below the threshold and its own output has stayed below it for at least
+    the stage's memory: the longest time it can still produce sound from older input
+    (a delay line's length, a loop buffer, an IR). From then on its state holds nothing
+    audible and its input is silent, so skipping it and letting the near-silent input
+    through changes the output by less than the threshold. Any chunk whose input is
+    above the threshold wakes the stage before it is processed.
+
+    Stages that generate sound on their own (noise) never reach a quiet output, so
+    they never sleep.
+*/
+template <typename SampleType>
+class StageActivity
+{
+public:
+    /** -100 dBFS */
+    static constexpr SampleType silenceThreshold = (SampleType) 1.0e-5;
+
+    StageActivity() = default;
+
+    void prepare (int numStages)
+    {
+        stages.assign ((size_t) juce::jmax (0, numStages), {});
+        samplesSkipped.store (0, std::memory_order_relaxed);
+        reset();
+    }
+
+    /** Wakes every stage. */
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+            stage = {};
+
+        peak = 0;
+    }
+
+    /** Measures the chain input for this chunk. */
+    void beginChunk (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        peak = measurePeak (block);
+    }
+
+    /** True if the stage has to run on this chunk, false while it sleeps on silent input. */
+    bool shouldProcess (int index, int numSamples) noexcept
+    {
+        auto& stage = stages[(size_t) index];
+        stage.inputSilent = peak <= silenceThreshold;
+
+        if (! stage.inputSilent)
+        {
+            stage.asleep = false;
+            stage.quietSamples = 0;
+            return true;
+        }
+
+        if (stage.asleep)
+        {
+            samplesSkipped.fetch_add ((juce::uint64) numSamples, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Call after the stage ran, with its output and its memory in samples. */
+    void stageProcessed (int index, const juce::dsp::AudioBlock<SampleType>& block, juce::int64 memorySamples) noexcept
+    {
+        stagePeak = measurePeak (block);
+        settle (index, stagePeak, (juce::int64) block.getNumSamples(), memorySamples);
+    }
+
+    /** As stageProcessed(), for a stage whose output is its input blended with a wet block
+        that has not been mixed in yet. A blend is never louder than the louder of the two. */
+    void stageProcessedBlend (int index, const juce::dsp::AudioBlock<SampleType>& wet, juce::int64 memorySamples) noexcept
+    {
+        stagePeak = measurePeak (wet);
+        settle (index, juce::jmax (peak, stagePeak), (juce::int64) wet.getNumSamples(), memorySamples);
+    }
+
+    /** Peak of the last processed stage's output, or of its wet block when the blend is pending. */
+    SampleType getStagePeak() const noexcept                { return stagePeak; }
+
+    bool isAsleep (int index) const noexcept                { return stages[(size_t) index].asleep; }
+
+    /** Stage-samples skipped since prepare(), summed over all stages. Safe from any thread. */
+    juce::uint64 getNumSamplesSkipped() const noexcept      { return samplesSkipped.load (std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    struct Stage
+    {
+        juce::int64 quietSamples = 0;   // input and output both quiet since then
+        bool inputSilent = false;
+        bool asleep = false;
+    };
+
+    void settle (int index, SampleType outputPeak, juce::int64 numSamples, juce::int64 memorySamples) noexcept
+    {
+        auto& stage = stages[(size_t) index];
+        peak = outputPeak;
+
+        if (stage.inputSilent && peak <= silenceThreshold)
+        {
+            stage.quietSamples += numSamples;
+            stage.asleep = stage.quietSamples >= memorySamples;
+        }
+        else
+        {
+            stage.quietSamples = 0;
+        }
+    }
+
+    static SampleType measurePeak (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto range = block.findMinAndMax();
+        return juce::jmax (-range.getStart(), range.getEnd());
+    }
+
+    std::vector<Stage> stages;
+    SampleType peak = 0, stagePeak = 0;
+    std::atomic<juce::uint64> samplesSkipped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageActivity)
+};
+
+} // namespace WAVFinDSP
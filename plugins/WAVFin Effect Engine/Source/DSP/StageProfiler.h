@@ -0,0 +1,201 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <bit>
+#include "TripleBuffer.h"
+
+/** Set to 1 (CMake option WAVFIN_ENABLE_STAGE_PROFILING, always on in Debug builds) to time
+    every section of the audio callback. When it is 0 the profiler is an empty class and its
+    calls compile to nothing, so release builds carry none of it.
+*/
+#ifndef WAVFIN_ENABLE_STAGE_PROFILING
+ #define WAVFIN_ENABLE_STAGE_PROFILING 0
+#endif
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/** One section's timings over a window. Times are per call, in microseconds. */
+struct SectionTimings
+{
+    double meanMicroseconds = 0, p99Microseconds = 0, maxMicroseconds = 0;
+    double cpuPercent = 0;          // time spent in the section, as a share of the audio time of the window
+    int numCalls = 0;
+};
+
+/** The timings of every section over the last completed window. */
+template <int numSections>
+struct ProfileSnapshot
+{
+    std::array<SectionTimings, numSections> sections {};
+    double windowSeconds = 0;       // audio time the window covers
+    juce::uint32 windowNumber = 0;  // counts up from 1; 0 until the first window closes
+};
+
+//==============================================================================
+/**
+    Times the sections of the audio callback (stages, the output pass, the whole block)
+    with the high-resolution clock read at each boundary.
+
+    The audio thread owns the accumulators: per section a call count, the total and the
+    longest time, and a histogram with eight bins per octave of clock ticks, which gives
+    the p99 to within 1/8 of its value. Once a window's worth of audio has been processed
+    the audio thread reduces them to a ProfileSnapshot, publishes it through a TripleBuffer
+    and starts the next window, so neither side ever waits for the other.
+*/
+template <int numSections>
+class StageProfiler
+{
+public:
+    using Snapshot = ProfileSnapshot<numSections>;
+
+    StageProfiler() = default;
+
+   #if WAVFIN_ENABLE_STAGE_PROFILING
+    /** Starts an empty window of the given audio duration. Not while the audio thread runs. */
+    void prepare (double sampleRate, double windowSeconds)
+    {
+        samplesPerWindow = juce::jmax ((juce::int64) 1, (juce::int64) (sampleRate * windowSeconds));
+        secondsPerSample = 1.0 / sampleRate;
+        microsecondsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+        clearWindow();
+    }
+
+    //==============================================================================
+    /** Audio thread: the clock reading that starts a section. */
+    static juce::int64 now() noexcept               { return juce::Time::getHighResolutionTicks(); }
+
+    /** Audio thread: adds the time since startTicks to the section. */
+    void addTime (int section, juce::int64 startTicks) noexcept
+    {
+        const auto ticks = (juce::uint64) juce::jmax ((juce::int64) 0, now() - startTicks);
+        auto& accumulator = accumulators[(size_t) section];
+
+        ++accumulator.numCalls;
+        accumulator.totalTicks += ticks;
+        accumulator.maxTicks = juce::jmax (accumulator.maxTicks, ticks);
+        ++accumulator.histogram[(size_t) getBin (ticks)];
+    }
+
+    /** Audio thread: counts the audio time processed, closing the window once it is full. */
+    void advance (int numSamples) noexcept
+    {
+        samplesInWindow += numSamples;
+
+        if (samplesInWindow >= samplesPerWindow)
+            publishWindow();
+    }
+
+    //==============================================================================
+    /** Reader: the last completed window. One reader thread only, normally the message thread. */
+    const Snapshot& getLatest() noexcept
+    {
+        snapshots.update();
+        return snapshots.read();
+    }
+
+   #else
+    void prepare (double, double) {}
+    static juce::int64 now() noexcept               { return 0; }
+    void addTime (int, juce::int64) noexcept {}
+    void advance (int) noexcept {}
+   #endif
+
+private:
+   #if WAVFIN_ENABLE_STAGE_PROFILING
+    //==============================================================================
+    static constexpr int subBits = 3, binsPerOctave = 1 << subBits;
+    static constexpr int numBins = (64 - subBits + 1) * binsPerOctave;
+
+    // Exact below binsPerOctave ticks, then binsPerOctave equal steps per octave
+    static int getBin (juce::uint64 ticks) noexcept
+    {
+        if (ticks < (juce::uint64) binsPerOctave)
+            return (int) ticks;
+
+        const auto width = (int) std::bit_width (ticks);
+        return (width - subBits) * binsPerOctave + (int) ((ticks >> (width - 1 - subBits)) & (binsPerOctave - 1));
+    }
+
+    static juce::uint64 getBinStart (int bin) noexcept
+    {
+        if (bin < binsPerOctave)
+            return (juce::uint64) bin;
+
+        return (juce::uint64) (binsPerOctave + bin % binsPerOctave) << (bin / binsPerOctave - 1);
+    }
+
+    struct Accumulator
+    {
+        int numCalls = 0;
+        juce::uint64 totalTicks = 0, maxTicks = 0;
+        std::array<juce::uint32, numBins> histogram {};
+    };
+
+    void clearWindow() noexcept
+    {
+        for (auto& accumulator : accumulators)
+            accumulator = {};
+
+        samplesInWindow = 0;
+    }
+
+    // Once per window, so walking the histograms here costs nothing per block
+    void publishWindow() noexcept
+    {
+        auto& snapshot = snapshots.getWriteSlot();
+        const double windowSeconds = (double) samplesInWindow * secondsPerSample;
+
+        for (size_t i = 0; i < accumulators.size(); ++i)
+        {
+            const auto& accumulator = accumulators[i];
+            auto& timings = snapshot.sections[i];
+            timings = {};
+            timings.numCalls = accumulator.numCalls;
+
+            if (accumulator.numCalls == 0)
+                continue;
+
+            const double totalMicroseconds = (double) accumulator.totalTicks * microsecondsPerTick;
+            timings.meanMicroseconds = totalMicroseconds / accumulator.numCalls;
+            timings.maxMicroseconds = (double) accumulator.maxTicks * microsecondsPerTick;
+            timings.cpuPercent = totalMicroseconds * 1.0e-4 / windowSeconds;
+
+            // The end of the bin holding the call at the 99th percentile rank
+            const auto rank = (juce::uint32) std::ceil (0.99 * accumulator.numCalls);
+            juce::uint32 count = 0;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                count += accumulator.histogram[(size_t) bin];
+
+                if (count >= rank)
+                {
+                    const auto binEnd = bin + 1 < numBins ? getBinStart (bin + 1) : accumulator.maxTicks;
+                    timings.p99Microseconds = (double) juce::jmin (binEnd, accumulator.maxTicks) * microsecondsPerTick;
+                    break;
+                }
+            }
+        }
+
+        snapshot.windowSeconds = windowSeconds;
+        snapshot.windowNumber = ++windowsPublished;
+        snapshots.publish();
+
+        clearWindow();
+    }
+
+    //==============================================================================
+    std::array<Accumulator, (size_t) numSections> accumulators {};
+    juce::int64 samplesInWindow = 0, samplesPerWindow = 1;
+    double secondsPerSample = 0, microsecondsPerTick = 0;
+    juce::uint32 windowsPublished = 0;
+
+    TripleBuffer<Snapshot> snapshots;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageProfiler)
+};
+
+} // namespace WAVFinDSP
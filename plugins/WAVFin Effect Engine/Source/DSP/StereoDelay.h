@@ -0,0 +1,183 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Feedback delay processed frame by frame: every channel reads at the same
+    fractional position on each sample, so a moving delay time bends L and R together.
+
+    The buffer is a power of two per channel, sized in prepare() from the sample rate
+    and the longest delay, so the full range is available at any rate and wraps are
+    masks. Reads use linear or 4-point Hermite interpolation; Hermite keeps the
+    high end when the time is modulated, at roughly twice the cost.
+
+    In ping-pong mode the input is summed to mono and fed to the left line only, and
+    each line's feedback goes to the other side, so repeats alternate L, R, L...
+*/
+template <typename SampleType>
+class StereoDelay
+{
+public:
+    enum class Interpolation { linear = 0, hermite };
+
+    StereoDelay() = default;
+
+    /** Allocates room for maxDelaySeconds at this sample rate. Call from prepareToPlay(). */
+    void prepare (int numChannels, double sampleRate, double maxDelaySeconds)
+    {
+        maxDelaySamples = (SampleType) juce::jmax (minDelaySamples, maxDelaySeconds * sampleRate);
+
+        // Hermite reads one sample newer and two older than the integer position
+        bufferSize = juce::nextPowerOfTwo ((int) std::ceil (maxDelaySamples) + 4);
+        mask = bufferSize - 1;
+
+        lines.setSize (juce::jmax (1, numChannels), bufferSize);
+        reset();
+    }
+
+    void reset()
+    {
+        lines.clear();
+        writePos = 0;
+    }
+
+    void setInterpolation (Interpolation newInterpolation) noexcept   { interpolation = newInterpolation; }
+    void setPingPong (bool shouldPingPong) noexcept                    { pingPong = shouldPingPong; }
+
+    SampleType getMaxDelaySamples() const noexcept                     { return maxDelaySamples; }
+
+    /** Processes in place. Each parameter is either a per-sample ramp or, when the
+        ramp pointer is null, the constant that follows it. Delay time is in samples. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block,
+                  const SampleType* delayRamp, SampleType delay,
+                  const SampleType* feedbackRamp, SampleType feedback,
+                  const SampleType* mixRamp, SampleType mix) noexcept
+    {
+        const Controls controls { delayRamp, delay, feedbackRamp, feedback, mixRamp, mix };
+        const bool crossFeed = pingPong && block.getNumChannels() >= 2 && lines.getNumChannels() >= 2;
+
+        if (interpolation == Interpolation::hermite)
+        {
+            if (crossFeed)  processFrames<Interpolation::hermite, true>  (block, controls);
+            else            processFrames<Interpolation::hermite, false> (block, controls);
+        }
+        else
+        {
+            if (crossFeed)  processFrames<Interpolation::linear, true>  (block, controls);
+            else            processFrames<Interpolation::linear, false> (block, controls);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Controls
+    {
+        const SampleType* delayRamp;    SampleType delay;
+        const SampleType* feedbackRamp; SampleType feedback;
+        const SampleType* mixRamp;      SampleType mix;
+
+        SampleType delayAt (int s) const noexcept       { return delayRamp != nullptr ? delayRamp[s] : delay; }
+        SampleType feedbackAt (int s) const noexcept    { return feedbackRamp != nullptr ? feedbackRamp[s] : feedback; }
+        SampleType mixAt (int s) const noexcept         { return mixRamp != nullptr ? mixRamp[s] : mix; }
+    };
+
+    template <Interpolation mode, bool crossFeed>
+    void processFrames (const juce::dsp::AudioBlock<SampleType>& block, const Controls& controls) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numChannels = juce::jmin ((int) block.getNumChannels(), lines.getNumChannels());
+
+        std::array<SampleType*, maxChannels> io {};
+        std::array<SampleType*, maxChannels> line {};
+        const auto frameChannels = juce::jmin (numChannels, maxChannels);
+
+        for (int ch = 0; ch < frameChannels; ++ch)
+        {
+            io[(size_t) ch] = block.getChannelPointer ((size_t) ch);
+            line[(size_t) ch] = lines.getWritePointer (ch);
+        }
+
+        for (int s = 0; s < numSamples; ++s)
+        {
+            // One read position for the whole frame
+            const auto delay = juce::jlimit ((SampleType) minDelaySamples, maxDelaySamples, controls.delayAt (s));
+            const auto whole = (int) delay;
+            const auto frac = delay - (SampleType) whole;
+            const auto index = writePos - whole;
+
+            const auto feedback = controls.feedbackAt (s);
+            const auto mix = controls.mixAt (s);
+
+            std::array<SampleType, maxChannels> delayed {};
+            for (int ch = 0; ch < frameChannels; ++ch)
+                delayed[(size_t) ch] = read<mode> (line[(size_t) ch], index, frac);
+
+            if constexpr (crossFeed)
+            {
+                auto& left = io[0][s];
+                auto& right = io[1][s];
+                const auto monoIn = (left + right) * (SampleType) 0.5;
+
+                line[0][writePos] = monoIn + delayed[1] * feedback;
+                line[1][writePos] = delayed[0] * feedback;
+
+                left += mix * (delayed[0] - left);
+                right += mix * (delayed[1] - right);
+            }
+            else
+            {
+                for (int ch = 0; ch < frameChannels; ++ch)
+                {
+                    auto& x = io[(size_t) ch][s];
+                    line[(size_t) ch][writePos] = x + delayed[(size_t) ch] * feedback;
+                    x += mix * (delayed[(size_t) ch] - x);
+                }
+            }
+
+            writePos = (writePos + 1) & mask;
+        }
+    }
+
+    /** Sample at (index - frac), where index counts back from the write head. */
+    template <Interpolation mode>
+    SampleType read (const SampleType* line, int index, SampleType frac) const noexcept
+    {
+        const auto x0 = line[index & mask];
+        const auto x1 = line[(index - 1) & mask];
+
+        if constexpr (mode == Interpolation::linear)
+        {
+            return x0 + frac * (x1 - x0);
+        }
+        else
+        {
+            // 4-point, 3rd-order Hermite between x0 and x1 (xm1 is the newer neighbour)
+            const auto xm1 = line[(index + 1) & mask];
+            const auto x2 = line[(index - 2) & mask];
+
+            const auto c1 = (SampleType) 0.5 * (x1 - xm1);
+            const auto c2 = xm1 - (SampleType) 2.5 * x0 + (SampleType) 2 * x1 - (SampleType) 0.5 * x2;
+            const auto c3 = (SampleType) 0.5 * (x2 - xm1) + (SampleType) 1.5 * (x0 - x1);
+            return ((c3 * frac + c2) * frac + c1) * frac + x0;
+        }
+    }
+
+    //==============================================================================
+    static constexpr int maxChannels = 2;
+    static constexpr double minDelaySamples = 2.0; // keeps the Hermite neighbour behind the write head
+
+    juce::AudioBuffer<SampleType> lines;
+    int bufferSize = 1, mask = 0, writePos = 0;
+    SampleType maxDelaySamples = (SampleType) minDelaySamples;
+
+    Interpolation interpolation = Interpolation::linear;
+    bool pingPong = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StereoDelay)
+};
+
+} // namespace WAVFinDSP
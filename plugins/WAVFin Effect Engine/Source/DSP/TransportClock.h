@@ -0,0 +1,167 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Tracks the host transport and reports the exact sample of every loop start.
+
+    syncToHost() is called once per host block with the playhead position; advance()
+    is then called for each consecutive chunk of that block and returns the sample
+    offsets inside the chunk where a loop boundary falls, so the caller can split
+    its processing there.
+
+    While the host is playing, boundaries follow the host's musical grid (loop length
+    in bars, from the host time signature). Starting playback or jumping (loop, seek)
+    reports a boundary at the first sample of the next chunk. When the transport is
+    stopped the clock keeps running at the last known tempo, so loops stay one bar
+    (or whatever was chosen) long instead of falling back to a fixed timer.
+
+    setMaxLoopSamples() caps the interval between boundaries, for consumers whose
+    buffers cannot hold an arbitrarily long loop at very slow tempos.
+*/
+class TransportClock
+{
+public:
+    static constexpr int maxBoundariesPerChunk = 16;
+
+    struct Boundaries
+    {
+        std::array<int, maxBoundariesPerChunk> offsets {};
+        int count = 0;
+
+        void add (int offset) noexcept
+        {
+            if (count < maxBoundariesPerChunk)
+                offsets[(size_t) count++] = offset;
+        }
+    };
+
+    TransportClock() = default;
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    /** Restarts the free-running clock; the next chunk starts a new loop. */
+    void reset() noexcept
+    {
+        ppqPosition = 0.0;
+        samplesSinceBoundary = 0;
+        wasPlaying = false;
+        resyncPending = true;
+    }
+
+    /** Loop length in bars (e.g. 0.5, 1, 2). */
+    void setLoopLengthBars (double bars) noexcept     { loopBars = juce::jmax (1.0 / 64.0, bars); }
+
+    /** Upper bound on the distance between boundaries, in samples (0 = none). */
+    void setMaxLoopSamples (int samples) noexcept     { maxLoopSamples = juce::jmax (0, samples); }
+
+    double getBpm() const noexcept                    { return bpm; }
+    double getBeatsPerBar() const noexcept            { return beatsPerBar; }
+    double getPpqPosition() const noexcept            { return ppqPosition; }
+    bool isPlaying() const noexcept                   { return wasPlaying; }
+    double getLoopLengthBeats() const noexcept        { return loopBars * beatsPerBar; }
+
+    double getLoopLengthSamples() const noexcept
+    {
+        return getLoopLengthBeats() * 60.0 / bpm * sampleRate;
+    }
+
+    /** Call once per host block, before advance(). */
+    void syncToHost (const juce::Optional<juce::AudioPlayHead::PositionInfo>& position) noexcept
+    {
+        bool isPlaying = false;
+
+        if (position.hasValue())
+        {
+            if (auto hostBpm = position->getBpm(); hostBpm.hasValue() && *hostBpm > 0.0)
+                bpm = *hostBpm;
+
+            if (auto signature = position->getTimeSignature(); signature.hasValue() && signature->denominator > 0)
+                beatsPerBar = signature->numerator * 4.0 / signature->denominator;
+
+            if (auto ppq = position->getPpqPosition(); ppq.hasValue() && position->getIsPlaying())
+            {
+                isPlaying = true;
+
+                // A start or a jump larger than a couple of samples restarts the loop right away
+                const double tolerance = 2.0 * getPpqPerSample();
+                if (! wasPlaying || std::abs (*ppq - ppqPosition) > tolerance)
+                    resyncPending = true;
+
+                ppqPosition = *ppq;
+            }
+        }
+
+        wasPlaying = isPlaying;
+    }
+
+    /** Returns the loop starts inside the next numSamples (ascending) and moves past them. */
+    Boundaries advance (int numSamples) noexcept
+    {
+        Boundaries result;
+        const double ppqPerSample = getPpqPerSample();
+        const double loopBeats = getLoopLengthBeats();
+
+        int lastBoundary = -samplesSinceBoundary;
+
+        if (resyncPending)
+        {
+            result.add (0);
+            lastBoundary = 0;
+            resyncPending = false;
+        }
+
+        // First grid line at or after the chunk start
+        double nextGridBeat = std::ceil (ppqPosition / loopBeats - 1.0e-9) * loopBeats;
+
+        for (;;)
+        {
+            auto gridOffset = (int) std::ceil ((nextGridBeat - ppqPosition) / ppqPerSample - 1.0e-6);
+
+            if (gridOffset <= lastBoundary)
+            {
+                nextGridBeat += loopBeats;
+                continue;
+            }
+
+            int next = gridOffset;
+
+            if (maxLoopSamples > 0)
+                next = juce::jmin (next, lastBoundary + maxLoopSamples);
+
+            if (next >= numSamples)
+                break;
+
+            result.add (next);
+            lastBoundary = next;
+        }
+
+        samplesSinceBoundary = numSamples - lastBoundary;
+        ppqPosition += numSamples * ppqPerSample;
+        return result;
+    }
+
+private:
+    double getPpqPerSample() const noexcept    { return bpm / (60.0 * sampleRate); }
+
+    double sampleRate = 44100.0;
+    double bpm = 120.0;
+    double beatsPerBar = 4.0;
+    double loopBars = 1.0;
+    double ppqPosition = 0.0;
+
+    int samplesSinceBoundary = 0;
+    int maxLoopSamples = 0;
+    bool wasPlaying = false;
+    bool resyncPending = true;
+};
+
+} // namespace WAVFinDSP
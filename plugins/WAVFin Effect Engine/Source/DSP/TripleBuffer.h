@@ -0,0 +1,60 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Hands the latest value of T from one writer thread to one reader thread.
+
+    Three slots rotate: the writer fills its back slot and swaps it into the middle;
+    the reader swaps the middle with its front slot when a new value is waiting. Both
+    sides are wait-free and never copy or allocate, so the reader can be the audio
+    thread. Values published before the reader looked are simply overwritten.
+
+    T should be cheap to assign and hold no heap memory (the slots live in place).
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    //==============================================================================
+    /** Writer: the slot to fill before publish(). Its contents are stale. */
+    T& getWriteSlot() noexcept                  { return slots[(size_t) back]; }
+
+    /** Writer: makes the filled slot the newest value. */
+    void publish() noexcept
+    {
+        back = middle.exchange (back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader: takes the newest published value, if there is one. Returns true if read() changed. */
+    bool update() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader: the value taken by the last update(), or a default T before the first one. */
+    const T& read() const noexcept              { return slots[(size_t) front]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3, freshBit = 4;
+
+    std::array<T, 3> slots {};
+    std::atomic<int> middle { 1 };
+    int front = 0, back = 2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TripleBuffer)
+};
+
+} // namespace WAVFinDSP
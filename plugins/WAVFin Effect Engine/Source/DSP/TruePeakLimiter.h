@@ -0,0 +1,276 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <numeric>
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+//==============================================================================
+/**
+    Lookahead limiter with true-peak detection, linked across channels.
+
+    Detection: every input sample and the three points 1/4, 1/2 and 3/4 of the way
+    to the next one are estimated with a 4-phase polyphase interpolator (12 taps per
+    phase, Kaiser-windowed sinc, as in ITU-R BS.1770). The largest magnitude over all
+    channels is the frame's true peak. The phases run as SIMD dot products across
+    consecutive frames.
+
+    Gain: each frame asks for ceiling / peak (1 below the ceiling). A sliding-window
+    minimum over the lookahead holds the lowest request (van Herk / Gil-Werman: a
+    running prefix minimum plus the suffix minima of the previous window, so three
+    comparisons per sample whatever the window length). A moving average as long as
+    the lookahead then ramps into each reduction, reaching it exactly when the peak
+    leaves the delay line, and a one-pole release lets the gain back up.
+
+    The audio is delayed by the lookahead plus the interpolator's half length; see
+    getLatencyInSamples(). Everything is allocated in prepare(), so setLookahead()
+    is safe on the audio thread (it clears the state when the length changes).
+*/
+template <typename SampleType>
+class TruePeakLimiter
+{
+public:
+    static constexpr int numPhases = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int detectorLatency = tapsPerPhase / 2;
+
+    /** The delay line also has to hold the interpolator's history. */
+    static constexpr int minLookahead = tapsPerPhase - 1 - detectorLatency;
+
+    TruePeakLimiter() = default;
+
+    void prepare (int newNumChannels, double newSampleRate, int newMaxBlockSize, double maxLookaheadSeconds)
+    {
+        numChannels = juce::jmax (1, newNumChannels);
+        sampleRate = newSampleRate;
+        maxBlockSize = juce::jmax (1, newMaxBlockSize);
+        maxLookahead = juce::jmax (minLookahead, lookaheadForSeconds (maxLookaheadSeconds, sampleRate));
+
+        designCoefficients();
+
+        // Each line keeps the delayed samples in front of the new block
+        lines.setSize (numChannels, maxLookahead + detectorLatency + maxBlockSize);
+        peaks.setSize (1, maxBlockSize);
+        gains.setSize (1, maxBlockSize);
+        windowValues.assign ((size_t) maxLookahead + 2, (SampleType) 1);
+        windowSuffix.assign ((size_t) maxLookahead + 3, (SampleType) 1);
+        average.assign ((size_t) maxLookahead, (SampleType) 1);
+
+        lookahead = 0;
+        setLookahead (maxLookaheadSeconds);
+        setRelease (releaseSeconds);
+    }
+
+    /** The latency a lookahead of this length will report at this rate, for sizing delay lines. */
+    static int getLatencyForLookahead (double seconds, double sampleRate) noexcept
+    {
+        return juce::jmax (minLookahead, lookaheadForSeconds (seconds, sampleRate)) + detectorLatency;
+    }
+
+    /** Up to the length given to prepare(). Clears the state when it changes. */
+    void setLookahead (double seconds) noexcept
+    {
+        const int newLookahead = juce::jlimit (minLookahead, maxLookahead, lookaheadForSeconds (seconds, sampleRate));
+
+        if (newLookahead != lookahead)
+        {
+            lookahead = newLookahead;
+            reset();
+        }
+    }
+
+    /** Audio delay in samples: the lookahead plus the interpolator's half length. */
+    int getLatencyInSamples() const noexcept     { return lookahead + detectorLatency; }
+
+    /** Highest true peak the output may reach (linear). */
+    void setCeiling (SampleType newCeiling) noexcept    { ceiling = juce::jmax ((SampleType) 1.0e-3, newCeiling); }
+
+    /** Time for the gain to recover most of the way (1 - 1/e) after a reduction. */
+    void setRelease (double seconds) noexcept
+    {
+        releaseSeconds = juce::jmax (0.001, seconds);
+        releaseCoefficient = (SampleType) std::exp (-1.0 / (releaseSeconds * sampleRate));
+    }
+
+    void reset() noexcept
+    {
+        lines.clear();
+        std::fill (windowValues.begin(), windowValues.end(), (SampleType) 1);
+        std::fill (windowSuffix.begin(), windowSuffix.end(), (SampleType) 1);
+        std::fill (average.begin(), average.end(), (SampleType) 1);
+        windowPosition = averagePosition = 0;
+        windowPrefix = (SampleType) 1;
+        averageSum = lookahead;
+        gain = (SampleType) 1;
+        lastNumSamples = 0;
+    }
+
+    /** Limits the block in place; the output is delayed by getLatencyInSamples(). */
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto blockChannels = juce::jmin ((int) block.getNumChannels(), numChannels);
+        const auto numSamples = juce::jmin ((int) block.getNumSamples(), maxBlockSize);
+
+        if (blockChannels == 0 || numSamples == 0)
+            return;
+
+        const int delay = getLatencyInSamples();
+        auto* framePeaks = peaks.getWritePointer (0);
+
+        for (int ch = 0; ch < blockChannels; ++ch)
+        {
+            auto* line = lines.getWritePointer (ch);
+            std::copy_n (block.getChannelPointer ((size_t) ch), numSamples, line + delay);
+            detectPeaks (line + delay - (tapsPerPhase - 1), framePeaks, numSamples, ch == 0);
+        }
+
+        computeGains (framePeaks, gains.getWritePointer (0), numSamples);
+        lastNumSamples = numSamples;
+
+        for (int ch = 0; ch < blockChannels; ++ch)
+        {
+            auto* line = lines.getWritePointer (ch);
+            auto* out = block.getChannelPointer ((size_t) ch);
+
+            juce::FloatVectorOperations::multiply (out, line, gains.getReadPointer (0), numSamples);
+            std::memmove (line, line + numSamples, sizeof (SampleType) * (size_t) delay);
+        }
+    }
+
+    /** Lowest gain applied in the last process() call: 1 when the block was not limited. */
+    SampleType getMinimumGain() const noexcept
+    {
+        return lastNumSamples > 0 ? juce::FloatVectorOperations::findMinimum (gains.getReadPointer (0), lastNumSamples)
+                                  : (SampleType) 1;
+    }
+
+private:
+    //==============================================================================
+    static int lookaheadForSeconds (double seconds, double rate) noexcept
+    {
+        return (int) std::ceil (juce::jmax (0.0, seconds) * rate);
+    }
+
+    /** history[tapsPerPhase - 1 + i] is input frame i. Writes (or maxes into) peaks[i]
+        for the span from frame i - detectorLatency towards the next frame. */
+    void detectPeaks (const SampleType* history, SampleType* framePeaks, int numSamples, bool first) const noexcept
+    {
+        Simd::forEachIndex<SampleType> (numSamples, [this, history, framePeaks, first] (auto ops, int i)
+        {
+            using Ops = decltype (ops);
+            const auto* x = history + i;
+
+            // Phase 0 is the sample itself
+            auto peak = Ops::abs (Ops::load (x + tapsPerPhase - 1 - detectorLatency));
+
+            for (int phase = 1; phase < numPhases; ++phase)
+            {
+                const auto* c = coefficients[(size_t) phase].data();
+                auto sum = Ops::mul (Ops::load (x), Ops::set (c[0]));
+
+                for (int tap = 1; tap < tapsPerPhase; ++tap)
+                    sum = Ops::add (sum, Ops::mul (Ops::load (x + tap), Ops::set (c[tap])));
+
+                peak = Ops::max (peak, Ops::abs (sum));
+            }
+
+            if (! first)
+                peak = Ops::max (peak, Ops::load (framePeaks + i));
+
+            Ops::store (framePeaks + i, peak);
+        });
+    }
+
+    void computeGains (const SampleType* framePeaks, SampleType* frameGains, int numSamples) noexcept
+    {
+        // The window covers the peak's span and both of its end samples
+        const int windowLength = lookahead + 2;
+        const SampleType inverseLength = (SampleType) 1 / (SampleType) lookahead;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto request = ceiling / juce::jmax (framePeaks[i], ceiling);
+
+            // Sliding-window minimum: the current window's prefix, or the suffix of the previous one
+            windowValues[(size_t) windowPosition] = request;
+            windowPrefix = windowPosition == 0 ? request : juce::jmin (windowPrefix, request);
+            const auto held = juce::jmin (windowPrefix, windowSuffix[(size_t) windowPosition + 1]);
+
+            if (++windowPosition == windowLength)
+            {
+                windowSuffix[(size_t) windowLength] = (SampleType) 1;
+
+                for (int j = windowLength; --j >= 0;)
+                    windowSuffix[(size_t) j] = juce::jmin (windowValues[(size_t) j], windowSuffix[(size_t) j + 1]);
+
+                windowPosition = 0;
+            }
+
+            // Moving average over the lookahead: ramps down to the held value as the peak arrives
+            averageSum += held - average[(size_t) averagePosition];
+            average[(size_t) averagePosition] = held;
+
+            if (++averagePosition == lookahead)
+            {
+                // Re-summed once per lap so rounding never accumulates
+                averagePosition = 0;
+                averageSum = std::accumulate (average.begin(), average.begin() + lookahead, 0.0);
+            }
+
+            const auto target = (SampleType) averageSum * inverseLength;
+            gain = target < gain ? target : target + (gain - target) * releaseCoefficient;
+            frameGains[i] = gain;
+        }
+    }
+
+    void designCoefficients()
+    {
+        // Kaiser-windowed sinc evaluated at fractional offsets phase / numPhases
+        constexpr double beta = 6.0;
+        const double halfLength = detectorLatency + 0.5;
+
+        auto besselI0 = [] (double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int m = 1; m < 32; ++m)
+            {
+                term *= (x / (2.0 * m)) * (x / (2.0 * m));
+                sum += term;
+            }
+            return sum;
+        };
+
+        for (int phase = 0; phase < numPhases; ++phase)
+        {
+            // Tap t reads the sample (tapsPerPhase - 1 - t) frames before the newest
+            for (int t = 0; t < tapsPerPhase; ++t)
+            {
+                const double u = (tapsPerPhase - 1 - t) - detectorLatency + (double) phase / numPhases;
+                const double ratio = u / halfLength;
+                const double window = besselI0 (beta * std::sqrt (juce::jmax (0.0, 1.0 - ratio * ratio))) / besselI0 (beta);
+                const double sinc = u == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * u) / (juce::MathConstants<double>::pi * u);
+                coefficients[(size_t) phase][(size_t) t] = (SampleType) (sinc * window);
+            }
+        }
+    }
+
+    //==============================================================================
+    int numChannels = 1, maxBlockSize = 1, maxLookahead = 1, lookahead = 1;
+    double sampleRate = 44100.0, releaseSeconds = 0.1;
+
+    SampleType ceiling = 1, releaseCoefficient = 0, gain = 1;
+    std::array<std::array<SampleType, tapsPerPhase>, numPhases> coefficients {};
+
+    juce::AudioBuffer<SampleType> lines, peaks, gains;
+
+    std::vector<SampleType> windowValues, windowSuffix, average;
+    int windowPosition = 0, averagePosition = 0, lastNumSamples = 0;
+    SampleType windowPrefix = 1;
+    double averageSum = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TruePeakLimiter)
+};
+
+} // namespace WAVFinDSP
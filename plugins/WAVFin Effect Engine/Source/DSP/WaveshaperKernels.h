@@ -0,0 +1,135 @@
+#pragma once
+
+#include "SimdOps.h"
+
+namespace WAVFinDSP
+{
+
+/**
+    Block waveshaping kernels shared by the Saturation stage and the output limiter.
+
+    Every kernel works in place on a whole block and runs on AVX/AVX2, SSE2 or NEON
+    depending on the build target, with a scalar fallback for the remainder and for
+    other CPUs. The only data-dependent branch is the limiter's, which skips the knee
+    for registers that are wholly below the threshold.
+
+    tanh uses a clamped [7/6] Padé approximant:
+        tanh (x) ~= x (135135 + 17325 x^2 + 378 x^4 + x^6) / (135135 + 62370 x^2 + 3150 x^4 + 28 x^6)
+    with |x| clamped to 4.97, where the approximant reaches 1. Max abs error vs
+    std::tanh is 9.6e-5 (about -80 dB) over the whole real line.
+*/
+namespace Kernels
+{
+
+//==============================================================================
+namespace detail
+{
+    using Simd::ScalarOps;
+    using Simd::OpsFor;
+    using Simd::forEachRegister;
+
+    //==============================================================================
+    /** Clamped [7/6] Padé tanh, generic over register type. */
+    template <typename T, typename Ops>
+    inline typename Ops::Reg tanh (typename Ops::Reg x) noexcept
+    {
+        x = Ops::min (Ops::max (x, Ops::set ((T) -4.97)), Ops::set ((T) 4.97));
+        const auto x2 = Ops::mul (x, x);
+
+        auto num = Ops::add (Ops::set ((T) 378), x2);
+        num = Ops::add (Ops::set ((T) 17325), Ops::mul (x2, num));
+        num = Ops::add (Ops::set ((T) 135135), Ops::mul (x2, num));
+        num = Ops::mul (x, num);
+
+        auto den = Ops::add (Ops::set ((T) 3150), Ops::mul (x2, Ops::set ((T) 28)));
+        den = Ops::add (Ops::set ((T) 62370), Ops::mul (x2, den));
+        den = Ops::add (Ops::set ((T) 135135), Ops::mul (x2, den));
+
+        return Ops::div (num, den);
+    }
+
+    /** See softLimitBlock(). */
+    template <typename T, typename Ops>
+    inline typename Ops::Reg softLimit (typename Ops::Reg x, T threshold, T ceiling) noexcept
+    {
+        const auto kneeWidth = ceiling - threshold;
+        const auto magnitude = Ops::abs (x);
+
+        // Almost all of a normal signal sits below the knee; skip the tanh for those registers
+        if (! Ops::anyGreater (magnitude, Ops::set (threshold)))
+            return x;
+
+        const auto over = Ops::max (Ops::sub (magnitude, Ops::set (threshold)), Ops::set ((T) 0));
+        const auto knee = Ops::mul (tanh<T, Ops> (Ops::mul (over, Ops::set ((T) 1 / kneeWidth))), Ops::set (kneeWidth));
+        return Ops::copySign (Ops::add (Ops::min (magnitude, Ops::set (threshold)), knee), x);
+    }
+} // namespace detail
+
+//==============================================================================
+/** Scalar fast tanh (same approximant and error bound as the block kernels). */
+template <typename T>
+inline T fastTanh (T x) noexcept
+{
+    return detail::tanh<T, detail::ScalarOps<T>> (x);
+}
+
+/** softLimitBlock() for a single sample. */
+template <typename T>
+inline T softLimit (T x, T threshold, T ceiling = 1) noexcept
+{
+    return detail::softLimit<T, detail::ScalarOps<T>> (x, threshold, ceiling);
+}
+
+/** data = (tanh (data * inputGain + inputOffset) + outputOffset) * outputGain */
+template <typename T>
+inline void tanhBlock (T* data, int numSamples,
+                       T inputGain = 1, T inputOffset = 0,
+                       T outputOffset = 0, T outputGain = 1) noexcept
+{
+    detail::forEachRegister (data, numSamples, [=] (auto ops, auto x)
+    {
+        using Ops = decltype (ops);
+        auto y = detail::tanh<T, Ops> (Ops::add (Ops::mul (x, Ops::set (inputGain)), Ops::set (inputOffset)));
+        return Ops::mul (Ops::add (y, Ops::set (outputOffset)), Ops::set (outputGain));
+    });
+}
+
+/** Cubic soft clip with a hard knee at +/-1:
+    u = clamp (data * inputGain, -1, 1), data = (1.5 u - 0.5 u^3) * outputGain */
+template <typename T>
+inline void softClipBlock (T* data, int numSamples, T inputGain = 1, T outputGain = 1) noexcept
+{
+    detail::forEachRegister (data, numSamples, [=] (auto ops, auto x)
+    {
+        using Ops = decltype (ops);
+        const auto u = Ops::min (Ops::max (Ops::mul (x, Ops::set (inputGain)), Ops::set ((T) -1)), Ops::set ((T) 1));
+        const auto shaped = Ops::mul (u, Ops::sub (Ops::set ((T) 1.5), Ops::mul (Ops::set ((T) 0.5), Ops::mul (u, u))));
+        return Ops::mul (shaped, Ops::set (outputGain));
+    });
+}
+
+/** data = clamp (data * inputGain, -1, 1) * outputGain */
+template <typename T>
+inline void hardClipBlock (T* data, int numSamples, T inputGain = 1, T outputGain = 1) noexcept
+{
+    detail::forEachRegister (data, numSamples, [=] (auto ops, auto x)
+    {
+        using Ops = decltype (ops);
+        const auto u = Ops::min (Ops::max (Ops::mul (x, Ops::set (inputGain)), Ops::set ((T) -1)), Ops::set ((T) 1));
+        return Ops::mul (u, Ops::set (outputGain));
+    });
+}
+
+/** Transparent below threshold, tanh knee above it, never exceeds ceiling:
+    |y| = min (|x|, t) + (c - t) * tanh (max (|x| - t, 0) / (c - t)) */
+template <typename T>
+inline void softLimitBlock (T* data, int numSamples, T threshold, T ceiling = 1) noexcept
+{
+    detail::forEachRegister (data, numSamples, [=] (auto ops, auto x)
+    {
+        return detail::softLimit<T, decltype (ops)> (x, threshold, ceiling);
+    });
+}
+
+} // namespace Kernels
+} // namespace WAVFinDSP
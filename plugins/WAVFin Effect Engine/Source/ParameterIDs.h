@@ -6,18 +6,24 @@ namespace ParameterIDs
 {
     inline const juce::ParameterID global_mix       { "global_mix", 1 };
     inline const juce::ParameterID output_gain     { "output_gain", 1 };
+    inline const juce::ParameterID limiter_mode    { "limiter_mode", 1 };
+    inline const juce::ParameterID limiter_lookahead { "limiter_lookahead", 1 };
 
     // Reverb
     inline const juce::ParameterID reverb_enable    { "reverb_enable", 1 };
     inline const juce::ParameterID reverb_size      { "reverb_size", 1 };
     inline const juce::ParameterID reverb_decay     { "reverb_decay", 1 };
     inline const juce::ParameterID reverb_mix       { "reverb_mix", 1 };
+    inline const juce::ParameterID conv_mix         { "conv_mix", 1 };
 
     // Delay
     inline const juce::ParameterID delay_enable     { "delay_enable", 1 };
     inline const juce::ParameterID delay_time       { "delay_time", 1 };
     inline const juce::ParameterID delay_feedback   { "delay_feedback", 1 };
     inline const juce::ParameterID delay_mix        { "delay_mix", 1 };
+    inline const juce::ParameterID delay_sync       { "delay_sync", 1 };
+    inline const juce::ParameterID delay_mode       { "delay_mode", 1 };
+    inline const juce::ParameterID delay_quality    { "delay_quality", 1 };
 
     // Chorus
     inline const juce::ParameterID chorus_enable    { "chorus_enable", 1 };
@@ -29,28 +35,36 @@ namespace ParameterIDs
     inline const juce::ParameterID filter_enable    { "filter_enable", 1 };
     inline const juce::ParameterID filter_cutoff    { "filter_cutoff", 1 };
     inline const juce::ParameterID filter_res       { "filter_res", 1 };
+    inline const juce::ParameterID filter_type      { "filter_type", 1 };
     inline const juce::ParameterID filter_lfo_rate   { "filter_lfo_rate", 1 };
     inline const juce::ParameterID filter_lfo_depth  { "filter_lfo_depth", 1 };
+    inline const juce::ParameterID filter_lfo_shape  { "filter_lfo_shape", 1 };
+    inline const juce::ParameterID filter_lfo_sync   { "filter_lfo_sync", 1 };
 
     // Autopan
     inline const juce::ParameterID pan_enable       { "pan_enable", 1 };
     inline const juce::ParameterID pan_rate         { "pan_rate", 1 };
     inline const juce::ParameterID pan_depth        { "pan_depth", 1 };
+    inline const juce::ParameterID pan_shape        { "pan_shape", 1 };
+    inline const juce::ParameterID pan_sync         { "pan_sync", 1 };
 
     // Halftime
     inline const juce::ParameterID halftime_enable  { "halftime_enable", 1 };
     inline const juce::ParameterID halftime_mix     { "halftime_mix", 1 };
     inline const juce::ParameterID halftime_fade    { "halftime_fade", 1 };
+    inline const juce::ParameterID halftime_length  { "halftime_length", 1 };
 
     // Vintage
     inline const juce::ParameterID vintage_enable   { "vintage_enable", 1 };
     inline const juce::ParameterID vintage_wow      { "vintage_wow", 1 };
     inline const juce::ParameterID vintage_flutter  { "vintage_flutter", 1 };
     inline const juce::ParameterID vintage_noise    { "vintage_noise", 1 };
+    inline const juce::ParameterID vintage_noise_color { "vintage_noise_color", 1 };
 
     // Saturation
     inline const juce::ParameterID sat_enable       { "sat_enable", 1 };
     inline const juce::ParameterID sat_drive        { "sat_drive", 1 };
     inline const juce::ParameterID sat_type         { "sat_type", 1 };
     inline const juce::ParameterID sat_mix          { "sat_mix", 1 };
+    inline const juce::ParameterID sat_quality      { "sat_quality", 1 };
 }
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+/**
+    Versioned record of the processor's parameter values, for syncing a web UI.
+
+    Every parameter carries the version at which it last changed. A listener only sets a
+    per-parameter flag (any thread, lock-free, so host automation on the audio thread is
+    fine); collectChanges() then stamps the flagged parameters whose value really moved
+    with a new version, on the message thread. A UI that remembers the version it applied
+    asks for getChangesSince() that version and receives only what moved after it, or
+    every parameter when it has applied nothing yet (version 0).
+
+    The flags make this a queue that keeps one entry per parameter: however often a
+    parameter moves between two collections, it is sent once, at its latest value. The
+    other direction, applyUiChanges(), takes the UI's own per-frame batch.
+
+    Values cross in the parameter's own units (dB, Hz, choice index, 0 or 1), so the UI
+    needs no ranges.
+*/
+class ParameterSync  : private juce::AudioProcessorParameter::Listener
+{
+public:
+    explicit ParameterSync (juce::AudioProcessor& processorToSync)
+        : entries ((size_t) processorToSync.getParameters().size())
+    {
+        const auto& params = processorToSync.getParameters();
+
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto& entry = entries[(size_t) i];
+
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (params[i]))
+            {
+                entry.parameter = ranged;
+                entry.id = ranged->getParameterID();
+                entry.value = ranged->getValue();
+                ranged->addListener (this);
+            }
+        }
+    }
+
+    ~ParameterSync() override
+    {
+        for (auto& entry : entries)
+        {
+            if (entry.parameter == nullptr)
+                continue;
+
+            // A UI closed mid-drag still owes the host the end of its gesture
+            if (entry.inGesture)
+                entry.parameter->endChangeGesture();
+
+            entry.parameter->removeListener (this);
+        }
+    }
+
+    //==============================================================================
+    /** Message thread: stamps every parameter whose value moved since it was last stamped
+        with one new version, and returns the newest version. */
+    juce::int64 collectChanges()
+    {
+        bool anyChanged = false;
+
+        for (auto& entry : entries)
+        {
+            if (! entry.flagged.exchange (false, std::memory_order_acquire))
+                continue;
+
+            // Echoes of a value the UI itself just set leave it where it was
+            const auto value = entry.parameter->getValue();
+
+            if (value == entry.value)
+                continue;
+
+            if (! anyChanged)
+            {
+                ++version;
+                anyChanged = true;
+            }
+
+            entry.value = value;
+            entry.changedAt = version;
+        }
+
+        return version;
+    }
+
+    /** Message thread: the parameters stamped after sinceVersion, as
+        { version, values: { id: value } }. Collects changes first. */
+    juce::var getChangesSince (juce::int64 sinceVersion)
+    {
+        collectChanges();
+
+        juce::DynamicObject::Ptr values (new juce::DynamicObject);
+
+        for (const auto& entry : entries)
+            if (entry.parameter != nullptr && entry.changedAt > sinceVersion)
+                values->setProperty (entry.id, entry.parameter->convertFrom0to1 (entry.value));
+
+        juce::DynamicObject::Ptr result (new juce::DynamicObject);
+        result->setProperty ("version", version);
+        result->setProperty ("values", juce::var (values.get()));
+        return juce::var (result.get());
+    }
+
+    /** The newest version stamped so far. */
+    juce::int64 getVersion() const noexcept     { return version; }
+
+    /** Message thread, once per frame: what the UI has not been sent yet, as
+        { since, version, values }, or a void var when nothing moved. A UI that has applied
+        version since can apply it; one that has not missed a batch and should pull. */
+    juce::var getNextBatch()
+    {
+        const auto since = sentVersion;
+
+        if (collectChanges() <= since)
+            return {};
+
+        auto batch = getChangesSince (since);
+        batch.getDynamicObject()->setProperty ("since", since);
+        sentVersion = version;
+        return batch;
+    }
+
+    /** Message thread: the UI has every change up to the newest version, from a reply to
+        getChangesSince(), so getNextBatch() starts after it. */
+    void markSent() noexcept                    { sentVersion = version; }
+
+    //==============================================================================
+    /** Message thread: applies one batch of UI changes,
+        { begin: [id...], values: { id: value }, end: [id...] }, in that order.
+
+        A value outside a begun gesture is sent to the host as a gesture of its own. The UI
+        already shows the values it set, so they are recorded as known and never sent back.
+        Unknown ids are ignored.
+    */
+    void applyUiChanges (const juce::var& batch)
+    {
+        auto forEachId = [this] (const juce::var& ids, auto&& callback)
+        {
+            if (auto* array = ids.getArray())
+                for (const auto& id : *array)
+                    if (auto* entry = findEntry (id.toString()))
+                        callback (*entry);
+        };
+
+        forEachId (batch["begin"], [] (Entry& entry)
+        {
+            if (! std::exchange (entry.inGesture, true))
+                entry.parameter->beginChangeGesture();
+        });
+
+        if (auto* values = batch["values"].getDynamicObject())
+        {
+            for (const auto& property : values->getProperties())
+            {
+                auto* entry = findEntry (property.name);
+                const auto& uiValue = property.value;
+
+                if (entry == nullptr || ! (uiValue.isDouble() || uiValue.isInt() || uiValue.isInt64() || uiValue.isBool()))
+                    continue;
+
+                auto& parameter = *entry->parameter;
+                const auto value = parameter.convertTo0to1 ((float) uiValue);
+
+                if (! entry->inGesture)
+                    parameter.beginChangeGesture();
+
+                parameter.setValueNotifyingHost (value);
+
+                if (! entry->inGesture)
+                    parameter.endChangeGesture();
+
+                entry->value = parameter.getValue();
+            }
+        }
+
+        forEachId (batch["end"], [] (Entry& entry)
+        {
+            if (std::exchange (entry.inGesture, false))
+                entry.parameter->endChangeGesture();
+        });
+    }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        juce::RangedAudioParameter* parameter = nullptr;
+        juce::Identifier id;
+        float value = 0;                            // stamped at changedAt, or since set by the UI
+        juce::int64 changedAt = 1;                  // every parameter is part of the first version
+        std::atomic<bool> flagged { false };        // set by the listener, cleared by collectChanges()
+        bool inGesture = false;                     // the UI began a gesture and has not ended it
+    };
+
+    Entry* findEntry (const juce::Identifier& id)
+    {
+        for (auto& entry : entries)
+            if (entry.parameter != nullptr && entry.id == id)
+                return &entry;
+
+        return nullptr;
+    }
+
+    void parameterValueChanged (int parameterIndex, float) override
+    {
+        if (juce::isPositiveAndBelow (parameterIndex, (int) entries.size()))
+            entries[(size_t) parameterIndex].flagged.store (true, std::memory_order_release);
+    }
+
+    void parameterGestureChanged (int, bool) override {}
+
+    //==============================================================================
+    std::vector<Entry> entries;     // by parameter index; sized once, so the flags never move
+    juce::int64 version = 1;
+    juce::int64 sentVersion = 1;    // the UI's first pull covers the first version
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSync)
+};
@@ -2,13 +2,6 @@
 #include "BinaryData.h"
 #include "PluginProcessor.h"
 
-//==============================================================================
-void WAVFinWebView::pageFinishedLoading(const juce::String& url) {
-  juce::WebBrowserComponent::pageFinishedLoading(url);
-  if (onPageLoaded)
-    onPageLoaded(url);
-}
-
 //==============================================================================
 WAVFinEffectEngineAudioProcessorEditor::WAVFinEffectEngineAudioProcessorEditor(
     WAVFinEffectEngineAudioProcessor &p)
@@ -16,216 +9,54 @@ WAVFinEffectEngineAudioProcessorEditor::WAVFinEffectEngineAudioProcessorEditor(
   // Set editor size to match UI design
   setSize(900, 750);
 
-  // 1. Define parameter getter
-  auto &apvts = audioProcessor.apvts;
-  auto getParam =
-      [&apvts](const juce::ParameterID &id) -> juce::RangedAudioParameter & {
-    auto *p = apvts.getParameter(id.getParamID());
-    jassert(p != nullptr);
-    return *p;
+  // 1. Parameters. Handshake: once its controls are listening, the page asks for every value
+  // changed since the version it last applied (0: all of them) and gets them in the reply,
+  // which unlike an event cannot be dropped while the page is loading
+  auto syncParameters = [this](const juce::Array<juce::var> &args,
+                               juce::WebBrowserComponent::NativeFunctionCompletion completion) {
+    const auto appliedVersion = args.isEmpty() ? (juce::int64)0 : (juce::int64)args[0];
+    auto changes = parameterSync.getChangesSince(appliedVersion);
+    if (appliedVersion == 0)
+      changes["values"].getDynamicObject()->setProperty("impulse_response",
+                                                        getImpulseResponseName());
+    parameterSync.markSent();
+    completion(changes);
   };
 
-  // 2. Create attachments (MUST be before webView to sync initial state)
-  //    We initialize these first so the Relays contain the correct current
-  //    parameter values when they are passed to the WebView Options below.
-  globalMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::global_mix), globalMixRelay, nullptr);
-  outputGainAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::output_gain), outputGainRelay, nullptr);
-
-  reverbEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::reverb_enable), reverbEnableRelay, nullptr);
-  reverbSizeAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::reverb_size), reverbSizeRelay, nullptr);
-  reverbDecayAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::reverb_decay), reverbDecayRelay, nullptr);
-  reverbMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::reverb_mix), reverbMixRelay, nullptr);
-
-  delayEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::delay_enable), delayEnableRelay, nullptr);
-  delayTimeAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::delay_time), delayTimeRelay, nullptr);
-  delayFeedbackAttachment =
-      std::make_unique<juce::WebSliderParameterAttachment>(
-          getParam(ParameterIDs::delay_feedback), delayFeedbackRelay, nullptr);
-  delayMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::delay_mix), delayMixRelay, nullptr);
-
-  chorusEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::chorus_enable), chorusEnableRelay, nullptr);
-  chorusRateAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::chorus_rate), chorusRateRelay, nullptr);
-  chorusDepthAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::chorus_depth), chorusDepthRelay, nullptr);
-  chorusMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::chorus_mix), chorusMixRelay, nullptr);
-
-  filterEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::filter_enable), filterEnableRelay, nullptr);
-  filterCutoffAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::filter_cutoff), filterCutoffRelay, nullptr);
-  filterResAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::filter_res), filterResRelay, nullptr);
-  filterLfoRateAttachment =
-      std::make_unique<juce::WebSliderParameterAttachment>(
-          getParam(ParameterIDs::filter_lfo_rate), filterLfoRateRelay, nullptr);
-  filterLfoDepthAttachment =
-      std::make_unique<juce::WebSliderParameterAttachment>(
-          getParam(ParameterIDs::filter_lfo_depth), filterLfoDepthRelay,
-          nullptr);
-
-  panEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::pan_enable), panEnableRelay, nullptr);
-  panRateAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::pan_rate), panRateRelay, nullptr);
-  panDepthAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::pan_depth), panDepthRelay, nullptr);
-
-  halftimeEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::halftime_enable), halftimeEnableRelay,
-          nullptr);
-  halftimeMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::halftime_mix), halftimeMixRelay, nullptr);
-  halftimeFadeAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::halftime_fade), halftimeFadeRelay, nullptr);
-
-  vintageEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::vintage_enable), vintageEnableRelay, nullptr);
-  vintageWowAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::vintage_wow), vintageWowRelay, nullptr);
-  vintageFlutterAttachment =
-      std::make_unique<juce::WebSliderParameterAttachment>(
-          getParam(ParameterIDs::vintage_flutter), vintageFlutterRelay,
-          nullptr);
-  vintageNoiseAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::vintage_noise), vintageNoiseRelay, nullptr);
-
-  satEnableAttachment =
-      std::make_unique<juce::WebToggleButtonParameterAttachment>(
-          getParam(ParameterIDs::sat_enable), satEnableRelay, nullptr);
-  satDriveAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::sat_drive), satDriveRelay, nullptr);
-  satTypeAttachment = std::make_unique<juce::WebComboBoxParameterAttachment>(
-      getParam(ParameterIDs::sat_type), satTypeRelay, nullptr);
-  satMixAttachment = std::make_unique<juce::WebSliderParameterAttachment>(
-      getParam(ParameterIDs::sat_mix), satMixRelay, nullptr);
-
-  // FIX: Manually sync Relays to Parameter values to ensure initial state is
-  // correct in WebView This addresses the "UI defaults to zero" bug on window
-  // reopen.
-  auto syncSlider = [&](juce::WebSliderRelay &relay,
-                        const juce::ParameterID &pid) {
-    if (auto *param = audioProcessor.apvts.getParameter(pid.getParamID()))
-      relay.setValue(param->convertFrom0to1(param->getValue()));
+  // The page's own changes arrive as one batch per frame: { begin, values, end }
+  auto parameterChanges = [this](const juce::var &batch) {
+    parameterSync.applyUiChanges(batch);
   };
 
-  auto syncToggle = [&](juce::WebToggleButtonRelay &relay,
-                        const juce::ParameterID &pid) {
-    if (auto *param = audioProcessor.apvts.getParameter(pid.getParamID()))
-      relay.setToggleState(param->getValue() > 0.5f);
+  // Opens the IR file browser; the name is pushed back once the load completes
+  auto chooseIR = [this](const juce::Array<juce::var> &,
+                         juce::WebBrowserComponent::NativeFunctionCompletion completion) {
+    chooseImpulseResponse();
+    completion(juce::var());
   };
 
-  syncSlider(globalMixRelay, ParameterIDs::global_mix);
-  syncSlider(outputGainRelay, ParameterIDs::output_gain);
-
-  syncToggle(reverbEnableRelay, ParameterIDs::reverb_enable);
-  syncSlider(reverbSizeRelay, ParameterIDs::reverb_size);
-  syncSlider(reverbDecayRelay, ParameterIDs::reverb_decay);
-  syncSlider(reverbMixRelay, ParameterIDs::reverb_mix);
-
-  syncToggle(delayEnableRelay, ParameterIDs::delay_enable);
-  syncSlider(delayTimeRelay, ParameterIDs::delay_time);
-  syncSlider(delayFeedbackRelay, ParameterIDs::delay_feedback);
-  syncSlider(delayMixRelay, ParameterIDs::delay_mix);
-
-  syncToggle(chorusEnableRelay, ParameterIDs::chorus_enable);
-  syncSlider(chorusRateRelay, ParameterIDs::chorus_rate);
-  syncSlider(chorusDepthRelay, ParameterIDs::chorus_depth);
-  syncSlider(chorusMixRelay, ParameterIDs::chorus_mix);
-
-  syncToggle(filterEnableRelay, ParameterIDs::filter_enable);
-  syncSlider(filterCutoffRelay, ParameterIDs::filter_cutoff);
-  syncSlider(filterResRelay, ParameterIDs::filter_res);
-  syncSlider(filterLfoRateRelay, ParameterIDs::filter_lfo_rate);
-  syncSlider(filterLfoDepthRelay, ParameterIDs::filter_lfo_depth);
-
-  syncToggle(panEnableRelay, ParameterIDs::pan_enable);
-  syncSlider(panRateRelay, ParameterIDs::pan_rate);
-  syncSlider(panDepthRelay, ParameterIDs::pan_depth);
-
-  syncToggle(halftimeEnableRelay, ParameterIDs::halftime_enable);
-  syncSlider(halftimeMixRelay, ParameterIDs::halftime_mix);
-  syncSlider(halftimeFadeRelay, ParameterIDs::halftime_fade);
-
-  syncToggle(vintageEnableRelay, ParameterIDs::vintage_enable);
-  syncSlider(vintageWowRelay, ParameterIDs::vintage_wow);
-  syncSlider(vintageFlutterRelay, ParameterIDs::vintage_flutter);
-  syncSlider(vintageNoiseRelay, ParameterIDs::vintage_noise);
-
-  syncToggle(satEnableRelay, ParameterIDs::sat_enable);
-  syncSlider(satDriveRelay, ParameterIDs::sat_drive);
-  syncSlider(satMixRelay, ParameterIDs::sat_mix);
-
-  if (auto *param = audioProcessor.apvts.getParameter(
-          ParameterIDs::sat_type.getParamID()))
-    satTypeRelay.setValue(param->getValue());
-
-  // 3. Initialize WebView (Now Relays are populated)
-  // Native function bypasses emitEventIfBrowserIsVisible - frontend fetches values when ready
-  auto getParamValues = [this](const juce::Array<juce::var> &,
-                               juce::WebBrowserComponent::NativeFunctionCompletion completion) {
-    juce::DynamicObject::Ptr obj(new juce::DynamicObject);
-    auto &apvts = audioProcessor.apvts;
-    auto addParam = [&](const juce::ParameterID &id) {
-      if (auto *p = apvts.getParameter(id.getParamID()))
-        obj->setProperty(id.getParamID(), p->getValue());
-    };
-    addParam(ParameterIDs::global_mix);
-    addParam(ParameterIDs::output_gain);
-    addParam(ParameterIDs::reverb_enable);
-    addParam(ParameterIDs::reverb_size);
-    addParam(ParameterIDs::reverb_decay);
-    addParam(ParameterIDs::reverb_mix);
-    addParam(ParameterIDs::delay_enable);
-    addParam(ParameterIDs::delay_time);
-    addParam(ParameterIDs::delay_feedback);
-    addParam(ParameterIDs::delay_mix);
-    addParam(ParameterIDs::chorus_enable);
-    addParam(ParameterIDs::chorus_rate);
-    addParam(ParameterIDs::chorus_depth);
-    addParam(ParameterIDs::chorus_mix);
-    addParam(ParameterIDs::filter_enable);
-    addParam(ParameterIDs::filter_cutoff);
-    addParam(ParameterIDs::filter_res);
-    addParam(ParameterIDs::filter_lfo_rate);
-    addParam(ParameterIDs::filter_lfo_depth);
-    addParam(ParameterIDs::pan_enable);
-    addParam(ParameterIDs::pan_rate);
-    addParam(ParameterIDs::pan_depth);
-    addParam(ParameterIDs::halftime_enable);
-    addParam(ParameterIDs::halftime_mix);
-    addParam(ParameterIDs::halftime_fade);
-    addParam(ParameterIDs::vintage_enable);
-    addParam(ParameterIDs::vintage_wow);
-    addParam(ParameterIDs::vintage_flutter);
-    addParam(ParameterIDs::vintage_noise);
-    addParam(ParameterIDs::sat_enable);
-    addParam(ParameterIDs::sat_drive);
-    addParam(ParameterIDs::sat_type);
-    addParam(ParameterIDs::sat_mix);
-    completion(juce::var(obj.get()));
+  // Opens or closes the spectrum view: (enabled, { overlap, log }). The analyzer thread
+  // only runs while it is open
+  auto setSpectrum = [this](const juce::Array<juce::var> &args,
+                            juce::WebBrowserComponent::NativeFunctionCompletion completion) {
+    auto &analyzer = audioProcessor.getSpectrumAnalyzer();
+    if (args.size() > 1) {
+      const auto &options = args[1];
+      if (options.hasProperty("overlap"))
+        analyzer.setOverlap((int)options["overlap"]);
+      if (options.hasProperty("log"))
+        analyzer.setLogFrequency((bool)options["log"]);
+    }
+    setSpectrumAnalysis(args.size() > 0 && (bool)args[0]);
+    completion(juce::var());
   };
 
+  // 2. Initialize WebView
   auto opts = juce::WebBrowserComponent::Options()
-          .withNativeFunction("getAllParameterValues", getParamValues)
+          .withNativeFunction("syncParameters", syncParameters)
+          .withEventListener("parameterChanges", parameterChanges)
+          .withNativeFunction("chooseImpulseResponse", chooseIR)
+          .withNativeFunction("setSpectrumAnalysis", setSpectrum)
           .withBackend(juce::WebBrowserComponent::Options::Backend::webview2)
           .withWinWebView2Options(
               juce::WebBrowserComponent::Options::WinWebView2()
@@ -233,55 +64,36 @@ WAVFinEffectEngineAudioProcessorEditor::WAVFinEffectEngineAudioProcessorEditor(
                       juce::File::tempDirectory)))
           .withResourceProvider(
               [this](const auto &url) { return getResource(url); })
-          .withNativeIntegrationEnabled()
-          .withOptionsFrom(globalMixRelay)
-          .withOptionsFrom(outputGainRelay)
-          .withOptionsFrom(reverbEnableRelay)
-          .withOptionsFrom(reverbSizeRelay)
-          .withOptionsFrom(reverbDecayRelay)
-          .withOptionsFrom(reverbMixRelay)
-          .withOptionsFrom(delayEnableRelay)
-          .withOptionsFrom(delayTimeRelay)
-          .withOptionsFrom(delayFeedbackRelay)
-          .withOptionsFrom(delayMixRelay)
-          .withOptionsFrom(chorusEnableRelay)
-          .withOptionsFrom(chorusRateRelay)
-          .withOptionsFrom(chorusDepthRelay)
-          .withOptionsFrom(chorusMixRelay)
-          .withOptionsFrom(filterEnableRelay)
-          .withOptionsFrom(filterCutoffRelay)
-          .withOptionsFrom(filterResRelay)
-          .withOptionsFrom(filterLfoRateRelay)
-          .withOptionsFrom(filterLfoDepthRelay)
-          .withOptionsFrom(panEnableRelay)
-          .withOptionsFrom(panRateRelay)
-          .withOptionsFrom(panDepthRelay)
-          .withOptionsFrom(halftimeEnableRelay)
-          .withOptionsFrom(halftimeMixRelay)
-          .withOptionsFrom(halftimeFadeRelay)
-          .withOptionsFrom(vintageEnableRelay)
-          .withOptionsFrom(vintageWowRelay)
-          .withOptionsFrom(vintageFlutterRelay)
-          .withOptionsFrom(vintageNoiseRelay)
-          .withOptionsFrom(satEnableRelay)
-          .withOptionsFrom(satDriveRelay)
-          .withOptionsFrom(satTypeRelay)
-          .withOptionsFrom(satMixRelay);
-  webView = std::make_unique<WAVFinWebView>(opts);
-  webView->onPageLoaded = [this](const juce::String& /*url*/) { syncParametersToWebView(); };
+          .withNativeIntegrationEnabled();
+
+#if WAVFIN_ENABLE_STAGE_PROFILING
+  // Per-stage CPU timings of the last profiling window (debug and profiling builds only)
+  opts = opts.withNativeFunction(
+      "getStageTimings",
+      [this](const juce::Array<juce::var> &,
+             juce::WebBrowserComponent::NativeFunctionCompletion completion) {
+        completion(audioProcessor.getStageTimings());
+      });
+#endif
+
+  webView = std::make_unique<juce::WebBrowserComponent>(opts);
 
   addAndMakeVisible(*webView);
+  audioProcessor.getConvolution().addChangeListener(this);
+  audioProcessor.attachMeterReader();
 
-  // 4. Load UI
+  // 3. Load UI
   webView->goToURL(juce::WebBrowserComponent::getResourceProviderRoot());
 
-  // 5. Ensure initial layout is correct
+  // 4. Ensure initial layout is correct
   resized();
 }
 
 WAVFinEffectEngineAudioProcessorEditor::
     ~WAVFinEffectEngineAudioProcessorEditor() {
-  stopTimer();
+  audioProcessor.getConvolution().removeChangeListener(this);
+  audioProcessor.detachMeterReader();
+  setSpectrumAnalysis(false);
 }
 
 //==============================================================================
@@ -294,60 +106,125 @@ void WAVFinEffectEngineAudioProcessorEditor::resized() {
     webView->setBounds(getLocalBounds());
 }
 
-void WAVFinEffectEngineAudioProcessorEditor::visibilityChanged() {
-  juce::AudioProcessorEditor::visibilityChanged();
-  // When editor becomes visible, sync parameters to WebView. JUCE drops events if
-  // the WebView isn't visible yet. Start a retry timer to catch page load timing.
-  if (!isVisible() || !globalMixAttachment)
+void WAVFinEffectEngineAudioProcessorEditor::sendParameterChanges() {
+  // Nothing is sent while the editor is hidden: the flags keep one pending change per
+  // parameter, and the first frame after it shows again sends them all in one batch
+  if (!webView || !isShowing())
     return;
-  stopTimer();
-  syncRetryCount = 0;
-  syncParametersToWebView();
-  startTimer(100);
+
+  // A page that missed a batch (dropped while it loaded) sees that from "since" and pulls
+  if (auto batch = parameterSync.getNextBatch(); !batch.isVoid())
+    webView->emitEventIfBrowserIsVisible("parameters", batch);
 }
 
-void WAVFinEffectEngineAudioProcessorEditor::timerCallback() {
-  syncParametersToWebView();
-  if (++syncRetryCount >= 15)  // Retry for ~1.5s to catch async page load
-    stopTimer();
+void WAVFinEffectEngineAudioProcessorEditor::sendMeters() {
+  // Every block queued since the last display frame becomes one "meters" event
+  WAVFinEffectEngineAudioProcessor::MeterFrame frame, merged;
+  while (audioProcessor.popMeterFrame(frame))
+    merged.merge(frame);
+
+  if (merged.numSamples == 0 || !webView)
+    return;
+
+  // dBFS to 0.1 dB; mono shows the one channel on both sides
+  auto toDb = [](float gain) {
+    return std::round(juce::Decibels::gainToDecibels(gain, -100.0f) * 10.0f) / 10.0f;
+  };
+  const size_t right = merged.numChannels > 1 ? 1 : 0;
+
+  const bool silent = merged.outputPeak[0] == 0.0f && merged.outputPeak[right] == 0.0f &&
+                      merged.inputPeak[0] == 0.0f && merged.inputPeak[right] == 0.0f;
+  if (silent && std::exchange(metersSilent, true))
+    return;
+  metersSilent = silent;
+
+  // Compact form: in and out are [peak L, peak R, rms L, rms R], gr the limiter's cut and
+  // stages each stage's wet peak in chain order
+  auto levels = [&](const std::array<float, 2> &peak, const std::array<float, 2> &rms) {
+    juce::Array<juce::var> values{toDb(peak[0]), toDb(peak[right]), toDb(rms[0]), toDb(rms[right])};
+    return juce::var(values);
+  };
+
+  juce::Array<juce::var> stages;
+  for (auto level : merged.stageLevels)
+    stages.add(toDb(level));
+
+  juce::DynamicObject::Ptr event(new juce::DynamicObject);
+  event->setProperty("in", levels(merged.inputPeak, merged.inputRms));
+  event->setProperty("out", levels(merged.outputPeak, merged.outputRms));
+  event->setProperty("gr", toDb(merged.limiterGain));
+  event->setProperty("stages", stages);
+  webView->emitEventIfBrowserIsVisible("meters", juce::var(event.get()));
 }
 
-void WAVFinEffectEngineAudioProcessorEditor::syncParametersToWebView() {
-  if (!globalMixAttachment)
+void WAVFinEffectEngineAudioProcessorEditor::setSpectrumAnalysis(bool enabled) {
+  if (enabled == spectrumAttached)
     return;
-  globalMixAttachment->sendInitialUpdate();
-  outputGainAttachment->sendInitialUpdate();
-  reverbEnableAttachment->sendInitialUpdate();
-  reverbSizeAttachment->sendInitialUpdate();
-  reverbDecayAttachment->sendInitialUpdate();
-  reverbMixAttachment->sendInitialUpdate();
-  delayEnableAttachment->sendInitialUpdate();
-  delayTimeAttachment->sendInitialUpdate();
-  delayFeedbackAttachment->sendInitialUpdate();
-  delayMixAttachment->sendInitialUpdate();
-  chorusEnableAttachment->sendInitialUpdate();
-  chorusRateAttachment->sendInitialUpdate();
-  chorusDepthAttachment->sendInitialUpdate();
-  chorusMixAttachment->sendInitialUpdate();
-  filterEnableAttachment->sendInitialUpdate();
-  filterCutoffAttachment->sendInitialUpdate();
-  filterResAttachment->sendInitialUpdate();
-  filterLfoRateAttachment->sendInitialUpdate();
-  filterLfoDepthAttachment->sendInitialUpdate();
-  panEnableAttachment->sendInitialUpdate();
-  panRateAttachment->sendInitialUpdate();
-  panDepthAttachment->sendInitialUpdate();
-  halftimeEnableAttachment->sendInitialUpdate();
-  halftimeMixAttachment->sendInitialUpdate();
-  halftimeFadeAttachment->sendInitialUpdate();
-  vintageEnableAttachment->sendInitialUpdate();
-  vintageWowAttachment->sendInitialUpdate();
-  vintageFlutterAttachment->sendInitialUpdate();
-  vintageNoiseAttachment->sendInitialUpdate();
-  satEnableAttachment->sendInitialUpdate();
-  satDriveAttachment->sendInitialUpdate();
-  satTypeAttachment->sendInitialUpdate();
-  satMixAttachment->sendInitialUpdate();
+
+  spectrumAttached = enabled;
+  if (enabled)
+    audioProcessor.getSpectrumAnalyzer().attachReader();
+  else
+    audioProcessor.getSpectrumAnalyzer().detachReader();
+}
+
+void WAVFinEffectEngineAudioProcessorEditor::sendSpectrum() {
+  // The analyzer publishes at most maxFramesPerSecond frames, so most display frames send nothing
+  WAVFinDSP::SpectrumAnalyzer::Frame frame;
+  if (!spectrumAttached || !webView ||
+      !audioProcessor.getSpectrumAnalyzer().getLatestFrame(frame))
+    return;
+
+  // Whole dB are plenty for the plot and keep the event small
+  auto levels = [](const auto &bands) {
+    juce::Array<juce::var> values;
+    values.ensureStorageAllocated((int)bands.size());
+    for (auto level : bands)
+      values.add((int)std::round(level));
+    return juce::var(values);
+  };
+
+  juce::DynamicObject::Ptr event(new juce::DynamicObject);
+  event->setProperty("minHz", frame.minHz);
+  event->setProperty("maxHz", frame.maxHz);
+  event->setProperty("log", frame.logFrequency);
+  event->setProperty("pre", levels(frame.levels[WAVFinDSP::SpectrumAnalyzer::inputTap]));
+  event->setProperty("post", levels(frame.levels[WAVFinDSP::SpectrumAnalyzer::outputTap]));
+  webView->emitEventIfBrowserIsVisible("spectrum", juce::var(event.get()));
+}
+
+void WAVFinEffectEngineAudioProcessorEditor::changeListenerCallback(
+    juce::ChangeBroadcaster *) {
+  // An IR load finished (or failed and fell back to the previous file)
+  if (webView)
+    webView->emitEventIfBrowserIsVisible("impulseResponse",
+                                         getImpulseResponseName());
+}
+
+void WAVFinEffectEngineAudioProcessorEditor::chooseImpulseResponse() {
+  auto current = audioProcessor.getConvolution().getImpulseResponseFile();
+  impulseResponseChooser = std::make_unique<juce::FileChooser>(
+      "Load Impulse Response",
+      current.existsAsFile()
+          ? current.getParentDirectory()
+          : juce::File::getSpecialLocation(juce::File::userHomeDirectory),
+      "*.wav;*.aif;*.aiff;*.flac");
+
+  impulseResponseChooser->launchAsync(
+      juce::FileBrowserComponent::openMode |
+          juce::FileBrowserComponent::canSelectFiles,
+      [this](const juce::FileChooser &chooser) {
+        auto file = chooser.getResult();
+        if (file.existsAsFile())
+          audioProcessor.getConvolution().loadImpulseResponse(file);
+      });
+}
+
+juce::String
+WAVFinEffectEngineAudioProcessorEditor::getImpulseResponseName() const {
+  return audioProcessor.getConvolution()
+      .getImpulseResponseFile()
+      .getFileNameWithoutExtension();
 }
 
 //==============================================================================
@@ -2,19 +2,11 @@
 
 #include <juce_gui_extra/juce_gui_extra.h>
 #include "PluginProcessor.h"
-#include "ParameterIDs.h"
-
-//==============================================================================
-/** WebView that notifies when page loads - enables sync when JS is ready. */
-struct WAVFinWebView : juce::WebBrowserComponent {
-  using WebBrowserComponent::WebBrowserComponent;
-  std::function<void(const juce::String&)> onPageLoaded;
-  void pageFinishedLoading(const juce::String& url) override;
-};
+#include "ParameterSync.h"
 
 //==============================================================================
 class WAVFinEffectEngineAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                                private juce::Timer
+                                                private juce::ChangeListener
 {
 public:
     WAVFinEffectEngineAudioProcessorEditor (WAVFinEffectEngineAudioProcessor&);
@@ -23,119 +15,39 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
-    void visibilityChanged() override;
 
 private:
-    void timerCallback() override;
-    void syncParametersToWebView();
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+    void sendParameterChanges();
+    void sendMeters();
+    void sendSpectrum();
+    void setSpectrumAnalysis(bool enabled);
+    void chooseImpulseResponse();
+    juce::String getImpulseResponseName() const;
 
     WAVFinEffectEngineAudioProcessor& audioProcessor;
-    int syncRetryCount{0};
 
     // ═══════════════════════════════════════════════════════════════════
     // CRITICAL: Member Declaration Order (Prevents DAW Crashes)
     // ═══════════════════════════════════════════════════════════════════
-    // 1. PARAMETER RELAYS FIRST
-    
-    // Global
-    juce::WebSliderRelay globalMixRelay       { "global_mix" };
-    juce::WebSliderRelay outputGainRelay      { "output_gain" };
-
-    // Reverb
-    juce::WebToggleButtonRelay  reverbEnableRelay   { "reverb_enable" };
-    juce::WebSliderRelay reverbSizeRelay     { "reverb_size" };
-    juce::WebSliderRelay reverbDecayRelay    { "reverb_decay" };
-    juce::WebSliderRelay reverbMixRelay      { "reverb_mix" };
-
-    // Delay
-    juce::WebToggleButtonRelay  delayEnableRelay    { "delay_enable" };
-    juce::WebSliderRelay delayTimeRelay      { "delay_time" };
-    juce::WebSliderRelay delayFeedbackRelay  { "delay_feedback" };
-    juce::WebSliderRelay delayMixRelay       { "delay_mix" };
-
-    // Chorus
-    juce::WebToggleButtonRelay  chorusEnableRelay   { "chorus_enable" };
-    juce::WebSliderRelay chorusRateRelay     { "chorus_rate" };
-    juce::WebSliderRelay chorusDepthRelay    { "chorus_depth" };
-    juce::WebSliderRelay chorusMixRelay      { "chorus_mix" };
-
-    // AutoFilter
-    juce::WebToggleButtonRelay  filterEnableRelay   { "filter_enable" };
-    juce::WebSliderRelay filterCutoffRelay   { "filter_cutoff" };
-    juce::WebSliderRelay filterResRelay      { "filter_res" };
-    juce::WebSliderRelay filterLfoRateRelay  { "filter_lfo_rate" };
-    juce::WebSliderRelay filterLfoDepthRelay { "filter_lfo_depth" };
-
-    // Autopan
-    juce::WebToggleButtonRelay  panEnableRelay      { "pan_enable" };
-    juce::WebSliderRelay panRateRelay        { "pan_rate" };
-    juce::WebSliderRelay panDepthRelay       { "pan_depth" };
-
-    // Halftime
-    juce::WebToggleButtonRelay  halftimeEnableRelay { "halftime_enable" };
-    juce::WebSliderRelay halftimeMixRelay    { "halftime_mix" };
-    juce::WebSliderRelay halftimeFadeRelay   { "halftime_fade" };
-
-    // Vintage
-    juce::WebToggleButtonRelay  vintageEnableRelay  { "vintage_enable" };
-    juce::WebSliderRelay vintageWowRelay     { "vintage_wow" };
-    juce::WebSliderRelay vintageFlutterRelay { "vintage_flutter" };
-    juce::WebSliderRelay vintageNoiseRelay   { "vintage_noise" };
-
-    // Saturation
-    juce::WebToggleButtonRelay  satEnableRelay      { "sat_enable" };
-    juce::WebSliderRelay satDriveRelay       { "sat_drive" };
-    juce::WebComboBoxRelay satTypeRelay      { "sat_type" };
-    juce::WebSliderRelay satMixRelay         { "sat_mix" };
+    // 1. PARAMETER SYNC FIRST: the WebView's callbacks use it, so it outlives the WebView.
+    //    The page pulls every value with syncParameters once it is ready; after that each
+    //    direction sends at most one batch of changes per display frame
+    ParameterSync parameterSync { audioProcessor };
 
 
     // 2. WEBVIEW SECOND
-    std::unique_ptr<WAVFinWebView> webView;
-
-
-    // 3. PARAMETER ATTACHMENTS LAST
-    std::unique_ptr<juce::WebSliderParameterAttachment> globalMixAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> outputGainAttachment;
-
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> reverbEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> reverbSizeAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> reverbDecayAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> reverbMixAttachment;
-
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> delayEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> delayTimeAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> delayFeedbackAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> delayMixAttachment;
-
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> chorusEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> chorusRateAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> chorusDepthAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> chorusMixAttachment;
-
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> filterEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> filterCutoffAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> filterResAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> filterLfoRateAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> filterLfoDepthAttachment;
-
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> panEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> panRateAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> panDepthAttachment;
+    std::unique_ptr<juce::WebBrowserComponent> webView;
 
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> halftimeEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> halftimeMixAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> halftimeFadeAttachment;
 
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> vintageEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> vintageWowAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> vintageFlutterAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> vintageNoiseAttachment;
+    // 3. PARAMETERS, METERS AND SPECTRUM: sent once per display frame, after the WebView exists and before it goes
+    bool metersSilent = false;     // the last event sent was silence, so another would change nothing
+    bool spectrumAttached = false; // the web UI's spectrum view is open, so the analyzer runs
+    juce::VBlankAttachment frameVBlank { this, [this] { sendParameterChanges(); sendMeters(); sendSpectrum(); } };
 
-    std::unique_ptr<juce::WebToggleButtonParameterAttachment> satEnableAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> satDriveAttachment;
-    std::unique_ptr<juce::WebComboBoxParameterAttachment> satTypeAttachment;
-    std::unique_ptr<juce::WebSliderParameterAttachment> satMixAttachment;
 
+    // IR file browser (kept alive while the async dialog is open)
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
 
     // Resource provider function
     std::optional<juce::WebBrowserComponent::Resource> getResource (const juce::String& url);
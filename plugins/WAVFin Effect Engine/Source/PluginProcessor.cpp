@@ -1,7 +1,55 @@
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! WAVFIN_HEADLESS
+ #include "PluginEditor.h"
+#endif
+#include "DSP/AllocationGuard.h"
+#include "DSP/MixKernels.h"
 #include <cmath>
 
+namespace
+{
+    // delay_time tops out at 2000 ms; synced divisions are capped to the same range
+    constexpr double delayMaxSeconds = 2.0;
+
+    // State property holding the impulse response path
+    const juce::Identifier impulseResponseProperty { "impulseResponse" };
+
+    // Parameters that decide which stages run and how; a change rebuilds the chain plan
+    const juce::ParameterID* const chainPlanParameters[] =
+    {
+        &ParameterIDs::halftime_enable,
+        &ParameterIDs::sat_enable, &ParameterIDs::sat_type, &ParameterIDs::sat_quality,
+        &ParameterIDs::filter_enable, &ParameterIDs::filter_type,
+        &ParameterIDs::vintage_enable, &ParameterIDs::vintage_noise_color,
+        &ParameterIDs::chorus_enable,
+        &ParameterIDs::pan_enable,
+        &ParameterIDs::delay_enable, &ParameterIDs::delay_mode, &ParameterIDs::delay_quality,
+        &ParameterIDs::reverb_enable
+    };
+
+    // How often the message thread looks for a plan or latency change
+    constexpr int chainPlanPollHz = 50;
+
+    // Audio time each set of stage timings covers
+    constexpr double profileWindowSeconds = 1.0;
+
+    // The safety soft limiter is transparent below this level
+    constexpr double softLimitThreshold = 0.9;
+
+    // Blocks the meter queue holds; the editor drains it every display frame
+    constexpr int meterQueueFrames = 256;
+
+    /** Lookahead per limiter_lookahead choice; the last entry sizes the limiter. */
+    constexpr double limiterLookaheadSeconds[] = { 0.001, 0.002, 0.005, 0.010 };
+
+    /** Beats per delay_sync choice (0 = free running, uses delay_time). */
+    double delaySyncBeats (int index)
+    {
+        constexpr double beats[] = { 0.0, 0.25, 1.0 / 3.0, 0.5, 0.75, 2.0 / 3.0, 1.0, 1.5, 2.0, 4.0 };
+        return beats[juce::jlimit (0, (int) std::size (beats) - 1, index)];
+    }
+}
+
 //==============================================================================
 WAVFinEffectEngineAudioProcessor::WAVFinEffectEngineAudioProcessor()
     : AudioProcessor (BusesProperties()
@@ -12,11 +60,14 @@ WAVFinEffectEngineAudioProcessor::WAVFinEffectEngineAudioProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ),
-      apvts (*this, nullptr, "Parameters", createParameterLayout())
+      apvts (*this, nullptr, "Parameters", createParameterLayout()),
+      meterQueue (meterQueueFrames)
 {
     // Initialize parameter pointers
     globalMixParam     = apvts.getRawParameterValue ("global_mix");
     outputGainParam    = apvts.getRawParameterValue ("output_gain");
+    limiterModeParam   = apvts.getRawParameterValue ("limiter_mode");
+    limiterLookaheadParam = apvts.getRawParameterValue ("limiter_lookahead");
     
     reverbEnableParam  = apvts.getRawParameterValue ("reverb_enable");
     delayEnableParam   = apvts.getRawParameterValue ("delay_enable");
@@ -29,12 +80,16 @@ WAVFinEffectEngineAudioProcessor::WAVFinEffectEngineAudioProcessor()
 
     filterCutoffParam  = apvts.getRawParameterValue ("filter_cutoff");
     filterResParam     = apvts.getRawParameterValue ("filter_res");
+    filterTypeParam    = apvts.getRawParameterValue ("filter_type");
     filterLfoRateParam = apvts.getRawParameterValue ("filter_lfo_rate");
     filterLfoDepthParam = apvts.getRawParameterValue ("filter_lfo_depth");
+    filterLfoShapeParam = apvts.getRawParameterValue ("filter_lfo_shape");
+    filterLfoSyncParam = apvts.getRawParameterValue ("filter_lfo_sync");
     
     satDriveParam      = apvts.getRawParameterValue ("sat_drive");
     satTypeParam       = apvts.getRawParameterValue ("sat_type");
     satMixParam        = apvts.getRawParameterValue ("sat_mix");
+    satQualityParam    = apvts.getRawParameterValue ("sat_quality");
 
     chorusRateParam    = apvts.getRawParameterValue ("chorus_rate");
     chorusDepthParam   = apvts.getRawParameterValue ("chorus_depth");
@@ -43,24 +98,43 @@ WAVFinEffectEngineAudioProcessor::WAVFinEffectEngineAudioProcessor()
     reverbSizeParam    = apvts.getRawParameterValue ("reverb_size");
     reverbDecayParam   = apvts.getRawParameterValue ("reverb_decay");
     reverbMixParam     = apvts.getRawParameterValue ("reverb_mix");
+    convMixParam       = apvts.getRawParameterValue ("conv_mix");
 
     delayTimeParam     = apvts.getRawParameterValue ("delay_time");
     delayFeedbackParam = apvts.getRawParameterValue ("delay_feedback");
     delayMixParam      = apvts.getRawParameterValue ("delay_mix");
+    delaySyncParam     = apvts.getRawParameterValue ("delay_sync");
+    delayModeParam     = apvts.getRawParameterValue ("delay_mode");
+    delayQualityParam  = apvts.getRawParameterValue ("delay_quality");
     
     panRateParam       = apvts.getRawParameterValue ("pan_rate");
     panDepthParam      = apvts.getRawParameterValue ("pan_depth");
+    panShapeParam      = apvts.getRawParameterValue ("pan_shape");
+    panSyncParam       = apvts.getRawParameterValue ("pan_sync");
     
     halftimeMixParam   = apvts.getRawParameterValue ("halftime_mix");
     halftimeFadeParam  = apvts.getRawParameterValue ("halftime_fade");
+    halftimeLengthParam = apvts.getRawParameterValue ("halftime_length");
     
     vintageWowParam    = apvts.getRawParameterValue ("vintage_wow");
     vintageFlutterParam = apvts.getRawParameterValue ("vintage_flutter");
     vintageNoiseParam  = apvts.getRawParameterValue ("vintage_noise");
+    vintageNoiseColorParam = apvts.getRawParameterValue ("vintage_noise_color");
+
+    // parameterChanged() only flags the plan; the timer rebuilds it on the message thread
+    for (const auto* id : chainPlanParameters)
+        apvts.addParameterListener (id->getParamID(), this);
+
+    rebuildChainPlan();
+    startTimerHz (chainPlanPollHz);
 }
 
 WAVFinEffectEngineAudioProcessor::~WAVFinEffectEngineAudioProcessor()
 {
+    stopTimer();
+
+    for (const auto* id : chainPlanParameters)
+        apvts.removeParameterListener (id->getParamID(), this);
 }
 
 //==============================================================================
@@ -98,7 +172,8 @@ bool WAVFinEffectEngineAudioProcessor::isMidiEffect() const
 
 double WAVFinEffectEngineAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Infinite while the delay feedback is at 100% (JUCE reports that to the host as such)
+    return tailLengthSeconds.load (std::memory_order_relaxed);
 }
 
 int WAVFinEffectEngineAudioProcessor::getNumPrograms()
@@ -129,66 +204,165 @@ void WAVFinEffectEngineAudioProcessor::changeProgramName (int index, const juce:
 void WAVFinEffectEngineAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax (1, samplesPerBlock);
     
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
 
-    filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    filter.prepare(spec);
-    filter.setCutoffFrequency(20000.0f);  // Initialize to max frequency (no filtering)
-    filter.setResonance(0.1f);             // Initialize to default resonance
+    // Convolution: the IR is resampled to this rate; offline renders compute the tail inline
+    convolution.prepare(sampleRate, static_cast<int>(spec.numChannels), isNonRealtime());
+
+    transportClock.prepare(sampleRate);
+    profiler.prepare (sampleRate, profileWindowSeconds);
+    spectrum.prepare (sampleRate);
+    unsentMeter = {};
+
+    // Only the precision the host asked for is prepared (see Engine)
+    if (isUsingDoublePrecision())
+    {
+        floatEngine.scratch.release();
+        prepareEngine<double> (spec);
+    }
+    else
+    {
+        doubleEngine.scratch.release();
+        prepareEngine<float> (spec);
+    }
+
+    // The audio thread is stopped, so the plan can be taken up directly and the host told the latency now
+    rebuildChainPlan();
+    chainPlans.update();
+    reportLatency();
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::prepareEngine (const juce::dsp::ProcessSpec& spec)
+{
+    auto& e = getEngine<SampleType>();
+    const double sampleRate = spec.sampleRate;
 
-    saturator.prepare(spec);
-    saturator.functionToUse = [] (float x) { return std::tanh(x); };
+    // Cutoff and resonance arrive per chunk from the smoothers (see processChunk)
+    e.filter.prepare(static_cast<int>(spec.numChannels), sampleRate, maxBlockSize);
+
+    // Saturation: oversampler stages for every factor are allocated here
+    e.saturation.prepare(spec);
+
+    // True-peak limiter: sized for the longest lookahead, so switching it on or changing the window never allocates
+    const double maxLookahead = limiterLookaheadSeconds[std::size (limiterLookaheadSeconds) - 1];
+    e.limiter.prepare(static_cast<int>(spec.numChannels), sampleRate, maxBlockSize, maxLookahead);
+    e.truePeakLimiting = false;
+
+    e.globalDryDelay.prepare(static_cast<int>(spec.numChannels),
+                             WAVFinDSP::HalfBandOversampler<SampleType>::getLatencyForStages (WAVFinDSP::HalfBandOversampler<SampleType>::maxNumStages)
+                               + WAVFinDSP::TruePeakLimiter<SampleType>::getLatencyForLookahead (maxLookahead, sampleRate));
+    updateLatency<SampleType>();
 
     // Initialize Chorus with dry signal (no effect)
-    chorus.prepare(spec);
-    chorus.setRate(1.0f);
-    chorus.setDepth(0.0f);     // No modulation depth
-    chorus.setMix(0.0f);       // 100% dry signal
+    e.chorus.prepare(spec);
+    e.chorus.setRate(1.0f);
+    e.chorus.setDepth(0.0f);     // No modulation depth
+    e.chorus.setMix(0.0f);       // 100% dry signal
     
-    // Initialize Reverb with dry signal (no effect)
-    reverb.prepare(spec);
-    juce::dsp::Reverb::Parameters revParams;
-    revParams.roomSize = 0.5f;
-    revParams.damping = 0.5f;
-    revParams.wetLevel = 0.0f;  // 100% dry signal
-    revParams.dryLevel = 1.0f;
-    reverb.setParameters(revParams);
-    
-    // Initialize Output Gain to unity (0dB)
-    outputGain.prepare(spec);
-    outputGain.setRampDurationSeconds(0.02);
-    outputGain.setGainDecibels(0.0f);  // Unity gain by default
+    // Reverb: line lengths are converted from ms at this sample rate
+    e.reverb.prepare(sampleRate);
 
-    delayLine.prepare(spec);
-    vintageDelay.prepare(spec);
+    e.delay.prepare(static_cast<int>(spec.numChannels), sampleRate, delayMaxSeconds);
+    e.vintageDelay.prepare(spec);
+    e.vintageNoise.prepare(static_cast<int>(spec.numChannels), sampleRate, maxBlockSize);
+    
+    // Parameter ramps: 20ms everywhere, 50ms for delay time to avoid pitch jumps
+    e.smoothers.prepare (numSmoothedParams, sampleRate, maxBlockSize, 0.02);
+    e.smoothers.setRampDuration (smoothDelayTime, 0.05);
+    updateSmoothedTargets<SampleType> (true);
     
-    // Initialize smoothed delay time (50ms ramp to prevent clicks)
-    smoothedDelayTime.reset(sampleRate, 0.05);  // 50ms ramp time
-    smoothedDelayTime.setCurrentAndTargetValue(0.0f);
+    // LFO buffers; wow and flutter run at fixed tape-like rates
+    e.modulation.prepare (numLfoStreams, sampleRate, maxBlockSize);
+    e.modulation.setRate (lfoWow, 0.5);
+    e.modulation.setRate (lfoFlutter, 8.0);
+    updateModulation<SampleType>();
     
-    // Initialize halftime buffer (approx 2.9 seconds at current sample rate for easy dual-voice wrap)
-    // We want a power-of-two or a size that allows two voices at 180 deg phase
-    int halftimeBufferSize = static_cast<int>(sampleRate * 2.0);
-    halftimeBuffer.setSize(spec.numChannels, halftimeBufferSize);
-    halftimeBuffer.clear();
-    halftimeWritePos = 0;
-    halftimeReadPos1 = 0.0f;
-    halftimeReadPos2 = static_cast<float>(halftimeBufferSize / 2);
-    halftimeBufferFilled = false;
+    // Halftime ring buffer is sized from the tempo (see prepareHalftime)
+    prepareHalftime<SampleType>();
     
-    // Initialize global dry buffer
-    globalDryBuffer.setSize(spec.numChannels, samplesPerBlock);
-    globalDryBuffer.clear();
+    // Reserve every scratch buffer the chain needs (global dry, saturation dry, reverb and convolution wet, filter cutoff)
+    e.scratch.prepare (numScratchSlots,
+                       juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()),
+                       maxBlockSize);
+
+    if constexpr (! std::is_same_v<SampleType, float>)
+        e.convolutionBuffer.setSize (static_cast<int>(spec.numChannels), maxBlockSize);
+
+    // Every stage starts awake; tails depend on the buffers sized above
+    e.activity.prepare (numChainStages);
+    updateTailLength<SampleType>();
+
+    e.pendingWetMix = numSmoothedParams;
+    e.stageMuted.fill (false);
+}
+
+namespace
+{
+    // Longest halftime crossfade (halftime_fade = 100) and the tempo floor the ring buffer covers
+    constexpr double halftimeMaxFadeSeconds = 0.21;
+    constexpr double halftimeSlowestFullLoopBpm = 60.0;
+    constexpr double halftimeMaxLoopBars = 2.0;
+
+    double halftimeLoopBars (const std::atomic<float>* lengthParam)
+    {
+        // 0: 1/2 bar, 1: 1 bar, 2: 2 bars
+        const int index = lengthParam != nullptr ? static_cast<int> (lengthParam->load()) : 1;
+        return index == 0 ? 0.5 : (index == 2 ? 2.0 : 1.0);
+    }
+
+    // Tails are reported to the host down to -60 dB; stages only sleep once their state is below -100 dB
+    constexpr double reportedDecayDb = 60.0;
+    constexpr double sleepDecayDb = 100.0;
+
+    // Longest delays inside the short stages: SVF ringing, vintage wow line (10 ms + 2.5 ms), chorus line
+    constexpr double filterTailSeconds = 0.05;
+    constexpr double vintageTailSeconds = 0.0125;
+    constexpr double chorusTailSeconds = 0.1;
+
+    /** Time for a feedback loop to fall by decayDb after its input stops; infinite at unity gain. */
+    double feedbackTailSeconds (double loopSeconds, double feedback, double decayDb)
+    {
+        if (feedback <= 0.0)
+            return loopSeconds;
+
+        if (feedback >= 0.999)
+            return std::numeric_limits<double>::infinity();
+
+        const double repeats = std::ceil (decayDb / (-20.0 * std::log10 (feedback)));
+        return loopSeconds * (1.0 + repeats);
+    }
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::prepareHalftime()
+{
+    auto& halftime = getEngine<SampleType>().halftime;
+
+    // The slowed voice lags the write head by half a loop, so the ring must hold half
+    // of the longest loop (2 bars) at the host tempo, and at least at 60 BPM.
+    const double bpm = juce::jmin (transportClock.getBpm(), halftimeSlowestFullLoopBpm);
+    const double loopSamples = halftimeMaxLoopBars * transportClock.getBeatsPerBar() * 60.0 / bpm * currentSampleRate;
+    const double fadeSamples = halftimeMaxFadeSeconds * currentSampleRate;
+
+    halftime.prepare (getTotalNumOutputChannels(), maxBlockSize,
+                      WAVFinDSP::HalftimeEngine<SampleType>::getRequiredBufferSize (loopSamples, fadeSamples, maxBlockSize));
+
+    // Slower tempos than the buffer was sized for retrigger early rather than read stale audio
+    transportClock.setMaxLoopSamples (halftime.getMaxLoopSamples (fadeSamples));
 }
 
 void WAVFinEffectEngineAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as a place to free up any
     // spare memory, etc.
+    floatEngine.scratch.release();
+    doubleEngine.scratch.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -216,441 +390,934 @@ bool WAVFinEffectEngineAudioProcessor::isBusesLayoutSupported (const BusesLayout
 }
 #endif
 
+template <typename SampleType>
 void WAVFinEffectEngineAudioProcessor::updateParameters()
 {
-    if (filterCutoffParam && filterResParam)
+    // Continuous values only set ramp targets here; stages read them per chunk
+    updateSmoothedTargets<SampleType> (false);
+    updateLatency<SampleType>();
+    updateModulation<SampleType>();
+    updateTailLength<SampleType>();
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::updateTailLength()
+{
+    const auto& e = getEngine<SampleType>();
+
+    auto isEnabled = [] (const std::atomic<float>* param) { return param != nullptr && param->load() > 0.5f; };
+    auto valueOf = [] (const std::atomic<float>* param, float fallback) { return param != nullptr ? param->load() : fallback; };
+
+    const double sr = currentSampleRate;
+    const double loopSeconds = halftimeLoopBars (halftimeLengthParam) * transportClock.getBeatsPerBar() * 60.0 / transportClock.getBpm();
+    const double delaySeconds = getDelayTimeSamples() / sr;
+    const double feedback = valueOf (delayFeedbackParam, 0.0f) * 0.01;
+    const double reverbDecay = valueOf (reverbDecayParam, 2.0f);
+    const double reverbLineSeconds = e.reverb.getBufferSize() / sr;
+    const double impulseSeconds = convolution.getImpulseLengthSeconds();
+    const bool convolutionOn = valueOf (convMixParam, 0.0f) > 0.0f;
+
+    // Per stage: whether it is on, the tail reported to the host, and how long its
+    // input and output must stay quiet before it may sleep (all in seconds)
+    struct StageTail { bool enabled; double reported, memory; };
+
+    const std::array<StageTail, numChainStages> tails {{
+        { isEnabled (halftimeEnableParam), loopSeconds + halftimeMaxFadeSeconds, e.halftime.getBufferSize() / sr },
+        // Saturation latency is reported separately; the oversampling filters still need flushing
+        { isEnabled (satEnableParam), 0.0, 2.0 * e.saturation.getLatencyInSamples() / sr },
+        { isEnabled (filterEnableParam), filterTailSeconds, filterTailSeconds },
+        { isEnabled (vintageEnableParam), vintageTailSeconds, vintageTailSeconds },
+        { isEnabled (chorusEnableParam), chorusTailSeconds, chorusTailSeconds },
+        { isEnabled (panEnableParam), 0.0, 0.0 },
+        { isEnabled (delayEnableParam), feedbackTailSeconds (delaySeconds, feedback, reportedDecayDb),
+                                        feedbackTailSeconds (delaySeconds, feedback, sleepDecayDb) },
+        { isEnabled (reverbEnableParam), reverbDecay + reverbLineSeconds,
+                                         reverbDecay * sleepDecayDb / reportedDecayDb + reverbLineSeconds },
+        // The IR runs inside the reverb stage
+        { isEnabled (reverbEnableParam) && convolutionOn, impulseSeconds, impulseSeconds }
+    }};
+
+    double total = 0.0;
+
+    for (size_t i = 0; i < tails.size(); ++i)
     {
-        filter.setCutoffFrequency (filterCutoffParam->load());
-        filter.setResonance (filterResParam->load());
+        // A block of margin covers the smoothers still ramping towards these values
+        stageMemory[i] = std::isfinite (tails[i].memory) ? static_cast<juce::int64> (std::ceil (tails[i].memory * sr)) + maxBlockSize
+                                                         : std::numeric_limits<juce::int64>::max();
+
+        if (tails[i].enabled)
+            total += tails[i].reported;
     }
 
-    if (chorusRateParam && chorusDepthParam && chorusMixParam)
+    tailLengthSeconds.store (total, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::updateModulation()
+{
+    using Shape = typename WAVFinDSP::ModulationBank<SampleType>::Shape;
+    auto& modulation = getEngine<SampleType>().modulation;
+
+    auto set = [&modulation] (LfoStream stream, std::atomic<float>* shape, std::atomic<float>* sync)
+    {
+        if (shape != nullptr)
+            modulation.setShape (stream, static_cast<Shape> (static_cast<int> (shape->load())));
+        if (sync != nullptr)
+            modulation.setTempoSync (stream, sync->load() > 0.5f);
+    };
+
+    set (lfoFilter, filterLfoShapeParam, filterLfoSyncParam);
+    set (lfoPan, panShapeParam, panSyncParam);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::updateSmoothedTargets (bool jumpToTargets)
+{
+    auto& smoothers = getEngine<SampleType>().smoothers;
+
+    auto set = [&smoothers, jumpToTargets] (SmoothedParam index, std::atomic<float>* source, float scale)
+    {
+        if (source == nullptr)
+            return;
+
+        const auto value = static_cast<SampleType> (source->load() * scale);
+
+        if (jumpToTargets)
+            smoothers.setCurrentAndTargetValue (index, value);
+        else
+            smoothers.setTargetValue (index, value);
+    };
+
+    constexpr float percent = 0.01f;
+    set (smoothGlobalMix,       globalMixParam,       percent);
+    set (smoothReverbSize,      reverbSizeParam,      percent);
+    set (smoothReverbDecay,     reverbDecayParam,     1.0f);
+    set (smoothReverbMix,       reverbMixParam,       percent);
+    set (smoothConvMix,         convMixParam,         percent);
+    set (smoothDelayFeedback,   delayFeedbackParam,   percent);
+    set (smoothDelayMix,        delayMixParam,        percent);
+    set (smoothChorusRate,      chorusRateParam,      1.0f);
+    set (smoothChorusDepth,     chorusDepthParam,     percent);
+    set (smoothChorusMix,       chorusMixParam,       percent);
+    set (smoothFilterCutoff,    filterCutoffParam,    1.0f);
+    set (smoothFilterRes,       filterResParam,       1.0f);
+    set (smoothFilterLfoRate,   filterLfoRateParam,   1.0f);
+    set (smoothFilterLfoDepth,  filterLfoDepthParam,  percent);
+    set (smoothPanRate,         panRateParam,         1.0f);
+    set (smoothPanDepth,        panDepthParam,        percent);
+    set (smoothHalftimeMix,     halftimeMixParam,     percent);
+    set (smoothHalftimeFade,    halftimeFadeParam,    1.0f);
+    set (smoothVintageWow,      vintageWowParam,      percent);
+    set (smoothVintageFlutter,  vintageFlutterParam,  percent);
+    set (smoothVintageNoise,    vintageNoiseParam,    percent);
+    set (smoothSatDrive,        satDriveParam,        1.0f);
+    set (smoothSatMix,          satMixParam,          percent);
+
+    // Delay time in samples, from the time knob or the host tempo
+    const auto delayTime = static_cast<SampleType> (getDelayTimeSamples());
+
+    if (jumpToTargets)
+        smoothers.setCurrentAndTargetValue (smoothDelayTime, delayTime);
+    else
+        smoothers.setTargetValue (smoothDelayTime, delayTime);
+
+    // Output gain ramps in the linear domain
+    if (outputGainParam != nullptr)
     {
-        chorus.setRate (chorusRateParam->load());
-        chorus.setDepth (chorusDepthParam->load() / 100.0f);
-        chorus.setMix (chorusMixParam->load() / 100.0f);
+        const auto gain = juce::Decibels::decibelsToGain (static_cast<SampleType> (outputGainParam->load()));
+
+        if (jumpToTargets)
+            smoothers.setCurrentAndTargetValue (smoothOutputGain, gain);
+        else
+            smoothers.setTargetValue (smoothOutputGain, gain);
     }
+}
+
+double WAVFinEffectEngineAudioProcessor::getDelayTimeSamples() const
+{
+    const int syncIndex = delaySyncParam != nullptr ? static_cast<int> (delaySyncParam->load()) : 0;
+    double seconds = delayTimeParam != nullptr ? delayTimeParam->load() * 0.001 : 0.5;
+
+    if (const double beats = delaySyncBeats (syncIndex); beats > 0.0)
+        seconds = beats * 60.0 / transportClock.getBpm();
+
+    return juce::jmin (seconds, delayMaxSeconds) * currentSampleRate;
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::updateLatency()
+{
+    auto& e = getEngine<SampleType>();
+
+    // Oversampling quality and the limiter settings are per-session choices (not automatable).
+    // Everything is preallocated, so switching here is allocation-free. The new latency is only
+    // stored; reportLatency() tells the host.
+    const int stages = satQualityParam != nullptr ? static_cast<int> (satQualityParam->load()) : 0;
+    e.saturation.setOversampling (stages);
+
+    const bool truePeak = limiterModeParam != nullptr && static_cast<int> (limiterModeParam->load()) == 1;
+    const int lookaheadIndex = limiterLookaheadParam != nullptr ? static_cast<int> (limiterLookaheadParam->load()) : 2;
+    e.limiter.setLookahead (limiterLookaheadSeconds[juce::jlimit (0, (int) std::size (limiterLookaheadSeconds) - 1, lookaheadIndex)]);
+
+    // Audio left in the lookahead from an earlier session must not play out
+    if (truePeak && ! e.truePeakLimiting)
+        e.limiter.reset();
+
+    e.truePeakLimiting = truePeak;
+
+    int latency = e.saturation.getLatencyInSamples();
+
+    if (e.truePeakLimiting)
+        latency += e.limiter.getLatencyInSamples();
+
+    e.globalDryDelay.setDelay (latency);
+    latencyToReport.store (latency, std::memory_order_relaxed);
+}
+
+void WAVFinEffectEngineAudioProcessor::reportLatency()
+{
+    // setLatencySamples calls the host's listeners under a lock, so it never runs on a realtime audio thread
+    const auto latency = latencyToReport.load (std::memory_order_relaxed);
 
-    if (reverbSizeParam && reverbMixParam)
+    if (latency != getLatencySamples())
+        setLatencySamples (latency);
+}
+
+#if WAVFIN_ENABLE_STAGE_PROFILING
+juce::var WAVFinEffectEngineAudioProcessor::getStageTimings()
+{
+    // Indexed by ProfileSection
+    static constexpr const char* sectionNames[] =
     {
-        juce::dsp::Reverb::Parameters revParams;
-        revParams.roomSize = reverbSizeParam->load() / 100.0f;
-        revParams.damping = 0.5f;
-        revParams.wetLevel = reverbMixParam->load() / 100.0f;
-        revParams.dryLevel = 1.0f - revParams.wetLevel;
-        reverb.setParameters (revParams);
+        "halftime", "saturation", "filter", "vintage", "chorus", "pan", "delay", "reverb", "convolution",
+        "output", "block"
+    };
+
+    static_assert (std::size (sectionNames) == (size_t) numProfileSections);
+
+    const auto& snapshot = profiler.getLatest();
+    auto* sections = new juce::DynamicObject();
+
+    for (int i = 0; i < numProfileSections; ++i)
+    {
+        const auto& timings = snapshot.sections[(size_t) i];
+        auto* section = new juce::DynamicObject();
+        section->setProperty ("calls", timings.numCalls);
+        section->setProperty ("meanUs", timings.meanMicroseconds);
+        section->setProperty ("p99Us", timings.p99Microseconds);
+        section->setProperty ("maxUs", timings.maxMicroseconds);
+        section->setProperty ("cpuPercent", timings.cpuPercent);
+        sections->setProperty (sectionNames[i], section);
     }
 
-    if (outputGainParam)
-        outputGain.setGainDecibels (outputGainParam->load());
+    auto* result = new juce::DynamicObject();
+    result->setProperty ("window", (int) snapshot.windowNumber);
+    result->setProperty ("windowSeconds", snapshot.windowSeconds);
+    result->setProperty ("sections", sections);
+    return result;
 }
+#endif
 
 void WAVFinEffectEngineAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processSamples (buffer);
+}
+
+void WAVFinEffectEngineAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processSamples (buffer);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
+    WAVFinDSP::ScopedNoAllocation noAllocation; // Asserts in test builds if anything below allocates
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateParameters();
+    // Not prepared (or host changed layout without re-preparing): pass through
+    if (maxBlockSize == 0 || buffer.getNumChannels() > getEngine<SampleType>().scratch.getMaxChannels())
+        return;
+
+    const auto blockStart = profiler.now();
+
+    // Input levels and spectrum are taken before the chain overwrites the buffer
+    spectrum.pushSamples (WAVFinDSP::SpectrumAnalyzer::inputTap, buffer);
+    meteringBlock = numMeterReaders.load (std::memory_order_relaxed) > 0;
 
-    // Handle buffer size changes
-    if (buffer.getNumSamples() != lastBufferSize)
+    if (meteringBlock)
     {
-        lastBufferSize = buffer.getNumSamples();
-        globalDryBuffer.setSize(buffer.getNumChannels(), lastBufferSize, false, false, true);
+        blockMeter = {};
+        blockMeter.numSamples = buffer.getNumSamples();
+        blockMeter.numChannels = juce::jmin (buffer.getNumChannels(), MeterFrame::maxChannels);
+        measureLevels (buffer, blockMeter.inputPeak, blockMeter.inputRms);
     }
 
-    // 0. Capture dry signal for global mix
-    if (globalMixParam && globalMixParam->load() < 99.0f)
+    // Transport is read once per host block; chunks then advance the clock sample-accurately.
+    // Read first so tempo-synced parameters see this block's tempo.
+    transportClock.setLoopLengthBars (halftimeLoopBars (halftimeLengthParam));
     {
-        globalDryBuffer.makeCopyOf(buffer);
+        auto* playHead = getPlayHead();
+        transportClock.syncToHost (playHead != nullptr ? playHead->getPosition()
+                                                       : juce::Optional<juce::AudioPlayHead::PositionInfo>());
     }
 
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
+    updateParameters<SampleType>();
 
-    // 1. Halftime (IMPROVED: Grid-Synced Dual-Voice with Bar Reset)
-    if (halftimeEnableParam && halftimeEnableParam->load() > 0.5f)
+    // Offline renders have no deadline and may not run a message loop, so the plan is built and
+    // the latency reported here
+    if (isNonRealtime())
     {
-        float mix = halftimeMixParam->load() / 100.0f;
-        float fadeTimeMs = 10.0f + (halftimeFadeParam->load() * 2.0f); // 10ms to 200ms crossfade
-        int bufferSize = buffer.getNumSamples();
-        int halftimeBufferSize = halftimeBuffer.getNumSamples();
+        if (chainPlanDirty.load (std::memory_order_acquire))
+            rebuildChainPlan();
 
-        // --- Get Host Sync Info ---
-        double ppqPosition = 0.0;
-        double bpm = 120.0;
-        bool isPlaying = false;
-        
-        if (auto* playHead = getPlayHead())
-        {
-            if (auto positionInfo = playHead->getPosition())
-            {
-                if (auto bpmVal = positionInfo->getBpm())
-                    bpm = *bpmVal;
-                if (auto ppqVal = positionInfo->getPpqPosition())
-                    ppqPosition = *ppqVal;
-                if (positionInfo->getIsPlaying())
-                    isPlaying = true;
-            }
-        }
-        
-        // Loop Length in Beats (Force 1 Bar = 4 Beats for now, standard Trap Halftime)
-        double loopLengthBeats = 4.0; 
-        double currentBarValues = ppqPosition / loopLengthBeats;
-        double currentBarFract = currentBarValues - std::floor(currentBarValues);
-        
-        // Detect Trigger (New Loop Start)
-        // If we wrapped (fract < last) or just started playing
-        bool trigger = false;
-        if (isPlaying)
-        {
-            if (currentBarFract < lastBarPosition && lastBarPosition > 0.5) 
-                trigger = true;
-        }
-        else 
-        {
-            // Fallback Timer for non-playing hosts (approx 1 bar at 120bpm = 2s)
-            // We just use the free running voices if transport is stopped, 
-            // but we need to update the lastBarPosition to mimic movement for smooth seek
-             lastBarPosition = std::fmod(lastBarPosition + (bufferSize / (currentSampleRate * 2.0)), 1.0);
-             if (lastBarPosition < 0.001) trigger = true;
-        }
+        reportLatency();
+    }
 
-        lastBarPosition = currentBarFract;
+    chainPlans.update();
 
-        // On Trigger: Swap Voices
-        if (trigger)
-        {
-            activeHalftimeVoice = 1 - activeHalftimeVoice; // Swap 0 <-> 1
-            
-            // Reset the NEW active voice to current write head (start of bar)
-            // The OLD active voice continues playing its tail (fade out)
-            if (activeHalftimeVoice == 0) halftimeReadPos1 = static_cast<float>(halftimeWritePos);
-            else                          halftimeReadPos2 = static_cast<float>(halftimeWritePos);
-        }
+    // Scratch buffers are sized for maxBlockSize, so split oversized host blocks.
+    // The referencing AudioBuffer constructor uses preallocated channel space (no heap).
+    const int numSamples = buffer.getNumSamples();
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int chunkSize = juce::jmin (maxBlockSize, numSamples - start);
+        juce::AudioBuffer<SampleType> chunk (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, chunkSize);
+        processChunk (chunk);
+    }
 
-        // Calculate crossfade step
-        float samplesPerFade = (fadeTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
-        float fadeStep = 1.0f / (samplesPerFade > 1.0f ? samplesPerFade : 1.0f);
+    spectrum.pushSamples (WAVFinDSP::SpectrumAnalyzer::outputTap, buffer);
 
-        for (int s = 0; s < bufferSize; ++s)
-        {
-            // Update Crossfade
-            if (activeHalftimeVoice == 0)
-            {
-                // Target: Voice 1 (Fade -> 0.0)
-                if (halftimeCrossfade > 0.0f) halftimeCrossfade = std::max(0.0f, halftimeCrossfade - fadeStep);
-            }
-            else
-            {
-                // Target: Voice 2 (Fade -> 1.0)
-                if (halftimeCrossfade < 1.0f) halftimeCrossfade = std::min(1.0f, halftimeCrossfade + fadeStep);
-            }
-            
-            float gain2 = halftimeCrossfade; // Voice 2 gain
-            float gain1 = 1.0f - gain2;      // Voice 1 gain (Linear or Equal Power? Linear is safer for correlated)
+    if (meteringBlock)
+    {
+        measureLevels (buffer, blockMeter.outputPeak, blockMeter.outputRms);
+        publishMeterFrame();
+    }
 
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                auto* channelData = buffer.getWritePointer(ch);
-                auto* halftimeData = halftimeBuffer.getWritePointer(ch);
-                
-                // Write
-                halftimeData[halftimeWritePos] = channelData[s];
-                
-                // Voice 1 Read
-                int r1_i = static_cast<int>(halftimeReadPos1);
-                int r1_next = (r1_i + 1) % halftimeBufferSize;
-                float f1 = halftimeReadPos1 - static_cast<float>(r1_i);
-                float voice1 = halftimeData[r1_i] + f1 * (halftimeData[r1_next] - halftimeData[r1_i]);
-                
-                // Voice 2 Read
-                int r2_i = static_cast<int>(halftimeReadPos2);
-                int r2_next = (r2_i + 1) % halftimeBufferSize;
-                float f2 = halftimeReadPos2 - static_cast<float>(r2_i);
-                float voice2 = halftimeData[r2_i] + f2 * (halftimeData[r2_next] - halftimeData[r2_i]);
-                
-                // Mix Voices
-                float wetSample = (voice1 * gain1) + (voice2 * gain2);
-                
-                // Mix Dry/Wet
-                channelData[s] = (wetSample * mix) + (channelData[s] * (1.0f - mix));
-            }
-            
-            // Advance positions
-            halftimeWritePos = (halftimeWritePos + 1) % halftimeBufferSize;
-            
-            // Advance read heads at 0.5x speed
-            halftimeReadPos1 += 0.5f;
-            halftimeReadPos2 += 0.5f;
-            
-            if (halftimeReadPos1 >= static_cast<float>(halftimeBufferSize)) halftimeReadPos1 -= static_cast<float>(halftimeBufferSize);
-            if (halftimeReadPos2 >= static_cast<float>(halftimeBufferSize)) halftimeReadPos2 -= static_cast<float>(halftimeBufferSize);
-        }
+    profiler.addTime (profileBlock, blockStart);
+    profiler.advance (numSamples);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::measureLevels (const juce::AudioBuffer<SampleType>& buffer,
+                                                      std::array<float, MeterFrame::maxChannels>& peaks,
+                                                      std::array<float, MeterFrame::maxChannels>& rms)
+{
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), MeterFrame::maxChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        peaks[(size_t) ch] = (float) buffer.getMagnitude (ch, 0, buffer.getNumSamples());
+        rms[(size_t) ch] = (float) buffer.getRMSLevel (ch, 0, buffer.getNumSamples());
     }
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::measureChunkGain (juce::AudioBuffer<SampleType>& buffer)
+{
+    auto& e = getEngine<SampleType>();
+    SampleType gain = 1;
 
-    // 2. Saturation (FIXED: Proper gain staging to prevent clipping)
-    if (satEnableParam && satEnableParam->load() > 0.5f)
+    if (e.truePeakLimiting)
     {
-        float driveDB = satDriveParam->load();
-        float drive = juce::Decibels::decibelsToGain(driveDB);
-        float mix = satMixParam->load() / 100.0f;
-        
-        // Properly allocate dry buffer (using temporary stack buffer for efficiency if small)
-        juce::AudioBuffer<float> dryBuffer;
-        dryBuffer.setSize(buffer.getNumChannels(), buffer.getNumSamples(), false, false, false);
-        dryBuffer.makeCopyOf(buffer, true);
+        gain = e.limiter.getMinimumGain();
+    }
+    else
+    {
+        // The soft limiter is a fixed curve, so its deepest cut is the curve at the peak going in.
+        // A pending blend is never louder than the louder of its dry and wet blocks.
+        auto peak = buffer.getMagnitude (0, buffer.getNumSamples());
 
-        // Apply drive and saturation with proper gain compensation
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        if (e.pendingWetMix != numSmoothedParams)
         {
-            auto* channelData = buffer.getWritePointer(ch);
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-            {
-                // Apply drive, saturate with tanh, then compensate gain
-                float sample = channelData[s] * drive;
-                sample = std::tanh(sample);  // Soft clipping
-                sample /= (std::tanh(drive) + 0.0001f);  // Gain compensation to maintain level
-                channelData[s] = sample;
-            }
-        }
-        
-        // Manual dry/wet blend
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-        {
-            auto* dry = dryBuffer.getReadPointer(ch);
-            auto* wet = buffer.getWritePointer(ch);
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-                wet[s] = (wet[s] * mix) + (dry[s] * (1.0f - mix));
+            const auto range = e.pendingWet.findMinAndMax();
+            peak = juce::jmax (peak, -range.getStart(), range.getEnd());
         }
+
+        const auto input = peak * juce::jmax (e.smoothers.getValue (smoothOutputGain), e.smoothers.getTargetValue (smoothOutputGain));
+
+        if (input > (SampleType) softLimitThreshold)
+            gain = WAVFinDSP::Kernels::softLimit (input, (SampleType) softLimitThreshold) / input;
     }
 
-    // 3. Filter with LFO modulation
-    if (filterEnableParam && filterEnableParam->load() > 0.5f)
+    blockMeter.limiterGain = juce::jmin (blockMeter.limiterGain, (float) gain);
+}
+
+void WAVFinEffectEngineAudioProcessor::publishMeterFrame() noexcept
+{
+    // A refused frame keeps absorbing blocks, so the reader still sees every peak once there is room
+    if (unsentMeter.numSamples > 0)
     {
-        float lfoDepth = filterLfoDepthParam->load() / 100.0f;
-        float lfoRate = filterLfoRateParam->load();
-        
-        if (lfoDepth > 0.01f)
-        {
-            // Apply LFO modulation to filter cutoff (block-rate for efficiency)
-            float baseCutoff = filterCutoffParam->load();
-            float lfoValue = std::sin(filterLfoPhase);
-            float modulatedCutoff = baseCutoff * (1.0f + (lfoValue * lfoDepth));
-            modulatedCutoff = juce::jlimit(20.0f, 20000.0f, modulatedCutoff);
-            filter.setCutoffFrequency(modulatedCutoff);
-            
-            // Update LFO phase
-            float lfoPhaseIncrement = (lfoRate * juce::MathConstants<float>::twoPi * buffer.getNumSamples()) / static_cast<float>(currentSampleRate);
-            filterLfoPhase += lfoPhaseIncrement;
-            if (filterLfoPhase >= juce::MathConstants<float>::twoPi)
-                filterLfoPhase -= juce::MathConstants<float>::twoPi;
-        }
-        
-        filter.process(context);
+        unsentMeter.merge (blockMeter);
+        blockMeter = unsentMeter;
     }
 
-    // 4. Vintage (FIXED: True pitch wow/flutter using delay line)
-    if (vintageEnableParam && vintageEnableParam->load() > 0.5f)
+    unsentMeter = meterQueue.push (blockMeter) ? MeterFrame() : blockMeter;
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processChunk (juce::AudioBuffer<SampleType>& buffer)
+{
+    auto& e = getEngine<SampleType>();
+
+    // Advance every parameter ramp for this chunk
+    e.smoothers.process (buffer.getNumSamples());
+
+    // LFOs start where the transport clock stands before this chunk advances it
+    e.modulation.setRate (lfoFilter, e.smoothers.getValue (smoothFilterLfoRate));
+    e.modulation.setRate (lfoPan, e.smoothers.getValue (smoothPanRate));
+    e.modulation.setTransport (transportClock.getPpqPosition(), transportClock.getBpm(), transportClock.isPlaying());
+    e.modulation.process (buffer.getNumSamples());
+
+    // 0. Capture dry signal for global mix
+    const SampleType masterMix = e.smoothers.getValue (smoothGlobalMix);
+    const SampleType* masterMixRamp = e.smoothers.getRampIfSmoothing (smoothGlobalMix);
+    const bool needsGlobalDry = masterMixRamp != nullptr || masterMix < 1;
+
+    // With latency in the chain the dry delay line must see every block to stay continuous
+    const bool trackGlobalDry = needsGlobalDry || e.globalDryDelay.getDelay() > 0;
+    auto globalDryBlock = trackGlobalDry ? e.scratch.copyOf (globalDrySlot, buffer)
+                                         : juce::dsp::AudioBlock<SampleType>();
+    if (trackGlobalDry)
+        e.globalDryDelay.process (globalDryBlock);
+
+    // Loop starts for the halftime stage. The clock advances even while halftime is disabled.
+    loopStarts = transportClock.advance (buffer.getNumSamples());
+
+    // 1-8. The stages in the current plan, in chain order. Stages whose mix rests at 0 are
+    // skipped (and start clean when it rises), and silent ones sleep (see StageActivity).
+    const auto& plan = chainPlans.read();
+
+    if (plan.numStages > 0)
     {
-        float wowAmount = vintageWowParam->load() / 100.0f;
-        float flutterAmount = vintageFlutterParam->load() / 100.0f;
-        float noiseAmount = vintageNoiseParam->load() / 100.0f;
-        
-        // Characteristic tape speeds
-        float wowFreq = 0.5f;     // 0.5 Hz for slow wow
-        float flutterFreq = 8.0f;  // 8.0 Hz for fast flutter
-        
-        float baseDelayMs = 10.0f; // 10ms base delay
-        float wowRangeMs = 2.0f * wowAmount;
-        float flutterRangeMs = 0.5f * flutterAmount;
-        
-        for (int s = 0; s < buffer.getNumSamples(); ++s)
+        const int numSamples = buffer.getNumSamples();
+        juce::dsp::AudioBlock<SampleType> block (buffer);
+        e.activity.beginChunk (block);
+
+        for (int i = 0; i < plan.numStages; ++i)
         {
-            // Calculate current modulation value
-            float wowMod = std::sin(vintageWowPhase) * wowRangeMs;
-            float flutterMod = std::sin(vintageFlutterPhase) * flutterRangeMs;
-            
-            float totalDelayMs = baseDelayMs + wowMod + flutterMod;
-            float delaySamples = (totalDelayMs / 1000.0f) * static_cast<float>(currentSampleRate);
-            
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            const auto& stage = plan.stages[(size_t) i];
+
+            if (stage.mixGate != numSmoothedParams)
             {
-                auto* channelData = buffer.getWritePointer(ch);
-                float input = channelData[s];
-                
-                // Push to vintage delay line
-                vintageDelay.pushSample(ch, input);
-                
-                // Pop with modulated delay time
-                float modulated = vintageDelay.popSample(ch, delaySamples);
-                
-                // Add subtle tape hiss/noise if enabled
-                if (noiseAmount > 0.01f)
+                const bool muted = e.smoothers.getValue (stage.mixGate) == 0
+                                && e.smoothers.getRampIfSmoothing (stage.mixGate) == nullptr;
+
+                if (muted)
                 {
-                    float noise = (randomGenerator.nextFloat() * 2.0f - 1.0f) * noiseAmount * 0.02f;
-                    modulated += noise;
+                    e.stageMuted[(size_t) stage.id] = true;
+                    continue;
                 }
-                
-                channelData[s] = modulated;
+
+                if (std::exchange (e.stageMuted[(size_t) stage.id], false))
+                    resetStage<SampleType> (stage.id);
+            }
+
+            if (e.activity.shouldProcess (stage.id, numSamples))
+            {
+                // A stage reads the blended output of the one before it
+                const auto stageStart = profiler.now();
+                flushPendingBlend (buffer);
+                runStage (stage.id, buffer, plan);
+                profiler.addTime (stage.id, stageStart);
+
+                if (e.pendingWetMix != numSmoothedParams)
+                    e.activity.stageProcessedBlend (stage.id, e.pendingWet, stageMemory[(size_t) stage.id]);
+                else
+                    e.activity.stageProcessed (stage.id, block, stageMemory[(size_t) stage.id]);
+
+                if (meteringBlock)
+                    blockMeter.stageLevels[(size_t) stage.id] = juce::jmax (blockMeter.stageLevels[(size_t) stage.id],
+                                                                            (float) e.activity.getStagePeak());
             }
-            
-            // Update phases
-            vintageWowPhase += (wowFreq * juce::MathConstants<float>::twoPi) / static_cast<float>(currentSampleRate);
-            vintageFlutterPhase += (flutterFreq * juce::MathConstants<float>::twoPi) / static_cast<float>(currentSampleRate);
-            
-            if (vintageWowPhase >= juce::MathConstants<float>::twoPi) vintageWowPhase -= juce::MathConstants<float>::twoPi;
-            if (vintageFlutterPhase >= juce::MathConstants<float>::twoPi) vintageFlutterPhase -= juce::MathConstants<float>::twoPi;
         }
     }
 
-    // 5. Chorus
-    if (chorusEnableParam && chorusEnableParam->load() > 0.5f)
+    const auto outputStart = profiler.now();
+
+    // The soft limiter's cut is read from its input, so before the pass that applies it
+    if (meteringBlock && ! e.truePeakLimiting)
+        measureChunkGain (buffer);
+
+    // 9-11. One pass per channel: the last stage's dry/wet blend, output gain, safety soft
+    // limiting (transparent below 0.9, tanh knee up to 1.0) and the global dry/wet mix.
+    // The true-peak limiter has to see every channel before it can set the gain, so in
+    // that mode the kernel stops after the output gain and the global mix follows it.
+    WAVFinDSP::Kernels::OutputStage<SampleType> output;
+    output.gain = { e.smoothers.getRampIfSmoothing (smoothOutputGain), e.smoothers.getValue (smoothOutputGain) };
+    output.softLimit = ! e.truePeakLimiting;
+    output.limitThreshold = (SampleType) softLimitThreshold;
+    output.globalMix = { masterMixRamp, masterMix };
+
+    if (e.pendingWetMix != numSmoothedParams)
+        output.stageMix = { e.smoothers.getRampIfSmoothing (e.pendingWetMix), e.smoothers.getValue (e.pendingWetMix) };
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        output.stageWet = e.pendingWetMix != numSmoothedParams ? e.pendingWet.getChannelPointer ((size_t) ch) : nullptr;
+        output.globalDry = needsGlobalDry && output.softLimit ? globalDryBlock.getChannelPointer ((size_t) ch) : nullptr;
+        WAVFinDSP::Kernels::outputStageBlock (buffer.getWritePointer (ch), buffer.getNumSamples(), output);
+    }
+
+    e.pendingWetMix = numSmoothedParams;
+
+    if (e.truePeakLimiting)
+    {
+        e.limiter.process (juce::dsp::AudioBlock<SampleType> (buffer));
+
+        if (meteringBlock)
+            measureChunkGain (buffer);
+
+        if (needsGlobalDry)
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                WAVFinDSP::Kernels::blendBlock (buffer.getWritePointer (ch), globalDryBlock.getChannelPointer ((size_t) ch),
+                                                buffer.getReadPointer (ch), buffer.getNumSamples(), output.globalMix);
+    }
+
+    profiler.addTime (profileOutput, outputStart);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::deferBlend (juce::dsp::AudioBlock<SampleType> wet, SmoothedParam mix)
+{
+    auto& e = getEngine<SampleType>();
+    e.pendingWet = wet;
+    e.pendingWetMix = mix;
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::flushPendingBlend (juce::AudioBuffer<SampleType>& buffer)
+{
+    auto& e = getEngine<SampleType>();
+
+    if (e.pendingWetMix == numSmoothedParams)
+        return;
+
+    const WAVFinDSP::Kernels::BlockValue<SampleType> mix { e.smoothers.getRampIfSmoothing (e.pendingWetMix),
+                                                           e.smoothers.getValue (e.pendingWetMix) };
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* dry = buffer.getWritePointer (ch);
+        WAVFinDSP::Kernels::blendBlock (dry, dry, e.pendingWet.getChannelPointer ((size_t) ch), buffer.getNumSamples(), mix);
+    }
+
+    e.pendingWetMix = numSmoothedParams;
+}
+
+//==============================================================================
+void WAVFinEffectEngineAudioProcessor::parameterChanged (const juce::String&, float)
+{
+    // Called on whichever thread set the parameter, so only flag it here
+    chainPlanDirty.store (true, std::memory_order_release);
+}
+
+void WAVFinEffectEngineAudioProcessor::timerCallback()
+{
+    if (chainPlanDirty.load (std::memory_order_acquire))
+        rebuildChainPlan();
+
+    reportLatency();
+}
+
+void WAVFinEffectEngineAudioProcessor::rebuildChainPlan()
+{
+    const juce::SpinLock::ScopedLockType sl (chainPlanLock);
+
+    // Cleared first, so a change made while building flags the next rebuild
+    chainPlanDirty.store (false, std::memory_order_release);
+    chainPlans.getWriteSlot() = buildChainPlan();
+    chainPlans.publish();
+}
+
+WAVFinEffectEngineAudioProcessor::ChainPlan WAVFinEffectEngineAudioProcessor::buildChainPlan() const
+{
+    auto isEnabled = [] (const std::atomic<float>* param) { return param != nullptr && param->load() > 0.5f; };
+    auto choiceOf = [] (const std::atomic<float>* param) { return param != nullptr ? static_cast<int> (param->load()) : 0; };
+
+    ChainPlan plan;
+
+    auto add = [&plan] (ChainStage id, SmoothedParam mixGate)
+    {
+        plan.stages[(size_t) plan.numStages++] = { id, mixGate };
+    };
+
+    plan.satType = choiceOf (satTypeParam);
+    plan.satStages = choiceOf (satQualityParam);
+    plan.satBypassed = ! isEnabled (satEnableParam);
+    plan.filterType = choiceOf (filterTypeParam);
+    plan.noiseColour = choiceOf (vintageNoiseColorParam);
+    plan.delayInterpolation = choiceOf (delayQualityParam);
+    plan.delayPingPong = isEnabled (delayModeParam);
+
+    if (isEnabled (halftimeEnableParam))
+        add (stageHalftime, smoothHalftimeMix);
+
+    // Disabled saturation still runs while oversampling, to delay the signal by the reported latency.
+    // Its mix is not a gate for the same reason.
+    if (! plan.satBypassed || plan.satStages > 0)
+        add (stageSaturation, numSmoothedParams);
+
+    if (isEnabled (filterEnableParam))
+        add (stageFilter, numSmoothedParams);
+
+    // Always audible: the wow line delays the signal even with wow, flutter and noise at 0
+    if (isEnabled (vintageEnableParam))
+        add (stageVintage, numSmoothedParams);
+
+    if (isEnabled (chorusEnableParam))
+        add (stageChorus, smoothChorusMix);
+
+    if (isEnabled (panEnableParam))
+        add (stagePan, smoothPanDepth);
+
+    if (isEnabled (delayEnableParam))
+        add (stageDelay, smoothDelayMix);
+
+    // The IR runs after the FDN, on the reverb card
+    if (isEnabled (reverbEnableParam))
+    {
+        add (stageReverb, smoothReverbMix);
+        add (stageConvolution, smoothConvMix);
+    }
+
+    return plan;
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::runStage (ChainStage stage, juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan)
+{
+    using StageFunction = void (WAVFinEffectEngineAudioProcessor::*) (juce::AudioBuffer<SampleType>&, const ChainPlan&);
+
+    // Indexed by ChainStage
+    static constexpr StageFunction stageFunctions[] =
+    {
+        &WAVFinEffectEngineAudioProcessor::processHalftime<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processSaturation<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processFilter<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processVintage<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processChorus<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processPan<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processDelay<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processReverb<SampleType>,
+        &WAVFinEffectEngineAudioProcessor::processConvolution<SampleType>
+    };
+
+    static_assert (std::size (stageFunctions) == (size_t) numChainStages);
+    (this->*stageFunctions[stage]) (buffer, plan);
+}
+
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::resetStage (ChainStage stage)
+{
+    auto& e = getEngine<SampleType>();
+
+    // Stages frozen while muted would otherwise resume with stale audio in their lines
+    switch (stage)
+    {
+        case stageHalftime:     e.halftime.reset(); break;
+        case stageChorus:       e.chorus.reset(); break;
+        case stageDelay:        e.delay.reset(); break;
+        case stageReverb:       e.reverb.reset(); break;
+        case stageConvolution:  convolution.reset(); break;
+        default:                break;
+    }
+}
+
+//==============================================================================
+// 1. Halftime (Grid-Synced Dual-Voice): the chunk is split on the exact sample of
+// each loop start, where the voices swap.
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processHalftime (juce::AudioBuffer<SampleType>& buffer, const ChainPlan&)
+{
+    auto& e = getEngine<SampleType>();
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+
+    const SampleType mixValue = e.smoothers.getValue (smoothHalftimeMix);
+    const SampleType* mixRamp = e.smoothers.getRampIfSmoothing (smoothHalftimeMix);
+    double fadeTimeMs = 10.0 + (e.smoothers.getValue (smoothHalftimeFade) * 2.0); // 10ms to 200ms crossfade
+    e.halftime.setFadeTime (fadeTimeMs / 1000.0, currentSampleRate);
+
+    int segmentStart = 0;
+    for (int i = 0; i <= loopStarts.count; ++i)
     {
-        chorus.process (context);
+        const int segmentEnd = i < loopStarts.count ? loopStarts.offsets[(size_t) i] : buffer.getNumSamples();
+
+        if (segmentEnd > segmentStart)
+            e.halftime.process (block.getSubBlock ((size_t) segmentStart, (size_t) (segmentEnd - segmentStart)),
+                                mixValue, mixRamp != nullptr ? mixRamp + segmentStart : nullptr);
+
+        // Swap voices: the new one restarts at the write head, the old one fades out its tail
+        if (i < loopStarts.count)
+            e.halftime.trigger();
+
+        segmentStart = segmentEnd;
     }
+}
 
-    // 6. Autopan
-    if (panEnableParam && panEnableParam->load() > 0.5f)
+// 2. Saturation (oversampled Tube/Tape/Diode/Digital, dry path latency-compensated)
+// When disabled while oversampling the engine still delays the signal, so total latency never
+// changes. At 1x (the default) disabled saturation is left out of the plan.
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processSaturation (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan)
+{
+    auto& e = getEngine<SampleType>();
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+
+    e.saturation.setParameters (static_cast<typename WAVFinDSP::SaturationEngine<SampleType>::Type> (plan.satType),
+                                e.smoothers.getValue (smoothSatDrive),
+                                e.smoothers.getValue (smoothSatMix));
+
+    juce::dsp::ProcessContextReplacing<SampleType> satContext (block);
+    satContext.isBypassed = plan.satBypassed;
+    e.saturation.process (satContext, e.scratch.getBlock (saturationDrySlot, buffer.getNumChannels(), buffer.getNumSamples()),
+                          e.smoothers.getRampIfSmoothing (smoothSatDrive),
+                          e.smoothers.getRampIfSmoothing (smoothSatMix));
+}
+
+// 3. Filter with LFO modulation
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processFilter (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan)
+{
+    auto& e = getEngine<SampleType>();
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    e.filter.setType (static_cast<typename WAVFinDSP::ModulatedSVF<SampleType>::Type> (plan.filterType));
+    
+    const SampleType cutoff = e.smoothers.getValue (smoothFilterCutoff);
+    const SampleType* cutoffRamp = e.smoothers.getRampIfSmoothing (smoothFilterCutoff);
+    const SampleType lfoDepth = e.smoothers.getValue (smoothFilterLfoDepth);
+    const SampleType* depthRamp = e.smoothers.getRampIfSmoothing (smoothFilterLfoDepth);
+    
+    // LFO modulation of the cutoff, applied per sample
+    const SampleType* lfo = (depthRamp != nullptr || lfoDepth > (SampleType) 0.01) ? e.modulation.getStream (lfoFilter) : nullptr;
+    
+    constexpr auto minCutoff = (SampleType) 20, maxCutoff = (SampleType) 20000;
+
+    if (cutoffRamp != nullptr || lfo != nullptr)
     {
-        float rate = panRateParam->load();
-        float depth = panDepthParam->load() / 100.0f;
-        float phaseIncrement = (rate * juce::MathConstants<float>::twoPi) / static_cast<float>(currentSampleRate);
+        auto* cutoffs = e.scratch.getBlock (filterCutoffSlot, 1, buffer.getNumSamples()).getChannelPointer (0);
         
-        if (buffer.getNumChannels() >= 2)
+        for (int s = 0; s < buffer.getNumSamples(); ++s)
         {
-            auto* leftData = buffer.getWritePointer(0);
-            auto* rightData = buffer.getWritePointer(1);
-            
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-            {
-                float panValue = std::sin(panLfoPhase) * depth;
-                float leftGain = 1.0f - ((panValue + 1.0f) * 0.5f * depth);
-                float rightGain = 1.0f + ((panValue - 1.0f) * 0.5f * depth);
-                
-                leftData[s] *= leftGain;
-                rightData[s] *= rightGain;
-                
-                panLfoPhase += phaseIncrement;
-                if (panLfoPhase >= juce::MathConstants<float>::twoPi)
-                    panLfoPhase -= juce::MathConstants<float>::twoPi;
-            }
+            const SampleType base = cutoffRamp != nullptr ? cutoffRamp[s] : cutoff;
+            const SampleType depth = depthRamp != nullptr ? depthRamp[s] : lfoDepth;
+            const SampleType lfoFactor = lfo != nullptr ? 1 + (lfo[s] * depth) : 1;
+            cutoffs[s] = juce::jlimit (minCutoff, maxCutoff, base * lfoFactor);
         }
+        
+        e.filter.process (block, cutoffs, 0,
+                          e.smoothers.getRampIfSmoothing (smoothFilterRes), e.smoothers.getValue (smoothFilterRes));
+    }
+    else
+    {
+        e.filter.process (block, nullptr, juce::jlimit (minCutoff, maxCutoff, cutoff),
+                          e.smoothers.getRampIfSmoothing (smoothFilterRes), e.smoothers.getValue (smoothFilterRes));
     }
+}
 
-    // 7. Delay with feedback (OPTIMIZED: Smoothed delay time)
-    if (delayEnableParam && delayEnableParam->load() > 0.5f)
+// 4. Vintage (FIXED: True pitch wow/flutter using delay line)
+// With noise on its output is never quiet, so it never sleeps.
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processVintage (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan)
+{
+    auto& e = getEngine<SampleType>();
+
+    const SampleType* wowRamp = e.smoothers.getRampIfSmoothing (smoothVintageWow);
+    const SampleType* flutterRamp = e.smoothers.getRampIfSmoothing (smoothVintageFlutter);
+    const SampleType* noiseRamp = e.smoothers.getRampIfSmoothing (smoothVintageNoise);
+    const SampleType noiseLevel = e.smoothers.getValue (smoothVintageNoise);
+    
+    // Slow wow (0.5 Hz) and fast flutter (8 Hz) from the modulation bank
+    const SampleType* wowLfo = e.modulation.getStream (lfoWow);
+    const SampleType* flutterLfo = e.modulation.getStream (lfoFlutter);
+    
+    SampleType baseDelayMs = 10; // 10ms base delay
+    const auto samplesPerMs = static_cast<SampleType> (currentSampleRate / 1000.0);
+    
+    for (int s = 0; s < buffer.getNumSamples(); ++s)
     {
-        float delayTimeMs = delayTimeParam->load();
-        float feedback = delayFeedbackParam->load() / 100.0f;
-        float mix = delayMixParam->load() / 100.0f;
+        SampleType wowAmount = wowRamp != nullptr ? wowRamp[s] : e.smoothers.getValue (smoothVintageWow);
+        SampleType flutterAmount = flutterRamp != nullptr ? flutterRamp[s] : e.smoothers.getValue (smoothVintageFlutter);
+        SampleType wowRangeMs = 2 * wowAmount;
+        SampleType flutterRangeMs = (SampleType) 0.5 * flutterAmount;
+
+        // Calculate current modulation value
+        SampleType wowMod = wowLfo[s] * wowRangeMs;
+        SampleType flutterMod = flutterLfo[s] * flutterRangeMs;
         
-        // Set target delay time (will be smoothed)
-        float targetDelaySamples = (delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
-        smoothedDelayTime.setTargetValue(targetDelaySamples);
+        SampleType totalDelayMs = baseDelayMs + wowMod + flutterMod;
+        SampleType delaySamples = totalDelayMs * samplesPerMs;
         
         for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
         {
             auto* channelData = buffer.getWritePointer(ch);
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-            {
-                // Get smoothed delay time (interpolated per-sample)
-                float currentDelay = smoothedDelayTime.getNextValue();
-                
-                float input = channelData[s];
-                float delayed = delayLine.popSample(ch, currentDelay);
-                
-                // Push input + feedback
-                delayLine.pushSample(ch, input + (delayed * feedback));
-                
-                // Mix dry/wet
-                channelData[s] = (delayed * mix) + (input * (1.0f - mix));
-            }
+            SampleType input = channelData[s];
+            
+            // Push to vintage delay line
+            e.vintageDelay.pushSample(ch, input);
+            
+            // Pop with modulated delay time
+            channelData[s] = e.vintageDelay.popSample(ch, delaySamples);
         }
     }
+    
+    // Add subtle tape hiss/noise if enabled, as one block mix (full scale = 0.02)
+    if (noiseRamp != nullptr || noiseLevel > (SampleType) 0.01)
+    {
+        e.vintageNoise.setColour (static_cast<typename WAVFinDSP::NoiseGenerator<SampleType>::Colour> (plan.noiseColour));
+
+        juce::dsp::AudioBlock<SampleType> block (buffer);
+        e.vintageNoise.addTo (block, (SampleType) 0.02, noiseLevel, noiseRamp);
+    }
+}
+
+// 5. Chorus
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processChorus (juce::AudioBuffer<SampleType>& buffer, const ChainPlan&)
+{
+    auto& e = getEngine<SampleType>();
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    juce::dsp::ProcessContextReplacing<SampleType> context (block);
+
+    // juce::dsp::Chorus smooths depth and mix internally, so the ramp's block-end value is enough
+    e.chorus.setRate (e.smoothers.getValue (smoothChorusRate));
+    e.chorus.setDepth (e.smoothers.getValue (smoothChorusDepth));
+    e.chorus.setMix (e.smoothers.getValue (smoothChorusMix));
+    e.chorus.process (context);
+}
 
-    // 8. Reverb (FIXED: Manual Dry/Wet Mix to prevent volume boost)
-    if (reverbEnableParam && reverbEnableParam->load() > 0.5f)
+// 6. Autopan
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processPan (juce::AudioBuffer<SampleType>& buffer, const ChainPlan&)
+{
+    auto& e = getEngine<SampleType>();
+
+    const SampleType* depthRamp = e.smoothers.getRampIfSmoothing (smoothPanDepth);
+    const SampleType* lfo = e.modulation.getStream (lfoPan);
+    
+    if (buffer.getNumChannels() >= 2)
     {
-        float mix = reverbMixParam->load() / 100.0f;
+        auto* leftData = buffer.getWritePointer(0);
+        auto* rightData = buffer.getWritePointer(1);
         
-        // Create a wet buffer initialized with current signal
-        juce::AudioBuffer<float> wetBuffer;
-        wetBuffer.setSize(buffer.getNumChannels(), buffer.getNumSamples(), false, false, false);
-        wetBuffer.makeCopyOf(buffer, true);
-        
-        // Process wet buffer 100% wet
-        juce::dsp::AudioBlock<float> wetBlock (wetBuffer);
-        juce::dsp::ProcessContextReplacing<float> wetContext (wetBlock);
-        reverb.process (wetContext);
-        
-        // Manual Mix
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int s = 0; s < buffer.getNumSamples(); ++s)
         {
-            auto* dryData = buffer.getWritePointer(ch);
-            auto* wetData = wetBuffer.getReadPointer(ch);
+            SampleType depth = depthRamp != nullptr ? depthRamp[s] : e.smoothers.getValue (smoothPanDepth);
+            SampleType panValue = lfo[s] * depth;
+            SampleType leftGain = 1 - ((panValue + 1) * (SampleType) 0.5 * depth);
+            SampleType rightGain = 1 + ((panValue - 1) * (SampleType) 0.5 * depth);
             
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-            {
-                // Linear interpolation: 0% = Dry, 100% = Wet
-                dryData[s] = (wetData[s] * mix) + (dryData[s] * (1.0f - mix));
-            }
+            leftData[s] *= leftGain;
+            rightData[s] *= rightGain;
         }
     }
+}
+
+// 7. Delay with feedback: stereo frames share one (smoothed) read position
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processDelay (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan)
+{
+    auto& e = getEngine<SampleType>();
 
-    // 9. Output Gain
-    outputGain.process (context);
+    e.delay.setPingPong (plan.delayPingPong);
+    e.delay.setInterpolation (static_cast<typename WAVFinDSP::StereoDelay<SampleType>::Interpolation> (plan.delayInterpolation));
 
-    // 10. Safety Soft Limiting (prevent clipping)
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    e.delay.process (juce::dsp::AudioBlock<SampleType> (buffer),
+                     e.smoothers.getRampIfSmoothing (smoothDelayTime), e.smoothers.getValue (smoothDelayTime),
+                     e.smoothers.getRampIfSmoothing (smoothDelayFeedback), e.smoothers.getValue (smoothDelayFeedback),
+                     e.smoothers.getRampIfSmoothing (smoothDelayMix), e.smoothers.getValue (smoothDelayMix));
+}
+
+// 8. Reverb (FIXED: Manual Dry/Wet Mix to prevent volume boost)
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processReverb (juce::AudioBuffer<SampleType>& buffer, const ChainPlan&)
+{
+    auto& e = getEngine<SampleType>();
+
+    // Only recomputes line lengths and gains when size or decay actually moved
+    e.reverb.setParameters (e.smoothers.getValue (smoothReverbSize), e.smoothers.getValue (smoothReverbDecay));
+    
+    // Wet copy of the current signal, taken from the scratch arena
+    auto wetBlock = e.scratch.copyOf (reverbWetSlot, buffer);
+    
+    // The FDN output is 100% wet; the mix (linear: 0% = Dry, 100% = Wet) is applied once, later
+    e.reverb.process (wetBlock);
+    deferBlend (wetBlock, smoothReverbMix);
+}
+
+// Impulse response after the FDN, with its own mix; skipped while no IR is loaded
+template <typename SampleType>
+void WAVFinEffectEngineAudioProcessor::processConvolution (juce::AudioBuffer<SampleType>& buffer, const ChainPlan&)
+{
+    auto& e = getEngine<SampleType>();
+
+    if constexpr (std::is_same_v<SampleType, float>)
     {
-        auto* channelData = buffer.getWritePointer(ch);
-        for (int s = 0; s < buffer.getNumSamples(); ++s)
+        auto convWetBlock = e.scratch.copyOf (convolutionWetSlot, buffer);
+
+        if (convolution.process (convWetBlock))
+            deferBlend (convWetBlock, smoothConvMix);
+    }
+    else
+    {
+        // The IR engine is float only: convert in, convolve, and convert the wet signal back
+        const auto numChannels = (size_t) buffer.getNumChannels();
+        const auto numSamples = (size_t) buffer.getNumSamples();
+        auto floatBlock = juce::dsp::AudioBlock<float> (e.convolutionBuffer).getSubsetChannelBlock (0, numChannels)
+                                                                            .getSubBlock (0, numSamples);
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
         {
-            float sample = channelData[s];
-            // Soft limit above 0.9 to prevent hard clipping
-            if (std::abs(sample) > 0.9f)
-                sample = std::tanh(sample * 0.7f) / 0.7f;
-            channelData[s] = sample;
+            const auto* source = buffer.getReadPointer ((int) ch);
+            std::transform (source, source + numSamples, floatBlock.getChannelPointer (ch),
+                            [] (SampleType x) { return static_cast<float> (x); });
         }
-    }
 
-    // 11. Global Mix (blend processed signal with original dry signal)
-    if (globalMixParam)
-    {
-        float masterMix = globalMixParam->load() / 100.0f;
-        if (masterMix < 0.99f)
+        if (! convolution.process (floatBlock))
+            return;
+
+        auto convWetBlock = e.scratch.getBlock (convolutionWetSlot, (int) numChannels, (int) numSamples);
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
         {
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                auto* wet = buffer.getWritePointer(ch);
-                auto* dry = globalDryBuffer.getReadPointer(ch);
-                for (int s = 0; s < buffer.getNumSamples(); ++s)
-                    wet[s] = (wet[s] * masterMix) + (dry[s] * (1.0f - masterMix));
-            }
+            const auto* wet = floatBlock.getChannelPointer (ch);
+            std::copy (wet, wet + numSamples, convWetBlock.getChannelPointer (ch));
         }
+
+        deferBlend (convWetBlock, smoothConvMix);
     }
 }
 
 //==============================================================================
 bool WAVFinEffectEngineAudioProcessor::hasEditor() const
 {
-    return true; // (change this to false if you choose to not have an editor)
+    return ! WAVFIN_HEADLESS;
 }
 
 juce::AudioProcessorEditor* WAVFinEffectEngineAudioProcessor::createEditor()
 {
+   #if WAVFIN_HEADLESS
+    return nullptr;
+   #else
     return new WAVFinEffectEngineAudioProcessorEditor (*this);
+   #endif
 }
 
 //==============================================================================
 void WAVFinEffectEngineAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     auto state = apvts.copyState();
+
+    // The IR is stored as a path; the file itself is not embedded in the session
+    state.setProperty (impulseResponseProperty, convolution.getImpulseResponseFile().getFullPathName(), nullptr);
+
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -661,7 +1328,13 @@ void WAVFinEffectEngineAudioProcessor::setStateInformation (const void* data, in
 
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName (apvts.state.getType()))
+        {
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+            const juce::String irPath = apvts.state.getProperty (impulseResponseProperty);
+            if (irPath.isNotEmpty() && juce::File::isAbsolutePath (irPath))
+                convolution.loadImpulseResponse (juce::File (irPath));
+        }
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProcessor::createParameterLayout()
@@ -671,6 +1344,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     auto globalGroup = std::make_unique<juce::AudioProcessorParameterGroup>("global", "Global", "|");
     globalGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::global_mix, "Mix", 0.0f, 100.0f, 100.0f));
     globalGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::output_gain, "Output", -24.0f, 24.0f, 0.0f));
+    globalGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::limiter_mode, "Limiter", juce::StringArray { "Clip", "True Peak" }, 0,
+                                                                       juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+    globalGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::limiter_lookahead, "Lookahead", juce::StringArray { "1 ms", "2 ms", "5 ms", "10 ms" }, 2,
+                                                                       juce::AudioParameterChoiceAttributes().withAutomatable (false)));
     layout.add(std::move(globalGroup));
 
     auto reverbGroup = std::make_unique<juce::AudioProcessorParameterGroup>("reverb", "Reverb", "|");
@@ -678,6 +1355,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     reverbGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::reverb_size, "Size", 0.0f, 100.0f, 50.0f));
     reverbGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::reverb_decay, "Decay", 0.1f, 10.0f, 2.0f));
     reverbGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::reverb_mix, "Mix", 0.0f, 100.0f, 30.0f));
+    reverbGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::conv_mix, "IR Mix", 0.0f, 100.0f, 0.0f));
     layout.add(std::move(reverbGroup));
 
     auto delayGroup = std::make_unique<juce::AudioProcessorParameterGroup>("delay", "Delay", "|");
@@ -685,6 +1363,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     delayGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::delay_time, "Time", 0.0f, 2000.0f, 500.0f));
     delayGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::delay_feedback, "Feedback", 0.0f, 100.0f, 40.0f));
     delayGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::delay_mix, "Mix", 0.0f, 100.0f, 30.0f));
+    delayGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::delay_sync, "Sync", juce::StringArray { "Free", "1/16", "1/8T", "1/8", "1/8.", "1/4T", "1/4", "1/4.", "1/2", "1/1" }, 0));
+    delayGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::delay_mode, "Mode", juce::StringArray { "Stereo", "Ping-Pong" }, 0));
+    delayGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::delay_quality, "Interpolation", juce::StringArray { "Linear", "Hermite" }, 0));
     layout.add(std::move(delayGroup));
 
     auto chorusGroup = std::make_unique<juce::AudioProcessorParameterGroup>("chorus", "Chorus", "|");
@@ -698,20 +1379,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     filterGroup->addChild(std::make_unique<juce::AudioParameterBool>(ParameterIDs::filter_enable, "Enable", false));
     filterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::filter_cutoff, "Cutoff", juce::NormalisableRange<float>(20.0f, 20000.0f, 0.0f, 0.3f), 2000.0f));
     filterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::filter_res, "Resonance", 0.0f, 1.0f, 0.1f));
+    filterGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::filter_type, "Type", juce::StringArray { "Low Pass", "High Pass", "Band Pass", "Notch" }, 0));
     filterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::filter_lfo_rate, "LFO Rate", 0.0f, 20.0f, 2.0f));
     filterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::filter_lfo_depth, "LFO Depth", 0.0f, 100.0f, 0.0f));
+    filterGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::filter_lfo_shape, "LFO Shape", juce::StringArray { "Sine", "Triangle", "Random" }, 0));
+    filterGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::filter_lfo_sync, "LFO Sync", juce::StringArray { "Free", "Sync" }, 0));
     layout.add(std::move(filterGroup));
 
     auto panGroup = std::make_unique<juce::AudioProcessorParameterGroup>("pan", "Autopan", "|");
     panGroup->addChild(std::make_unique<juce::AudioParameterBool>(ParameterIDs::pan_enable, "Enable", false));
     panGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::pan_rate, "Rate", 0.0f, 20.0f, 1.0f));
     panGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::pan_depth, "Depth", 0.0f, 100.0f, 100.0f));
+    panGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::pan_shape, "Shape", juce::StringArray { "Sine", "Triangle", "Random" }, 0));
+    panGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::pan_sync, "Sync", juce::StringArray { "Free", "Sync" }, 0));
     layout.add(std::move(panGroup));
 
     auto halftimeGroup = std::make_unique<juce::AudioProcessorParameterGroup>("halftime", "Halftime", "|");
     halftimeGroup->addChild(std::make_unique<juce::AudioParameterBool>(ParameterIDs::halftime_enable, "Enable", false));
     halftimeGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::halftime_mix, "Mix", 0.0f, 100.0f, 100.0f));
     halftimeGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::halftime_fade, "Smooth", 0.0f, 100.0f, 10.0f));
+    halftimeGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::halftime_length, "Length", juce::StringArray { "1/2 Bar", "1 Bar", "2 Bars" }, 1));
     layout.add(std::move(halftimeGroup));
 
     auto vintageGroup = std::make_unique<juce::AudioProcessorParameterGroup>("vintage", "Vintage", "|");
@@ -719,6 +1406,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     vintageGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::vintage_wow, "Wow", 0.0f, 100.0f, 20.0f));
     vintageGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::vintage_flutter, "Flutter", 0.0f, 100.0f, 20.0f));
     vintageGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::vintage_noise, "Noise", 0.0f, 100.0f, 0.0f));
+    vintageGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::vintage_noise_color, "Noise Color", juce::StringArray { "White", "Pink", "Hiss" }, 0));
     layout.add(std::move(vintageGroup));
 
     auto saturationGroup = std::make_unique<juce::AudioProcessorParameterGroup>("saturation", "Saturation", "|");
@@ -726,6 +1414,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout WAVFinEffectEngineAudioProce
     saturationGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::sat_drive, "Drive", 0.0f, 48.0f, 0.0f));
     saturationGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::sat_type, "Type", juce::StringArray { "Tube", "Tape", "Diode", "Digital" }, 0));
     saturationGroup->addChild(std::make_unique<juce::AudioParameterFloat>(ParameterIDs::sat_mix, "Mix", 0.0f, 100.0f, 100.0f));
+    saturationGroup->addChild(std::make_unique<juce::AudioParameterChoice>(ParameterIDs::sat_quality, "Oversampling", juce::StringArray { "1x", "2x", "4x", "8x" }, 0,
+                                                                           juce::AudioParameterChoiceAttributes().withAutomatable (false)));
     layout.add(std::move(saturationGroup));
 
     return layout;
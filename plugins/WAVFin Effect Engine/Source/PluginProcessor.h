@@ -4,9 +4,36 @@
 #include <juce_gui_extra/juce_gui_extra.h>
 #include <juce_dsp/juce_dsp.h>
 #include "ParameterIDs.h"
+#include "DSP/ScratchArena.h"
+#include "DSP/SaturationEngine.h"
+#include "DSP/HalftimeEngine.h"
+#include "DSP/TransportClock.h"
+#include "DSP/LatencyDelay.h"
+#include "DSP/TruePeakLimiter.h"
+#include "DSP/ParameterSmootherBank.h"
+#include "DSP/ModulationBank.h"
+#include "DSP/NoiseGenerator.h"
+#include "DSP/ModulatedSVF.h"
+#include "DSP/StereoDelay.h"
+#include "DSP/FDNReverb.h"
+#include "DSP/ConvolutionStage.h"
+#include "DSP/StageActivity.h"
+#include "DSP/TripleBuffer.h"
+#include "DSP/StageProfiler.h"
+#include "DSP/SpscQueue.h"
+#include "DSP/MeterFrame.h"
+#include "DSP/SpectrumAnalyzer.h"
+
+/** Set to 1 by targets that run the processor without a window (see Tools/Render):
+    hasEditor() returns false and the WebView editor is not compiled in. */
+#ifndef WAVFIN_HEADLESS
+ #define WAVFIN_HEADLESS 0
+#endif
 
 //==============================================================================
-class WAVFinEffectEngineAudioProcessor  : public juce::AudioProcessor
+class WAVFinEffectEngineAudioProcessor  : public juce::AudioProcessor,
+                                           private juce::AudioProcessorValueTreeState::Listener,
+                                           private juce::Timer
 {
 public:
     //==============================================================================
@@ -22,6 +49,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** The chain runs natively at either precision; float is the default. */
+    bool supportsDoublePrecisionProcessing() const override     { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -48,52 +79,235 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
+    /** Impulse responses load in the background; the editor listens for completed loads. */
+    WAVFinDSP::ConvolutionStage& getConvolution() noexcept   { return convolution; }
+
+    /** Spectrum of the chain's input and output. It analyses only while a reader (the editor's
+        spectrum view) is attached. */
+    WAVFinDSP::SpectrumAnalyzer& getSpectrumAnalyzer() noexcept  { return spectrum; }
+
+    /** Stage-samples skipped because a stage was asleep on silence (see StageActivity). */
+    juce::uint64 getNumSamplesSkipped() const noexcept
+    {
+        return floatEngine.activity.getNumSamplesSkipped() + doubleEngine.activity.getNumSamplesSkipped();
+    }
+
+   #if WAVFIN_ENABLE_STAGE_PROFILING
+    /** Timings of each chain stage, the output pass and the whole block over the last
+        profiling window, keyed by section name (see StageProfiler). Read from one thread
+        only: the message thread, or whichever thread drives a headless processor. */
+    juce::var getStageTimings();
+   #endif
+
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // --- DSP Modules ---
-    juce::dsp::StateVariableTPTFilter<float> filter;
-    juce::dsp::WaveShaper<float> saturator;
-    juce::dsp::Chorus<float> chorus;
-    juce::dsp::Reverb reverb;
-    juce::dsp::Gain<float> outputGain;
-    
-    // Delay handling
-    juce::dsp::DelayLine<float> delayLine { 192000 }; // Max 1s at 192kHz
-    juce::SmoothedValue<float> smoothedDelayTime;
-    
-    // Vintage Delay for Wow/Flutter
-    juce::dsp::DelayLine<float> vintageDelay { 4800 }; // Short delay for mod (approx 25ms at 192kHz)
-
-    // LFO/Modulation state
-    float filterLfoPhase = 0.0f;
-    float panLfoPhase = 0.0f;
-    double vintageWowPhase = 0.0;
-    double vintageFlutterPhase = 0.0;
-    
-    // Halftime State
-    double lastBarPosition = 0.0;
-    int activeHalftimeVoice = 0; // 0 = Voice 1, 1 = Voice 2
-    float halftimeCrossfade = 0.0f; // 0.0 = Voice 1 fully active, 1.0 = Voice 2 fully active
-    
-    // Halftime DSP
-    juce::AudioBuffer<float> halftimeBuffer;
-    int halftimeWritePos = 0;
-    float halftimeReadPos1 = 0.0f;
-    float halftimeReadPos2 = 0.0f;
-    bool halftimeBufferFilled = false;
-    
-    // Global mix dry buffer
-    juce::AudioBuffer<float> globalDryBuffer;
+    // Scratch buffers reserved in prepareToPlay so processBlock never allocates
+    enum ScratchSlot
+    {
+        globalDrySlot = 0,
+        saturationDrySlot,
+        reverbWetSlot,
+        convolutionWetSlot,
+        filterCutoffSlot,       // per-sample cutoff (one channel)
+        numScratchSlots
+    };
+
+    // Every continuous parameter, ramped per sample while it moves (values in DSP units)
+    enum SmoothedParam
+    {
+        smoothGlobalMix = 0,
+        smoothOutputGain,       // linear gain
+        smoothReverbSize,
+        smoothReverbDecay,
+        smoothReverbMix,
+        smoothConvMix,
+        smoothDelayTime,        // samples
+        smoothDelayFeedback,
+        smoothDelayMix,
+        smoothChorusRate,
+        smoothChorusDepth,
+        smoothChorusMix,
+        smoothFilterCutoff,
+        smoothFilterRes,
+        smoothFilterLfoRate,
+        smoothFilterLfoDepth,
+        smoothPanRate,
+        smoothPanDepth,
+        smoothHalftimeMix,
+        smoothHalftimeFade,
+        smoothVintageWow,
+        smoothVintageFlutter,
+        smoothVintageNoise,
+        smoothSatDrive,         // dB
+        smoothSatMix,
+        numSmoothedParams
+    };
+
+    // Stages of the serial chain, each put to sleep separately once it goes quiet
+    enum ChainStage
+    {
+        stageHalftime = 0,
+        stageSaturation,
+        stageFilter,
+        stageVintage,
+        stageChorus,
+        stagePan,
+        stageDelay,
+        stageReverb,
+        stageConvolution,
+        numChainStages
+    };
+
+    // Sections the profiler times: the chain stages by ChainStage, then these
+    enum ProfileSection
+    {
+        profileOutput = numChainStages,     // last stage's blend, gain, limiter and global mix
+        profileBlock,                       // all of processBlock
+        numProfileSections
+    };
+
+    WAVFinDSP::StageProfiler<numProfileSections> profiler;
+
+public:
+    //==============================================================================
+    /** Levels of one host block; stageLevels is indexed by chain position (halftime first). */
+    using MeterFrame = WAVFinDSP::MeterFrame<numChainStages>;
+
+    /** The audio thread measures and queues a MeterFrame per block only while a reader is
+        attached, so a closed editor costs nothing. Message thread. */
+    void attachMeterReader() noexcept       { numMeterReaders.fetch_add (1, std::memory_order_relaxed); }
+    void detachMeterReader() noexcept       { numMeterReaders.fetch_sub (1, std::memory_order_relaxed); }
+
+    /** Takes the oldest queued frame. One reading thread at a time (the editor's). */
+    bool popMeterFrame (MeterFrame& frame) noexcept     { return meterQueue.pop (frame); }
+
+private:
+    WAVFinDSP::SpscQueue<MeterFrame> meterQueue;
+    std::atomic<int> numMeterReaders { 0 };
+
+    // Audio thread: the block being measured, and a frame the full queue refused, which
+    // absorbs the following blocks until there is room again
+    MeterFrame blockMeter, unsentMeter;
+    bool meteringBlock = false;
+
+    // The stages to run and their choice settings, resolved from the parameters off the
+    // audio thread whenever an enable or choice changes. The audio thread only iterates it.
+    struct ChainPlan
+    {
+        struct Stage
+        {
+            ChainStage id = numChainStages;
+            SmoothedParam mixGate = numSmoothedParams;  // skipped while this rests at 0 (numSmoothedParams: never)
+        };
+
+        std::array<Stage, numChainStages> stages {};
+        int numStages = 0;
+
+        int satType = 0, satStages = 0, filterType = 0, noiseColour = 0, delayInterpolation = 0;
+        bool satBypassed = true, delayPingPong = false;
+    };
+
+    WAVFinDSP::TripleBuffer<ChainPlan> chainPlans;
+    juce::SpinLock chainPlanLock;                       // one builder at a time: timer, prepareToPlay, offline render
+    std::atomic<bool> chainPlanDirty { true };
+    WAVFinDSP::TransportClock::Boundaries loopStarts;   // this chunk's loop starts, for the halftime stage
+
+    // How long each stage can keep sounding after its input stops, in samples (audio thread only)
+    std::array<juce::int64, numChainStages> stageMemory {};
+
+    // Tail of the enabled stages, recomputed every block for getTailLengthSeconds()
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    // Latency of the current settings. The audio thread only stores it; reportLatency() hands it to the host
+    std::atomic<int> latencyToReport { 0 };
+
+    // Every LFO in the chain, rendered once per chunk into its own buffer
+    enum LfoStream
+    {
+        lfoFilter = 0,
+        lfoPan,
+        lfoWow,
+        lfoFlutter,
+        numLfoStreams
+    };
+
+    // Everything that holds audio or runs at the sample type. The host picks the precision
+    // before prepareToPlay, and only that engine is prepared; the other keeps no scratch
+    // space, so a block at the wrong precision passes through.
+    template <typename SampleType>
+    struct Engine
+    {
+        WAVFinDSP::ScratchArena<SampleType> scratch;
+
+        // Ramps for the SmoothedParam values
+        WAVFinDSP::ParameterSmootherBank<SampleType> smoothers;
+
+        WAVFinDSP::StageActivity<SampleType> activity;
+        std::array<bool, numChainStages> stageMuted {};     // mix gate was closed on the last chunk
+
+        // Wet output of a stage whose dry/wet blend is left to whatever comes next: the next
+        // stage blends it first, or the output kernel does it in the same pass as the gain,
+        // limiter and global mix
+        juce::dsp::AudioBlock<SampleType> pendingWet;
+        SmoothedParam pendingWetMix = numSmoothedParams;
+
+        // --- DSP Modules ---
+        WAVFinDSP::ModulatedSVF<SampleType> filter;
+        WAVFinDSP::SaturationEngine<SampleType> saturation;
+        juce::dsp::Chorus<SampleType> chorus;
+        WAVFinDSP::FDNReverb<SampleType> reverb;
+
+        // Delay handling: buffer sized for the full 2 s range at the current sample rate
+        WAVFinDSP::StereoDelay<SampleType> delay;
+
+        // Vintage Delay for Wow/Flutter
+        juce::dsp::DelayLine<SampleType> vintageDelay { 4800 }; // Short delay for mod (approx 25ms at 192kHz)
+
+        // Vintage tape noise, one deterministic stream per channel
+        WAVFinDSP::NoiseGenerator<SampleType> vintageNoise;
+
+        WAVFinDSP::ModulationBank<SampleType> modulation;
+
+        // Halftime: loops restart on the exact sample of each bar line from the transport clock
+        WAVFinDSP::HalftimeEngine<SampleType> halftime;
+
+        // Replaces the safety clipper when limiter_mode is True Peak; adds its lookahead to the latency
+        WAVFinDSP::TruePeakLimiter<SampleType> limiter;
+        bool truePeakLimiting = false;
+
+        // Keeps the global dry signal aligned with the oversampler and limiter latency
+        WAVFinDSP::LatencyDelay<SampleType> globalDryDelay;
+
+        // The IR engine is float only; at double precision its input and output pass through here
+        juce::AudioBuffer<float> convolutionBuffer;
+    };
+
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
+
+    template <typename SampleType>
+    Engine<SampleType>& getEngine() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEngine;
+        else
+            return floatEngine;
+    }
+
+    // Shared by both precisions
+    WAVFinDSP::ConvolutionStage convolution;
+    WAVFinDSP::TransportClock transportClock;
+    WAVFinDSP::SpectrumAnalyzer spectrum;
+
     double currentSampleRate = 44100.0;
-    int lastBufferSize = 0;
-    
-    // Thread-safe random number generator for vintage noise
-    juce::Random randomGenerator;
+    int maxBlockSize = 0;
 
     // Parameter References (for performance)
     std::atomic<float>* globalMixParam = nullptr;
     std::atomic<float>* outputGainParam = nullptr;
+    std::atomic<float>* limiterModeParam = nullptr;
+    std::atomic<float>* limiterLookaheadParam = nullptr;
     
     // Module Enables
     std::atomic<float>* reverbEnableParam = nullptr;
@@ -108,12 +322,16 @@ private:
     // Module Params
     std::atomic<float>* filterCutoffParam = nullptr;
     std::atomic<float>* filterResParam = nullptr;
+    std::atomic<float>* filterTypeParam = nullptr;
     std::atomic<float>* filterLfoRateParam = nullptr;
     std::atomic<float>* filterLfoDepthParam = nullptr;
+    std::atomic<float>* filterLfoShapeParam = nullptr;
+    std::atomic<float>* filterLfoSyncParam = nullptr;
     
     std::atomic<float>* satDriveParam = nullptr;
     std::atomic<float>* satTypeParam = nullptr;
     std::atomic<float>* satMixParam = nullptr;
+    std::atomic<float>* satQualityParam = nullptr;
     
     std::atomic<float>* chorusRateParam = nullptr;
     std::atomic<float>* chorusDepthParam = nullptr;
@@ -122,22 +340,66 @@ private:
     std::atomic<float>* reverbSizeParam = nullptr;
     std::atomic<float>* reverbDecayParam = nullptr;
     std::atomic<float>* reverbMixParam = nullptr;
+    std::atomic<float>* convMixParam = nullptr;
 
     std::atomic<float>* delayTimeParam = nullptr;
     std::atomic<float>* delayFeedbackParam = nullptr;
     std::atomic<float>* delayMixParam = nullptr;
+    std::atomic<float>* delaySyncParam = nullptr;
+    std::atomic<float>* delayModeParam = nullptr;
+    std::atomic<float>* delayQualityParam = nullptr;
     
     std::atomic<float>* panRateParam = nullptr;
     std::atomic<float>* panDepthParam = nullptr;
+    std::atomic<float>* panShapeParam = nullptr;
+    std::atomic<float>* panSyncParam = nullptr;
     
     std::atomic<float>* halftimeMixParam = nullptr;
     std::atomic<float>* halftimeFadeParam = nullptr;
+    std::atomic<float>* halftimeLengthParam = nullptr;
     
     std::atomic<float>* vintageWowParam = nullptr;
     std::atomic<float>* vintageFlutterParam = nullptr;
     std::atomic<float>* vintageNoiseParam = nullptr;
+    std::atomic<float>* vintageNoiseColorParam = nullptr;
     
-    void updateParameters();
+    double getDelayTimeSamples() const;
+
+    template <typename SampleType> void prepareEngine (const juce::dsp::ProcessSpec& spec);
+    template <typename SampleType> void processSamples (juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> void updateParameters();
+    template <typename SampleType> void updateSmoothedTargets (bool jumpToTargets);
+    template <typename SampleType> void updateLatency();
+    template <typename SampleType> void updateModulation();
+    template <typename SampleType> void updateTailLength();
+    template <typename SampleType> void prepareHalftime();
+    template <typename SampleType> void processChunk (juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> void measureChunkGain (juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> static void measureLevels (const juce::AudioBuffer<SampleType>& buffer,
+                                                              std::array<float, MeterFrame::maxChannels>& peaks,
+                                                              std::array<float, MeterFrame::maxChannels>& rms);
+    void publishMeterFrame() noexcept;
+
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void timerCallback() override;
+    ChainPlan buildChainPlan() const;
+    void rebuildChainPlan();
+    void reportLatency();
+    template <typename SampleType> void runStage (ChainStage stage, juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void resetStage (ChainStage stage);
+    template <typename SampleType> void deferBlend (juce::dsp::AudioBlock<SampleType> wet, SmoothedParam mix);
+    template <typename SampleType> void flushPendingBlend (juce::AudioBuffer<SampleType>& buffer);
+
+    // One per ChainStage, called through runStage()
+    template <typename SampleType> void processHalftime (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processSaturation (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processFilter (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processVintage (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processChorus (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processPan (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processDelay (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processReverb (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
+    template <typename SampleType> void processConvolution (juce::AudioBuffer<SampleType>& buffer, const ChainPlan& plan);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WAVFinEffectEngineAudioProcessor)
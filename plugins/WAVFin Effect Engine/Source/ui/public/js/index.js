@@ -25,16 +25,33 @@ document.addEventListener("DOMContentLoaded", async () => {
         console.error("Failed to initialize selectors:", e);
     }
 
-    // Fetch parameter values from C++ (bypasses event visibility issues on window reopen)
     try {
-        if (typeof Juce !== 'undefined' && Juce !== null &&
-            window.__JUCE__?.initialisationData?.__juce__functions?.includes?.("getAllParameterValues")) {
-            const getParams = Juce.getNativeFunction("getAllParameterValues");
-            const values = await getParams();
-            if (values && typeof values === 'object') {
-                applyParameterValues(values);
-            }
-        }
+        initializeImpulseResponse();
+    } catch (e) {
+        console.error("Failed to initialize impulse response selector:", e);
+    }
+
+    try {
+        initializeMeters();
+    } catch (e) {
+        console.error("Failed to initialize meters:", e);
+    }
+
+    try {
+        initializeSpectrum();
+    } catch (e) {
+        console.error("Failed to initialize spectrum:", e);
+    }
+
+    try {
+        initializeStageTimings();
+    } catch (e) {
+        console.error("Failed to initialize stage timings:", e);
+    }
+
+    // Ready handshake: every control is listening now, so take the one full snapshot
+    try {
+        await initializeParameterSync();
     } catch (e) {
         console.warn("Could not fetch initial parameter values:", e);
     }
@@ -46,40 +63,126 @@ document.addEventListener("DOMContentLoaded", async () => {
     }
 });
 
-/** Apply parameter values from C++ backend (normalised 0-1). Bypasses event system. */
-function applyParameterValues(values) {
-    const sliderParams = [
-        "global_mix", "output_gain", "reverb_size", "reverb_decay", "reverb_mix",
-        "delay_time", "delay_feedback", "delay_mix", "chorus_rate", "chorus_depth", "chorus_mix",
-        "filter_cutoff", "filter_res", "filter_lfo_rate", "filter_lfo_depth",
-        "pan_rate", "pan_depth", "halftime_mix", "halftime_fade",
-        "vintage_wow", "vintage_flutter", "vintage_noise", "sat_drive", "sat_mix"
-    ];
-    const toggleParams = [
-        "reverb_enable", "delay_enable", "chorus_enable", "filter_enable", "pan_enable",
-        "halftime_enable", "vintage_enable", "sat_enable"
-    ];
-    for (const id of sliderParams) {
-        const v = values[id];
-        if (typeof v === 'number') {
-            const s = Juce.getSliderState(id);
-            if (s) s.setNormalisedValue(v);
-        }
-    }
-    for (const id of toggleParams) {
-        const v = values[id];
-        if (typeof v === 'number') {
-            const t = Juce.getToggleState(id);
-            if (t) t.setValue(v > 0.5);
+/**
+ * Versioned parameter sync. The page remembers the version of the last values it applied
+ * and asks syncParameters for everything changed since (0: every parameter). After that the
+ * editor sends at most one "parameters" event per display frame, and none while it is
+ * hidden: { since, version, values } holds every value changed after version since. The page
+ * applies it if it has applied since already; otherwise an event was missed and it pulls
+ * instead. One request is in flight at a time.
+ */
+function initializeParameterSync() {
+    if (!window.__JUCE__?.initialisationData?.__juce__functions?.includes?.("syncParameters")) return;
+
+    const syncParameters = Juce.getNativeFunction("syncParameters");
+    let appliedVersion = 0, latestVersion = 0, request = null;
+
+    const sync = () => {
+        if (request) return request;
+
+        request = (async () => {
+            do {
+                const changes = await syncParameters(appliedVersion);
+                if (!changes || typeof changes.version !== 'number' || changes.version <= appliedVersion) break;
+
+                applyParameterValues(changes.values || {});
+                appliedVersion = changes.version;
+            } while (latestVersion > appliedVersion);   // sent while this request was out
+        })().finally(() => { request = null; });
+
+        return request;
+    };
+
+    window.__JUCE__?.backend?.addEventListener?.("parameters", (changes) => {
+        if (!changes || typeof changes.version !== 'number' || changes.version <= appliedVersion) return;
+
+        if (!request && changes.since <= appliedVersion) {
+            applyParameterValues(changes.values || {});
+            appliedVersion = changes.version;
+            return;
         }
+
+        latestVersion = Math.max(latestVersion, changes.version);
+        sync().catch((e) => console.warn("Parameter sync failed:", e));
+    });
+
+    return sync();
+}
+
+/**
+ * Parameter values on the page, in each parameter's own units (dB, Hz, choice index, 0 or 1).
+ * Controls listen per parameter; values from the backend reach them here and are not sent back.
+ */
+const parameterValues = new Map();
+const parameterListeners = new Map();
+
+function addParameterListener(id, listener) {
+    if (!parameterListeners.has(id)) parameterListeners.set(id, []);
+    parameterListeners.get(id).push(listener);
+}
+
+/** Apply parameter values from the C++ backend. */
+function applyParameterValues(values) {
+    for (const [id, value] of Object.entries(values)) {
+        if (typeof value !== 'number') continue;
+
+        parameterValues.set(id, value);
+        for (const listener of parameterListeners.get(id) || []) listener(value);
     }
-    const satType = values["sat_type"];
-    if (typeof satType === 'number') {
-        const c = Juce.getComboBoxState("sat_type");
-        if (c) c.setChoiceIndex(Math.round(satType * 3));
+    if (typeof values.impulse_response === 'string') {
+        showImpulseResponse(values.impulse_response);
     }
 }
 
+/**
+ * Outgoing queue. Changes made on the page wait for the next animation frame and go as one
+ * "parameterChanges" event, { begin: [id], values: { id: value }, end: [id] }, so a knob
+ * dragged across many mouse events sends its latest value once per frame. Animation frames
+ * do not run while the page is hidden, so nothing is sent then. A gesture's end goes at
+ * once, after its last value.
+ */
+const pendingChanges = { begin: new Set(), values: new Map(), end: new Set() };
+let flushRequested = false;
+
+function flushParameterChanges() {
+    flushRequested = false;
+
+    const { begin, values, end } = pendingChanges;
+    if (begin.size === 0 && values.size === 0 && end.size === 0) return;
+
+    window.__JUCE__?.backend?.emitEvent?.("parameterChanges", {
+        begin: [...begin],
+        values: Object.fromEntries(values),
+        end: [...end]
+    });
+    begin.clear();
+    values.clear();
+    end.clear();
+}
+
+function requestParameterFlush() {
+    if (flushRequested) return;
+
+    flushRequested = true;
+    requestAnimationFrame(flushParameterChanges);
+}
+
+function setParameterValue(id, value) {
+    parameterValues.set(id, value);
+    pendingChanges.values.set(id, value);
+    requestParameterFlush();
+}
+
+function beginParameterGesture(id) {
+    pendingChanges.begin.add(id);
+    requestParameterFlush();
+}
+
+function endParameterGesture(id) {
+    pendingChanges.end.add(id);
+    flushParameterChanges();
+}
+
 /**
  * Utility class for "Interaction Locking".
  * Enforces a hard visual lock for a set duration after user interaction.
@@ -143,7 +246,6 @@ function initializeKnobs() {
         `;
 
         const paramId = knob.dataset.param;
-        const juceState = Juce.getSliderState(paramId);
 
         const state = {
             isDragging: false,
@@ -200,27 +302,22 @@ function initializeKnobs() {
             }
         };
 
-        // --- JUCE Listener ---
-        if (juceState) {
-            juceState.valueChangedEvent.addListener(() => {
-                // If dragging, we prioritize local interaction
-                if (state.isDragging) return;
+        // --- Backend Listener ---
+        addParameterListener(paramId, (value) => {
+            // If dragging, we prioritize local interaction
+            if (state.isDragging) return;
 
-                state.value = juceState.getScaledValue();
-                updateVisuals();
-            });
-            state.value = juceState.getScaledValue();
+            state.value = value;
             updateVisuals();
-        } else {
-            updateVisuals();
-        }
+        });
+        updateVisuals();
 
         // --- Interaction Logic ---
         knob.addEventListener('mousedown', (e) => {
             state.isDragging = true;
             state.startY = e.clientY;
             state.startValue = state.value;
-            if (juceState && juceState.sliderDragStarted) juceState.sliderDragStarted();
+            beginParameterGesture(paramId);
             document.body.style.cursor = 'ns-resize';
             e.preventDefault();
         });
@@ -249,19 +346,13 @@ function initializeKnobs() {
 
             state.value = newValue;
             updateVisuals();
-
-            if (juceState) {
-                window.__JUCE__.backend.emitEvent(juceState.identifier, {
-                    eventType: "valueChanged",
-                    value: newValue
-                });
-            }
+            setParameterValue(paramId, newValue);
         });
 
         window.addEventListener('mouseup', () => {
             if (!state.isDragging) return;
             state.isDragging = false;
-            if (juceState && juceState.sliderDragEnded) juceState.sliderDragEnded();
+            endParameterGesture(paramId);
             document.body.style.cursor = 'default';
         });
     });
@@ -275,7 +366,6 @@ function initializeToggles() {
 
     toggles.forEach(toggle => {
         const paramId = toggle.dataset.param;
-        const juceState = Juce.getToggleState(paramId);
 
         // Visual update logic
         const updateDom = (isActive) => {
@@ -293,14 +383,8 @@ function initializeToggles() {
         // Create Sync Manager
         const lock = new InteractionLock(updateDom, 500);
 
-        // JUCE Listener
-        if (juceState) {
-            juceState.valueChangedEvent.addListener((newValue) => {
-                lock.onBackendUpdate(!!newValue);
-            });
-            // Initial sync (bypass optimistic logic)
-            updateDom(juceState.getValue());
-        }
+        // Backend Listener
+        addParameterListener(paramId, (value) => lock.onBackendUpdate(value > 0.5));
 
         // Interaction
         toggle.addEventListener('click', function (e) {
@@ -316,64 +400,292 @@ function initializeToggles() {
             lock.onUserAction(newState);
 
             // Notify JUCE
-            if (juceState) {
-                juceState.setValue(newState);
-            }
+            setParameterValue(paramId, newState ? 1 : 0);
         });
     });
 }
 
 /**
- * Initialize selector (Sat Type)
+ * Initialize selectors (Limiter Mode/Lookahead, Halftime Length, Sat Type, Oversampling, Filter Type, LFO Shape/Sync, Noise Color, Delay Sync/Mode/Quality).
+ * Each .selector[data-param] cycles through its data-choices on click.
  */
 function initializeSelectors() {
-    const satDisplay = document.getElementById('sat_type_display');
-    if (!satDisplay) return;
+    const selectors = document.querySelectorAll('.selector[data-param]');
 
-    // Use WebComboBoxRelay for choice parameters
-    const paramId = "sat_type";
-    const juceState = Juce.getComboBoxState(paramId);
+    selectors.forEach(display => {
+        const paramId = display.dataset.param;
+        const choices = (display.dataset.choices || '').split(',');
 
-    const satTypes = ['TUBE', 'TAPE', 'DIODE', 'DIGI'];
+        // Visual Update
+        const updateDom = (index) => {
+            if (index >= 0 && index < choices.length) {
+                display.textContent = choices[index];
+            }
+        };
 
-    // Visual Update
-    const updateDom = (index) => {
-        if (index >= 0 && index < satTypes.length) {
-            satDisplay.textContent = satTypes[index];
-        }
-    };
+        // Sync Manager (Values are integer choice indices)
+        const lock = new InteractionLock(updateDom, 500);
 
-    // Sync Manager (Values are integers 0-3)
-    const lock = new InteractionLock(updateDom, 500);
+        // Choice parameters arrive as their index
+        addParameterListener(paramId, (value) => lock.onBackendUpdate(Math.round(value)));
 
-    if (juceState) {
-        juceState.valueChangedEvent.addListener(() => {
-            // ComboBoxState updates 'value' (0.0-1.0) internally before this event.
-            // But getChoiceIndex() derives from it.
-            lock.onBackendUpdate(juceState.getChoiceIndex());
-        });
-        updateDom(juceState.getChoiceIndex());
+        display.onclick = function (e) {
+            e.preventDefault();
+            e.stopPropagation();
+
+            let currentIndex = parameterValues.has(paramId) ? Math.round(parameterValues.get(paramId))
+                                                            : choices.indexOf(display.textContent);
+            // Fallback before the first sync
+            if (currentIndex === -1) currentIndex = 0;
+
+            const nextIndex = (currentIndex + 1) % choices.length;
+
+            // Notify Sync Manager
+            lock.onUserAction(nextIndex);
+
+            // Notify JUCE
+            setParameterValue(paramId, nextIndex);
+        };
+    });
+}
+
+/** Shows the loaded IR file name (without extension) on the Reverb card. */
+function showImpulseResponse(name) {
+    const display = document.getElementById('impulse_response_display');
+    if (display) {
+        display.textContent = name ? name.toUpperCase() : 'NO IR';
+        display.title = name || '';
     }
+}
 
-    satDisplay.onclick = function (e) {
+/**
+ * Initialize the Reverb IR selector. Clicking opens the native file browser; the
+ * backend emits "impulseResponse" with the file name once the load has finished.
+ */
+function initializeImpulseResponse() {
+    const display = document.getElementById('impulse_response_display');
+    if (!display) return;
+
+    window.__JUCE__?.backend?.addEventListener?.("impulseResponse", showImpulseResponse);
+
+    display.onclick = function (e) {
         e.preventDefault();
         e.stopPropagation();
 
-        let currentIndex = juceState ? juceState.getChoiceIndex() : 0;
-        // Fallback for independent testing
-        if (!juceState) {
-            currentIndex = satTypes.indexOf(satDisplay.textContent);
-            if (currentIndex === -1) currentIndex = 0;
+        if (window.__JUCE__?.initialisationData?.__juce__functions?.includes?.("chooseImpulseResponse")) {
+            Juce.getNativeFunction("chooseImpulseResponse")();
+        }
+    };
+}
+
+/**
+ * Per-stage CPU overlay, toggled with Ctrl+Shift+D. Only debug and profiling builds
+ * register getStageTimings, so release builds never show it.
+ */
+function initializeStageTimings() {
+    if (!window.__JUCE__?.initialisationData?.__juce__functions?.includes?.("getStageTimings")) return;
+
+    const getStageTimings = Juce.getNativeFunction("getStageTimings");
+    const panel = document.createElement('pre');
+    panel.id = 'stage_timings';
+    panel.style.cssText = 'display:none; position:fixed; right:8px; bottom:8px; margin:0; padding:8px; z-index:1000;' +
+        'background:rgba(0,0,0,0.85); color:#9f9; font:11px monospace; pointer-events:none;';
+    document.body.appendChild(panel);
+
+    let pollTimer = null;
+
+    const refresh = async () => {
+        const timings = await getStageTimings();
+        if (!timings || !timings.sections) return;
+
+        if (!timings.window) {
+            panel.textContent = "Waiting for the first window...";
+            return;
+        }
+
+        const lines = [`stage          calls   mean us    p99 us    max us    cpu %`];
+        for (const [name, t] of Object.entries(timings.sections)) {
+            if (!t.calls) continue;
+            lines.push(name.padEnd(12) + String(t.calls).padStart(7) +
+                [t.meanUs, t.p99Us, t.maxUs, t.cpuPercent].map(v => v.toFixed(2).padStart(10)).join(''));
         }
+        panel.textContent = lines.join('\n');
+    };
+
+    document.addEventListener('keydown', (e) => {
+        if (!(e.ctrlKey && e.shiftKey && e.key.toLowerCase() === 'd')) return;
+        e.preventDefault();
+
+        const show = panel.style.display === 'none';
+        panel.style.display = show ? 'block' : 'none';
+        clearInterval(pollTimer);
+        pollTimer = show ? setInterval(() => refresh().catch(() => {}), 1000) : null;
+        if (show) refresh().catch(() => {});
+    });
+}
+
+/**
+ * Meters. The editor sends one "meters" event per display frame with every level in
+ * dBFS: in and out as [peak L, peak R, rms L, rms R], gr as the limiter's cut, and
+ * stages as each stage's wet peak in chain order.
+ */
+function initializeMeters() {
+    const floorDb = -60;
+    const toPercent = (db) => `${Math.max(0, Math.min(100, (1 - db / floorDb) * 100))}%`;
+
+    // Module cards by chain position; the Reverb card also covers the convolution stage
+    const cardStages = {
+        "mod-halftime": [0], "mod-sat": [1], "mod-filter": [2], "mod-vintage": [3],
+        "mod-chorus": [4], "mod-autopan": [5], "mod-delay": [6], "mod-reverb": [7, 8]
+    };
+
+    const stageFills = [];
+    for (const [cardId, stages] of Object.entries(cardStages)) {
+        const header = document.querySelector(`#${cardId} .module-header`);
+        if (!header) continue;
 
-        const nextIndex = (currentIndex + 1) % satTypes.length;
+        const meter = document.createElement('div');
+        meter.className = 'module-meter';
+        meter.innerHTML = '<div class="module-meter-fill"></div>';
+        header.insertBefore(meter, header.lastElementChild);
+        stageFills.push({ fill: meter.firstElementChild, stages });
+    }
 
-        // Notify Sync Manager
-        lock.onUserAction(nextIndex);
+    const pairBars = (id) => Array.from(document.querySelectorAll(`#${id} .meter-bar`)).map(bar => ({
+        peak: bar.querySelector('.meter-peak'),
+        rms: bar.querySelector('.meter-rms')
+    }));
+    const inBars = pairBars('meter_in');
+    const outBars = pairBars('meter_out');
+    const grReadout = document.getElementById('meter_gr');
+
+    const showPair = (bars, levels) => {
+        bars.forEach((bar, ch) => {
+            bar.peak.style.height = toPercent(levels[ch]);
+            bar.rms.style.height = toPercent(levels[ch + 2]);
+        });
+    };
 
-        // Notify JUCE
-        if (juceState) {
-            juceState.setChoiceIndex(nextIndex);
+    window.__JUCE__?.backend?.addEventListener?.("meters", (meters) => {
+        if (!meters || !Array.isArray(meters.out)) return;
+
+        showPair(inBars, meters.in);
+        showPair(outBars, meters.out);
+        if (grReadout) grReadout.textContent = meters.gr.toFixed(1);
+
+        for (const { fill, stages } of stageFills) {
+            fill.style.width = toPercent(Math.max(...stages.map(i => meters.stages[i] ?? -100)));
         }
+    });
+}
+
+/**
+ * Spectrum view. While it is open the editor runs the analyzer and sends up to 30
+ * "spectrum" events a second: pre and post hold each band's level in dBFS, with the
+ * bands evenly spaced between minHz and maxHz in log or linear frequency.
+ */
+function initializeSpectrum() {
+    const control = document.getElementById('spectrum_control');
+    if (!window.__JUCE__?.initialisationData?.__juce__functions?.includes?.("setSpectrumAnalysis")) {
+        if (control) control.style.display = 'none';
+        return;
+    }
+
+    const setSpectrumAnalysis = Juce.getNativeFunction("setSpectrumAnalysis");
+    const panel = document.getElementById('spectrum_panel');
+    const canvas = document.getElementById('spectrum_canvas');
+    const toggle = document.getElementById('spectrum_toggle');
+    const overlapButton = document.getElementById('spectrum_overlap');
+    const scaleButton = document.getElementById('spectrum_scale');
+    const context = canvas.getContext('2d');
+
+    const overlaps = [1, 2, 4, 8];
+    const state = { open: false, overlap: 4, log: true };
+    const floorDb = -90;
+
+    // The analyzer also stops while the window is hidden
+    const send = () => setSpectrumAnalysis(state.open && !document.hidden,
+                                           { overlap: state.overlap, log: state.log }).catch(() => {});
+
+    toggle.onclick = () => {
+        state.open = !state.open;
+        panel.classList.toggle('open', state.open);
+        toggle.textContent = state.open ? 'ON' : 'OFF';
+        send();
     };
+    overlapButton.onclick = () => {
+        state.overlap = overlaps[(overlaps.indexOf(state.overlap) + 1) % overlaps.length];
+        overlapButton.textContent = `${state.overlap}X`;
+        send();
+    };
+    scaleButton.onclick = () => {
+        state.log = !state.log;
+        scaleButton.textContent = state.log ? 'LOG' : 'LIN';
+        send();
+    };
+    document.addEventListener('visibilitychange', () => { if (state.open) send(); });
+
+    const draw = (spectrum) => {
+        const scale = window.devicePixelRatio || 1;
+        const width = Math.round(canvas.clientWidth * scale);
+        const height = Math.round(canvas.clientHeight * scale);
+        if (canvas.width !== width || canvas.height !== height) {
+            canvas.width = width;
+            canvas.height = height;
+        }
+
+        const span = spectrum.log ? Math.log(spectrum.maxHz / spectrum.minHz) : spectrum.maxHz - spectrum.minHz;
+        const xForHz = (hz) => width * (spectrum.log ? Math.log(hz / spectrum.minHz) : hz - spectrum.minHz) / span;
+        const yForDb = (db) => height * Math.min(1, Math.max(0, db / floorDb));
+
+        context.clearRect(0, 0, width, height);
+
+        // Grid: decades and their halves, and every 18 dB
+        context.strokeStyle = 'rgba(255, 255, 255, 0.06)';
+        context.fillStyle = 'rgba(148, 163, 184, 0.6)';
+        context.font = `${9 * scale}px sans-serif`;
+        context.beginPath();
+        for (const hz of [50, 100, 200, 500, 1000, 2000, 5000, 10000]) {
+            if (hz >= spectrum.maxHz) continue;
+            const x = Math.round(xForHz(hz)) + 0.5;
+            context.moveTo(x, 0);
+            context.lineTo(x, height);
+            context.fillText(hz >= 1000 ? `${hz / 1000}k` : `${hz}`, x + 3 * scale, height - 4 * scale);
+        }
+        for (let db = -18; db > floorDb; db -= 18) {
+            const y = Math.round(yForDb(db)) + 0.5;
+            context.moveTo(0, y);
+            context.lineTo(width, y);
+            context.fillText(`${db}`, 4 * scale, y - 3 * scale);
+        }
+        context.stroke();
+
+        // Bands are evenly spaced on the chosen axis, so each sits at its index
+        const trace = (levels) => {
+            context.beginPath();
+            levels.forEach((db, band) => {
+                const x = width * (band + 0.5) / levels.length;
+                if (band === 0) context.moveTo(x, yForDb(db));
+                else context.lineTo(x, yForDb(db));
+            });
+        };
+
+        trace(spectrum.pre);
+        context.lineTo(width, height);
+        context.lineTo(0, height);
+        context.closePath();
+        context.fillStyle = 'rgba(6, 182, 212, 0.18)';
+        context.fill();
+
+        trace(spectrum.post);
+        context.strokeStyle = 'rgba(245, 158, 11, 0.9)';
+        context.lineWidth = 1.5 * scale;
+        context.stroke();
+        context.lineWidth = 1;
+    };
+
+    window.__JUCE__?.backend?.addEventListener?.("spectrum", (spectrum) => {
+        if (!state.open || !spectrum || !Array.isArray(spectrum.pre) || !Array.isArray(spectrum.post)) return;
+        draw(spectrum);
+    });
 }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+namespace WAVFinBench
+{
+
+//==============================================================================
+/** A parameter value in the parameter's own units (choice index, dB, ms...). */
+struct ParameterValue
+{
+    const char* id;
+    float value;
+};
+
+/** One processor configuration to time: a stage alone, or the whole chain. */
+struct BenchmarkCase
+{
+    juce::String name;
+    std::vector<ParameterValue> parameters;
+
+    /** Length of the generated IR the case plays (see writeImpulseResponse()), or 0 for none. */
+    double impulseSeconds = 0.0;
+
+    /** Runs realtime instead of offline: the convolution tail is left to its worker thread,
+        and blocks are paced at the block period, so the worker gets the time a host gives it. */
+    bool realtime = false;
+
+    /** Block sizes to run instead of --blocks, for a case that is only meaningful over a range. */
+    juce::Array<int> blockSizes;
+};
+
+/** Applied before every case's own parameters. Every stage starts disabled, as in a new
+    instance, so a case times its listed stage plus the output stage that every case
+    shares ("bypass" alone, which is the default plugin with nothing switched on). */
+inline const std::vector<ParameterValue>& getBaseParameters()
+{
+    static const std::vector<ParameterValue> base
+    {
+        { "halftime_enable", 0.0f }, { "sat_enable", 0.0f },
+        { "filter_enable", 0.0f }, { "vintage_enable", 0.0f }, { "chorus_enable", 0.0f },
+        { "pan_enable", 0.0f }, { "delay_enable", 0.0f }, { "reverb_enable", 0.0f },
+        { "limiter_mode", 0.0f }
+    };
+
+    return base;
+}
+
+/** Every case, in the order they run. Names are "stage/setting"; --cases matches on the prefix. */
+inline std::vector<BenchmarkCase> getBenchmarkCases()
+{
+    const std::vector<ParameterValue> fullChain
+    {
+        { "halftime_enable", 1.0f }, { "sat_enable", 1.0f }, { "sat_drive", 12.0f }, { "sat_quality", 1.0f },
+        { "filter_enable", 1.0f }, { "filter_lfo_depth", 30.0f }, { "vintage_enable", 1.0f }, { "vintage_noise", 10.0f },
+        { "chorus_enable", 1.0f }, { "pan_enable", 1.0f }, { "delay_enable", 1.0f },
+        { "reverb_enable", 1.0f }, { "conv_mix", 30.0f }
+    };
+
+    auto withLimiter = fullChain;
+    withLimiter.push_back ({ "limiter_mode", 1.0f });
+
+    // The FDN's mix at 0 closes its gate, leaving the IR alone on the reverb card
+    const std::vector<ParameterValue> impulseOnly { { "reverb_enable", 1.0f }, { "reverb_mix", 0.0f }, { "conv_mix", 100.0f } };
+    const juce::Array<int> convolutionBlockSizes { 32, 64, 128, 256, 512, 1024 };
+
+    return
+    {
+        { "bypass",             {} },
+        { "halftime",           { { "halftime_enable", 1.0f } } },
+        { "saturation/1x",      { { "sat_enable", 1.0f }, { "sat_drive", 12.0f }, { "sat_quality", 0.0f } } },
+        { "saturation/2x",      { { "sat_enable", 1.0f }, { "sat_drive", 12.0f }, { "sat_quality", 1.0f } } },
+        { "saturation/4x",      { { "sat_enable", 1.0f }, { "sat_drive", 12.0f }, { "sat_quality", 2.0f } } },
+        { "saturation/8x",      { { "sat_enable", 1.0f }, { "sat_drive", 12.0f }, { "sat_quality", 3.0f } } },
+        { "filter/static",      { { "filter_enable", 1.0f }, { "filter_lfo_depth", 0.0f } } },
+        { "filter/lfo",         { { "filter_enable", 1.0f }, { "filter_lfo_depth", 50.0f } } },
+        { "vintage",            { { "vintage_enable", 1.0f }, { "vintage_noise", 20.0f } } },
+        { "chorus",             { { "chorus_enable", 1.0f } } },
+        { "pan",                { { "pan_enable", 1.0f } } },
+        { "delay/linear",       { { "delay_enable", 1.0f }, { "delay_quality", 0.0f } } },
+        { "delay/hermite",      { { "delay_enable", 1.0f }, { "delay_quality", 1.0f } } },
+        { "reverb/fdn",         { { "reverb_enable", 1.0f }, { "conv_mix", 0.0f } } },
+
+        { "reverb/ir",          impulseOnly, 2.0 },
+
+        // The split between the audio thread and the tail worker, as a host would run it
+        { "convolution/2s",     impulseOnly, 2.0, true, convolutionBlockSizes },
+        { "convolution/10s",    impulseOnly, 10.0, true, convolutionBlockSizes },
+
+        { "limiter/true-peak",  { { "limiter_mode", 1.0f } } },
+        { "chain/clip",         fullChain, 2.0 },
+        { "chain/true-peak",    withLimiter, 2.0 }
+    };
+}
+
+} // namespace WAVFinBench
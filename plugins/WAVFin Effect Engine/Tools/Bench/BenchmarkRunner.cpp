@@ -0,0 +1,366 @@
+#include "BenchmarkRunner.h"
+#include <map>
+#include <numeric>
+
+namespace WAVFinBench
+{
+
+namespace
+{
+    // Longest wait for the loader thread to decode and resample the impulse response
+    constexpr int impulseLoadTimeoutMs = 60000;
+
+    // Distinct input blocks cycled through, so no two neighbouring blocks are the same
+    constexpr int numInputBlocks = 8;
+
+    constexpr float inputLevel = 0.25f;     // -12 dBFS
+
+    constexpr int reportVersion = 1;
+
+    /** Nearest-rank percentile of sorted values. */
+    double percentile (const std::vector<double>& sorted, double percent)
+    {
+        const auto rank = (size_t) std::ceil (percent / 100.0 * (double) sorted.size());
+        return sorted[juce::jlimit ((size_t) 1, sorted.size(), rank) - 1];
+    }
+
+    /** Sleeps until a millisecond before the tick count, then spins, because block periods
+        can be shorter than the sleep granularity. */
+    void waitUntil (juce::int64 ticks)
+    {
+        for (;;)
+        {
+            const auto remaining = juce::Time::highResolutionTicksToSeconds (ticks - juce::Time::getHighResolutionTicks());
+
+            if (remaining <= 0.0)
+                return;
+
+            if (remaining > 0.002)
+                juce::Thread::sleep ((int) (remaining * 1000.0) - 1);
+        }
+    }
+
+    template <typename Type>
+    juce::var toVarArray (const juce::Array<Type>& values)
+    {
+        juce::Array<juce::var> list;
+
+        for (const auto& value : values)
+            list.add (value);
+
+        return list;
+    }
+}
+
+//==============================================================================
+juce::String BenchmarkResult::getKey() const
+{
+    return caseName + "@" + juce::String (juce::roundToInt (sampleRate)) + "/" + juce::String (blockSize) + "/" + juce::String (numChannels);
+}
+
+juce::var BenchmarkResult::toVar() const
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty ("case", caseName);
+    object->setProperty ("sampleRate", sampleRate);
+    object->setProperty ("blockSize", blockSize);
+    object->setProperty ("channels", numChannels);
+    object->setProperty ("blocks", numBlocks);
+    object->setProperty ("meanNs", mean);
+    object->setProperty ("p50Ns", p50);
+    object->setProperty ("p90Ns", p90);
+    object->setProperty ("p99Ns", p99);
+    object->setProperty ("maxNs", max);
+    object->setProperty ("cpuPercent", cpuPercent);
+    object->setProperty ("underruns", underruns);
+    return object;
+}
+
+BenchmarkResult BenchmarkResult::fromVar (const juce::var& v)
+{
+    BenchmarkResult result;
+    result.caseName = v["case"].toString();
+    result.sampleRate = v["sampleRate"];
+    result.blockSize = v["blockSize"];
+    result.numChannels = v["channels"];
+    result.numBlocks = v["blocks"];
+    result.mean = v["meanNs"];
+    result.p50 = v["p50Ns"];
+    result.p90 = v["p90Ns"];
+    result.p99 = v["p99Ns"];
+    result.max = v["maxNs"];
+    result.cpuPercent = v["cpuPercent"];
+    result.underruns = v["underruns"];
+    return result;
+}
+
+//==============================================================================
+BenchmarkRunner::BenchmarkRunner (const BenchmarkSettings& s)
+    : settings (s)
+{
+}
+
+juce::Result BenchmarkRunner::run (const BenchmarkCase& benchmarkCase, const ResultCallback& onResult)
+{
+    WAVFinEffectEngineAudioProcessor processor;
+
+    if (auto result = configure (processor, benchmarkCase); result.failed())
+        return result;
+
+    processor.setProcessingPrecision (settings.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                               : juce::AudioProcessor::singlePrecision);
+    processor.setNonRealtime (! benchmarkCase.realtime);
+
+    const auto& blockSizes = benchmarkCase.blockSizes.isEmpty() ? settings.blockSizes : benchmarkCase.blockSizes;
+
+    for (const auto numChannels : settings.channelCounts)
+    {
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.outputBuses.add (channelSet);
+
+        if (! processor.setBusesLayout (layout))
+            return juce::Result::fail ("The processor does not accept " + juce::String (numChannels) + " channels");
+
+        for (const auto sampleRate : settings.sampleRates)
+        {
+            for (const auto blockSize : blockSizes)
+            {
+                auto result = settings.doublePrecision ? measure<double> (processor, sampleRate, blockSize, numChannels, benchmarkCase.realtime)
+                                                       : measure<float> (processor, sampleRate, blockSize, numChannels, benchmarkCase.realtime);
+                result.caseName = benchmarkCase.name;
+                onResult (result);
+            }
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result BenchmarkRunner::configure (WAVFinEffectEngineAudioProcessor& processor, const BenchmarkCase& benchmarkCase) const
+{
+    auto apply = [&processor] (const std::vector<ParameterValue>& values)
+    {
+        for (const auto& value : values)
+        {
+            auto* param = processor.apvts.getParameter (value.id);
+
+            if (param == nullptr)
+                return juce::Result::fail (juce::String ("Unknown parameter: ") + value.id);
+
+            param->setValueNotifyingHost (param->convertTo0to1 (value.value));
+        }
+
+        return juce::Result::ok();
+    };
+
+    if (auto result = apply (getBaseParameters()); result.failed())
+        return result;
+
+    if (auto result = apply (benchmarkCase.parameters); result.failed())
+        return result;
+
+    if (benchmarkCase.impulseSeconds <= 0.0)
+        return juce::Result::ok();
+
+    const auto impulse = settings.impulseResponses.find (benchmarkCase.impulseSeconds);
+
+    if (impulse == settings.impulseResponses.end())
+        return juce::Result::fail ("No " + juce::String (benchmarkCase.impulseSeconds) + " s impulse response was written");
+
+    auto& convolution = processor.getConvolution();
+    convolution.loadImpulseResponse (impulse->second);
+
+    if (! convolution.waitForPendingLoads (impulseLoadTimeoutMs))
+        return juce::Result::fail ("Timed out loading the impulse response");
+
+    // A failed load leaves the previous file (here, none) in place
+    if (convolution.getImpulseResponseFile() != impulse->second)
+        return juce::Result::fail ("Could not load impulse response " + impulse->second.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+template <typename SampleType>
+BenchmarkResult BenchmarkRunner::measure (WAVFinEffectEngineAudioProcessor& processor, double sampleRate, int blockSize, int numChannels, bool realtime)
+{
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<SampleType> input (numChannels, blockSize * numInputBlocks);
+    juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random (1);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int s = 0; s < input.getNumSamples(); ++s)
+            input.setSample (ch, s, (SampleType) (inputLevel * (2.0f * random.nextFloat() - 1.0f)));
+
+    const auto numBlocks = juce::jmax (BenchmarkSettings::minBlocks, (int) std::ceil (settings.secondsPerPoint * sampleRate / blockSize));
+    const auto numWarmUpBlocks = numBlocks / 4;
+
+    blockTimes.clear();
+    blockTimes.reserve ((size_t) numBlocks);
+
+    // Realtime blocks start one block period apart, as a host's callbacks would
+    const auto periodTicks = juce::Time::secondsToHighResolutionTicks (blockSize / sampleRate);
+    auto nextBlockTicks = juce::Time::getHighResolutionTicks();
+
+    for (int block = -numWarmUpBlocks; block < numBlocks; ++block)
+    {
+        if (realtime)
+        {
+            waitUntil (nextBlockTicks);
+            nextBlockTicks += periodTicks;
+        }
+
+        const auto offset = (((block % numInputBlocks) + numInputBlocks) % numInputBlocks) * blockSize;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.copyFrom (ch, 0, input, ch, offset, blockSize);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock (buffer, midi);
+        const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+
+        if (block >= 0)
+            blockTimes.push_back (juce::Time::highResolutionTicksToSeconds (ticks));
+    }
+
+    const auto underruns = processor.getConvolution().getNumUnderruns();
+    processor.releaseResources();
+
+    // Seconds per block to nanoseconds per sample
+    const auto scale = 1.0e9 / (blockSize * numChannels);
+    std::sort (blockTimes.begin(), blockTimes.end());
+
+    BenchmarkResult result;
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.numChannels = numChannels;
+    result.numBlocks = numBlocks;
+
+    const auto meanSeconds = std::accumulate (blockTimes.begin(), blockTimes.end(), 0.0) / numBlocks;
+    result.mean = meanSeconds * scale;
+    result.p50 = percentile (blockTimes, 50.0) * scale;
+    result.p90 = percentile (blockTimes, 90.0) * scale;
+    result.p99 = percentile (blockTimes, 99.0) * scale;
+    result.max = blockTimes.back() * scale;
+    result.cpuPercent = 100.0 * meanSeconds * sampleRate / blockSize;
+    result.underruns = underruns;
+    return result;
+}
+
+juce::Result BenchmarkRunner::writeImpulseResponse (const juce::File& file, double lengthSeconds)
+{
+    constexpr double sampleRate = 48000.0;
+    const double decaySeconds = lengthSeconds / 5.0;    // time constant of the envelope: 0.4 s for 2 s, about 2.8 s RT60
+
+    juce::AudioBuffer<float> impulse (2, (int) (sampleRate * lengthSeconds));
+    juce::Random random (2);
+
+    for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+        for (int s = 0; s < impulse.getNumSamples(); ++s)
+            impulse.setSample (ch, s, (2.0f * random.nextFloat() - 1.0f) * (float) std::exp (-s / (decaySeconds * sampleRate)));
+
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+
+    if (stream == nullptr)
+        return juce::Result::fail ("Cannot write " + file.getFullPathName());
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate, 2, 24, {}, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("Cannot write " + file.getFullPathName());
+
+    stream.release();   // owned by the writer now
+
+    if (! writer->writeFromAudioSampleBuffer (impulse, 0, impulse.getNumSamples()))
+        return juce::Result::fail ("Write error on " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+juce::var createReport (const BenchmarkSettings& settings, const juce::Array<BenchmarkResult>& results)
+{
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty ("cores", juce::SystemStats::getNumPhysicalCpus());
+    machine->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+
+    auto* config = new juce::DynamicObject();
+    config->setProperty ("sampleRates", toVarArray (settings.sampleRates));
+    config->setProperty ("blockSizes", toVarArray (settings.blockSizes));
+    config->setProperty ("channels", toVarArray (settings.channelCounts));
+    config->setProperty ("secondsPerPoint", settings.secondsPerPoint);
+    config->setProperty ("precision", settings.doublePrecision ? "double" : "float");
+   #if JUCE_DEBUG
+    config->setProperty ("build", "debug");
+   #else
+    config->setProperty ("build", "release");
+   #endif
+
+    juce::Array<juce::var> list;
+
+    for (const auto& result : results)
+        list.add (result.toVar());
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty ("version", reportVersion);
+    report->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    report->setProperty ("machine", machine);
+    report->setProperty ("settings", config);
+    report->setProperty ("results", list);
+    return report;
+}
+
+juce::Result readReport (const juce::File& file, juce::Array<BenchmarkResult>& results)
+{
+    juce::var report;
+
+    if (auto result = juce::JSON::parse (file.loadFileAsString(), report); result.failed())
+        return juce::Result::fail (file.getFileName() + ": " + result.getErrorMessage());
+
+    if ((int) report["version"] != reportVersion)
+        return juce::Result::fail (file.getFileName() + " is not a wavfin-bench report (version " + juce::String (reportVersion) + ")");
+
+    const auto* list = report["results"].getArray();
+
+    if (list == nullptr)
+        return juce::Result::fail (file.getFileName() + " has no results");
+
+    for (const auto& item : *list)
+        results.add (BenchmarkResult::fromVar (item));
+
+    return juce::Result::ok();
+}
+
+void compareResults (const juce::Array<BenchmarkResult>& baseline, const juce::Array<BenchmarkResult>& current,
+                     double thresholdPercent, juce::Array<BenchmarkChange>& regressions, juce::Array<BenchmarkChange>& improvements)
+{
+    std::map<juce::String, double> baselineMedians;
+
+    for (const auto& result : baseline)
+        baselineMedians[result.getKey()] = result.p50;
+
+    for (const auto& result : current)
+    {
+        const auto found = baselineMedians.find (result.getKey());
+
+        if (found == baselineMedians.end())
+            continue;
+
+        const BenchmarkChange change { result.getKey(), found->second, result.p50 };
+
+        // The median, so that a single preempted block does not flag a point
+        if (change.getPercent() > thresholdPercent)
+            regressions.add (change);
+        else if (change.getPercent() < -thresholdPercent)
+            improvements.add (change);
+    }
+}
+
+} // namespace WAVFinBench
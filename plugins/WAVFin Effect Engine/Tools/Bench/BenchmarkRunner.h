@@ -0,0 +1,114 @@
+#pragma once
+
+#include "PluginProcessor.h"
+#include "BenchmarkCases.h"
+#include <map>
+
+namespace WAVFinBench
+{
+
+//==============================================================================
+/** The matrix every case runs over, and how long each point is timed. */
+struct BenchmarkSettings
+{
+    juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> blockSizes { 16, 64, 256, 1024, 4096 };
+    juce::Array<int> channelCounts { 1, 2 };
+
+    /** Audio timed at each point, after a warm-up of a quarter of that. Never fewer than minBlocks. */
+    double secondsPerPoint = 1.0;
+    static constexpr int minBlocks = 64;
+
+    bool doublePrecision = false;
+
+    /** The IRs the cases play, by length in seconds; see writeImpulseResponse(). */
+    std::map<double, juce::File> impulseResponses;
+};
+
+/** Timing of one case at one rate, block size and channel count. Times are per block,
+    divided by the samples in it (frames x channels), so they compare across the matrix. */
+struct BenchmarkResult
+{
+    juce::String caseName;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int numChannels = 0;
+    int numBlocks = 0;
+
+    // Nanoseconds per sample
+    double mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+
+    /** Mean block time as a share of the block's duration. */
+    double cpuPercent = 0.0;
+
+    /** Convolution tail blocks the worker did not deliver in time (realtime cases only). */
+    int underruns = 0;
+
+    /** "case@rate/block/channels", which identifies the point across runs. */
+    juce::String getKey() const;
+
+    juce::var toVar() const;
+    static BenchmarkResult fromVar (const juce::var& v);
+};
+
+//==============================================================================
+/**
+    Times processBlock for one case across the whole BenchmarkSettings matrix.
+
+    Each case gets a fresh processor, configured as BenchmarkCases.h describes. Most cases
+    run non-realtime, so all of their work (the convolution tail included) lands in the
+    timed call. Realtime cases leave the tail to the worker thread and wait out each block
+    period, so the time is the audio thread's share alone. The input is seeded white noise
+    at -12 dBFS, which keeps every stage awake.
+*/
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner (const BenchmarkSettings& settings);
+
+    using ResultCallback = std::function<void (const BenchmarkResult&)>;
+
+    /** Runs every point of the matrix, calling onResult after each. Fails if a parameter
+        is unknown or the impulse response will not load. */
+    juce::Result run (const BenchmarkCase& benchmarkCase, const ResultCallback& onResult);
+
+    /** Writes an IR for the cases that play one: decaying stereo noise, lengthSeconds long and
+        still about -43 dB at its end, so none of it is trimmed as silence. */
+    static juce::Result writeImpulseResponse (const juce::File& file, double lengthSeconds);
+
+private:
+    //==============================================================================
+    juce::Result configure (WAVFinEffectEngineAudioProcessor& processor, const BenchmarkCase& benchmarkCase) const;
+
+    template <typename SampleType>
+    BenchmarkResult measure (WAVFinEffectEngineAudioProcessor& processor, double sampleRate, int blockSize, int numChannels, bool realtime);
+
+    //==============================================================================
+    const BenchmarkSettings& settings;
+    std::vector<double> blockTimes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BenchmarkRunner)
+};
+
+//==============================================================================
+/** The JSON written by a run: the settings, the machine and every result. */
+juce::var createReport (const BenchmarkSettings& settings, const juce::Array<BenchmarkResult>& results);
+
+/** Reads the results back from a report. */
+juce::Result readReport (const juce::File& file, juce::Array<BenchmarkResult>& results);
+
+/** A point whose median moved by more than the threshold against the baseline. */
+struct BenchmarkChange
+{
+    juce::String key;
+    double baseline = 0.0, current = 0.0;     // median ns/sample
+
+    double getPercent() const noexcept      { return baseline > 0.0 ? 100.0 * (current - baseline) / baseline : 0.0; }
+};
+
+/** Points in both sets whose median got slower (regressions) or faster (improvements)
+    by more than thresholdPercent. Points missing from either side are left out. */
+void compareResults (const juce::Array<BenchmarkResult>& baseline, const juce::Array<BenchmarkResult>& current,
+                     double thresholdPercent, juce::Array<BenchmarkChange>& regressions, juce::Array<BenchmarkChange>& improvements);
+
+} // namespace WAVFinBench
@@ -0,0 +1,294 @@
+#include "BenchmarkRunner.h"
+#include "ParameterTraffic.h"
+#include <iostream>
+
+using namespace WAVFinBench;
+
+namespace
+{
+    constexpr double defaultThresholdPercent = 10.0;
+
+    /** A comma-separated --option as numbers, or the defaults when it is absent. */
+    template <typename Type>
+    juce::Array<Type> parseList (const juce::ArgumentList& args, const char* option, const juce::Array<Type>& defaults)
+    {
+        if (! args.containsOption (option))
+            return defaults;
+
+        juce::Array<Type> values;
+
+        for (const auto& token : juce::StringArray::fromTokens (args.getValueForOption (option), ",", {}))
+        {
+            const auto value = (Type) token.getDoubleValue();
+
+            if (! token.trim().containsOnly ("0123456789.") || value <= 0)
+                juce::ConsoleApplication::fail (juce::String (option) + " takes a list of positive numbers, like " + option + "=48000,96000");
+
+            values.add (value);
+        }
+
+        return values;
+    }
+
+    double parseThreshold (const juce::ArgumentList& args)
+    {
+        if (! args.containsOption ("--threshold"))
+            return defaultThresholdPercent;
+
+        const auto threshold = args.getValueForOption ("--threshold").getDoubleValue();
+
+        if (threshold <= 0.0)
+            juce::ConsoleApplication::fail ("--threshold must be a positive percentage");
+
+        return threshold;
+    }
+
+    /** The cases whose name starts with one of the --cases prefixes, or all of them. */
+    std::vector<BenchmarkCase> selectCases (const juce::ArgumentList& args)
+    {
+        auto cases = getBenchmarkCases();
+
+        if (! args.containsOption ("--cases"))
+            return cases;
+
+        const auto prefixes = juce::StringArray::fromTokens (args.getValueForOption ("--cases"), ",", {});
+        std::vector<BenchmarkCase> selected;
+
+        for (auto& benchmarkCase : cases)
+            for (const auto& prefix : prefixes)
+                if (benchmarkCase.name.startsWith (prefix.trim()))
+                {
+                    selected.push_back (std::move (benchmarkCase));
+                    break;
+                }
+
+        if (selected.empty())
+            juce::ConsoleApplication::fail ("No case matches --cases (see --list)");
+
+        return selected;
+    }
+
+    void printResult (const BenchmarkResult& result)
+    {
+        std::cout << result.caseName.paddedRight (' ', 20)
+                  << juce::String (juce::roundToInt (result.sampleRate)).paddedLeft (' ', 7) << " Hz"
+                  << juce::String (result.blockSize).paddedLeft (' ', 6) << " x " << result.numChannels << "ch"
+                  << "   ns/sample mean " << juce::String (result.mean, 2).paddedLeft (' ', 8)
+                  << "  p50 " << juce::String (result.p50, 2).paddedLeft (' ', 8)
+                  << "  p99 " << juce::String (result.p99, 2).paddedLeft (' ', 8)
+                  << "  max " << juce::String (result.max, 2).paddedLeft (' ', 9)
+                  << "   " << juce::String (result.cpuPercent, 2) << "% CPU"
+                  << (result.underruns > 0 ? "   " + juce::String (result.underruns) + " underruns" : juce::String())
+                  << std::endl;
+    }
+
+    /** Prints the changes and fails the run if any point regressed. */
+    void reportComparison (const juce::Array<BenchmarkResult>& baseline, const juce::Array<BenchmarkResult>& current, double thresholdPercent)
+    {
+        juce::Array<BenchmarkChange> regressions, improvements;
+        compareResults (baseline, current, thresholdPercent, regressions, improvements);
+
+        auto print = [] (const char* label, const BenchmarkChange& change)
+        {
+            std::cout << label << change.key << ": " << juce::String (change.baseline, 2) << " -> "
+                      << juce::String (change.current, 2) << " ns/sample ("
+                      << (change.getPercent() > 0.0 ? "+" : "") << juce::String (change.getPercent(), 1) << "%)" << std::endl;
+        };
+
+        for (const auto& change : improvements)
+            print ("faster  ", change);
+
+        for (const auto& change : regressions)
+            print ("SLOWER  ", change);
+
+        std::cout << regressions.size() << " regressions and " << improvements.size()
+                  << " improvements beyond " << juce::String (thresholdPercent, 1) << "% (median ns/sample)" << std::endl;
+
+        if (! regressions.isEmpty())
+            juce::ConsoleApplication::fail (juce::String (regressions.size()) + " points regressed against the baseline");
+    }
+
+    //==============================================================================
+    void runBenchmarks (const juce::ArgumentList& args)
+    {
+        BenchmarkSettings settings;
+        settings.sampleRates = parseList (args, "--rates", settings.sampleRates);
+        settings.blockSizes = parseList (args, "--blocks", settings.blockSizes);
+        settings.channelCounts = parseList (args, "--channels", settings.channelCounts);
+        settings.doublePrecision = args.containsOption ("--double");
+
+        if (args.containsOption ("--seconds"))
+            settings.secondsPerPoint = juce::jmax (0.01, args.getValueForOption ("--seconds").getDoubleValue());
+
+        for (const auto numChannels : settings.channelCounts)
+            if (numChannels > 2)
+                juce::ConsoleApplication::fail ("--channels: the processor runs mono or stereo");
+
+        const auto cases = selectCases (args);
+        const auto threshold = parseThreshold (args);
+
+        juce::Array<BenchmarkResult> baseline;
+
+        if (args.containsOption ("--baseline"))
+            if (auto result = readReport (args.getExistingFileForOption ("--baseline"), baseline); result.failed())
+                juce::ConsoleApplication::fail (result.getErrorMessage());
+
+        const auto output = args.containsOption ("--output") ? args.getFileForOption ("--output")
+                                                             : juce::File::getCurrentWorkingDirectory().getChildFile ("wavfin-bench.json");
+
+        // One IR per length the selected cases play, deleted when the run ends
+        std::vector<std::unique_ptr<juce::TemporaryFile>> impulses;
+
+        for (const auto& benchmarkCase : cases)
+        {
+            if (benchmarkCase.impulseSeconds <= 0.0 || settings.impulseResponses.count (benchmarkCase.impulseSeconds) > 0)
+                continue;
+
+            impulses.push_back (std::make_unique<juce::TemporaryFile> (".wav"));
+            settings.impulseResponses[benchmarkCase.impulseSeconds] = impulses.back()->getFile();
+
+            if (auto result = BenchmarkRunner::writeImpulseResponse (impulses.back()->getFile(), benchmarkCase.impulseSeconds); result.failed())
+                juce::ConsoleApplication::fail (result.getErrorMessage());
+        }
+
+       #if JUCE_DEBUG
+        std::cerr << "Warning: this is a debug build, so the timings do not reflect a release" << std::endl;
+       #endif
+
+        BenchmarkRunner runner (settings);
+        juce::Array<BenchmarkResult> results;
+
+        for (const auto& benchmarkCase : cases)
+        {
+            const auto result = runner.run (benchmarkCase, [&results] (const BenchmarkResult& r)
+            {
+                printResult (r);
+                results.add (r);
+            });
+
+            if (result.failed())
+                juce::ConsoleApplication::fail (benchmarkCase.name + ": " + result.getErrorMessage());
+        }
+
+        if (! output.replaceWithText (juce::JSON::toString (createReport (settings, results))))
+            juce::ConsoleApplication::fail ("Cannot write " + output.getFullPathName());
+
+        std::cout << results.size() << " points written to " << output.getFullPathName() << std::endl;
+
+        if (! baseline.isEmpty())
+            reportComparison (baseline, results, threshold);
+    }
+
+    void compareReports (const juce::ArgumentList& args)
+    {
+        juce::StringArray files;
+
+        for (int i = 1; i < args.size(); ++i)
+            if (! args[i].isOption())
+                files.add (args[i].text);
+
+        if (files.size() != 2)
+            juce::ConsoleApplication::fail ("Expected a baseline and a results file");
+
+        auto read = [] (const juce::String& path)
+        {
+            juce::Array<BenchmarkResult> results;
+
+            if (auto result = readReport (juce::File::getCurrentWorkingDirectory().getChildFile (path), results); result.failed())
+                juce::ConsoleApplication::fail (result.getErrorMessage());
+
+            return results;
+        };
+
+        reportComparison (read (files[0]), read (files[1]), parseThreshold (args));
+    }
+
+    /** A positive --option, or the default when it is absent. */
+    double parsePositive (const juce::ArgumentList& args, const char* option, double defaultValue)
+    {
+        if (! args.containsOption (option))
+            return defaultValue;
+
+        const auto value = args.getValueForOption (option).getDoubleValue();
+
+        if (value <= 0.0)
+            juce::ConsoleApplication::fail (juce::String (option) + " must be a positive number");
+
+        return value;
+    }
+
+    void measureTraffic (const juce::ArgumentList& args)
+    {
+        TrafficSettings settings;
+        settings.sampleRate = parsePositive (args, "--rate", settings.sampleRate);
+        settings.blockSize = (int) parsePositive (args, "--block", settings.blockSize);
+        settings.seconds = parsePositive (args, "--seconds", settings.seconds);
+        settings.framesPerSecond = parsePositive (args, "--fps", settings.framesPerSecond);
+        settings.hiddenSeconds = juce::jmin (settings.hiddenSeconds, settings.seconds * 0.5);
+
+        const auto result = measureParameterTraffic (settings);
+        const auto ratio = [] (juce::int64 before, juce::int64 after)
+        {
+            return after > 0 ? juce::String ((double) before / (double) after, 1) + "x fewer" : juce::String ("none left");
+        };
+
+        std::cout << "Every automatable parameter moving each " << settings.blockSize << "-sample block at "
+                  << juce::roundToInt (settings.sampleRate) << " Hz for " << settings.seconds << " s, "
+                  << settings.framesPerSecond << " frames/s, hidden for " << settings.hiddenSeconds << " s" << std::endl
+                  << "  per change:  " << result.changes << " events, " << result.changeBytes << " bytes" << std::endl
+                  << "  per frame:   " << result.batches << " batches holding " << result.batchedValues << " values, "
+                  << result.batchBytes << " bytes (" << result.hiddenFrames << " of " << result.frames << " frames hidden)" << std::endl
+                  << "  events " << ratio (result.changes, result.batches) << ", bytes " << ratio (result.changeBytes, result.batchBytes) << std::endl;
+    }
+
+    void listCases (const juce::ArgumentList&)
+    {
+        for (const auto& benchmarkCase : getBenchmarkCases())
+            std::cout << benchmarkCase.name << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's timers and change broadcasters need a message manager, even with no loop running
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage: wavfin-bench [options] | compare <baseline> <results> | traffic | --list", true);
+
+    app.addDefaultCommand ({ "",
+                             "[options]",
+                             "Times every case across the rate, block size and channel matrix.",
+                             "  --cases=<a,b>        only the cases starting with these names (see --list)\n"
+                             "  --rates=<hz,...>     default 44100,48000,96000,192000\n"
+                             "  --blocks=<n,...>     default 16,64,256,1024,4096 (the convolution cases run 32-1024)\n"
+                             "  --channels=<n,...>   default 1,2\n"
+                             "  --seconds=<s>        audio timed per point (default 1)\n"
+                             "  --double             process in double precision\n"
+                             "  --output=<file>      JSON report (default wavfin-bench.json)\n"
+                             "  --baseline=<file>    compare against an earlier report and fail on a regression\n"
+                             "  --threshold=<pct>    change in median ns/sample that counts (default 10)\n",
+                             runBenchmarks });
+
+    app.addCommand ({ "compare",
+                      "compare <baseline.json> <results.json> [--threshold=<pct>]",
+                      "Compares two reports, failing if any point regressed.",
+                      "Points are matched on case, rate, block size and channel count.",
+                      compareReports });
+
+    app.addCommand ({ "traffic",
+                      "traffic [--rate=<hz>] [--block=<n>] [--seconds=<s>] [--fps=<n>]",
+                      "Counts the messages host automation sends the web UI, per change and per frame.",
+                      "Every automatable parameter moves on every block (default 64 samples at 48000 Hz)\n"
+                      "for --seconds (default 10), against display frames at --fps (default 60).",
+                      measureTraffic });
+
+    app.addCommand ({ "--list",
+                      "--list",
+                      "Lists the benchmark cases.",
+                      {},
+                      listCases });
+
+    return app.findAndRunCommand (argc, argv);
+}
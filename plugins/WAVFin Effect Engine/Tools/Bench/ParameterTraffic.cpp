@@ -0,0 +1,95 @@
+#include "ParameterTraffic.h"
+#include "PluginProcessor.h"
+#include "ParameterSync.h"
+
+namespace WAVFinBench
+{
+
+namespace
+{
+    // Each parameter's sine runs a little faster than the one before, from this rate
+    constexpr double slowestSweepHz = 0.25, sweepStepHz = 0.05;
+
+    juce::int64 jsonSize (const juce::var& value)
+    {
+        return (juce::int64) juce::JSON::toString (value, true).getNumBytesAsUTF8();
+    }
+
+    /** What a relay sent for one change. */
+    juce::var makeChangeEvent (float value)
+    {
+        auto* event = new juce::DynamicObject();
+        event->setProperty ("eventType", "valueChanged");
+        event->setProperty ("value", value);
+        return event;
+    }
+}
+
+//==============================================================================
+TrafficResult measureParameterTraffic (const TrafficSettings& settings)
+{
+    WAVFinEffectEngineAudioProcessor processor;
+    ParameterSync sync (processor);
+
+    // The page's first pull takes the starting values
+    sync.getChangesSince (0);
+    sync.markSent();
+
+    juce::Array<juce::RangedAudioParameter*> automated;
+
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter); ranged != nullptr && ranged->isAutomatable())
+            automated.add (ranged);
+
+    const auto totalSamples = (juce::int64) (settings.sampleRate * settings.seconds);
+    const auto hiddenStart = (settings.seconds - settings.hiddenSeconds) * 0.5;
+    const auto hiddenEnd = hiddenStart + settings.hiddenSeconds;
+
+    TrafficResult result;
+    double nextFrame = 0.0;
+
+    for (juce::int64 position = 0; position < totalSamples; position += settings.blockSize)
+    {
+        const auto time = (double) position / settings.sampleRate;
+
+        // A host sets the value and then tells the listeners, as the plugin wrappers do
+        for (int i = 0; i < automated.size(); ++i)
+        {
+            auto* parameter = automated[i];
+            const auto phase = juce::MathConstants<double>::twoPi * (slowestSweepHz + sweepStepHz * i) * time;
+            const auto value = parameter->convertTo0to1 (parameter->convertFrom0to1 ((float) (0.5 + 0.5 * std::sin (phase))));
+
+            if (value == parameter->getValue())
+                continue;
+
+            parameter->setValue (value);
+            parameter->sendValueChangedMessageToListeners (value);
+
+            ++result.changes;
+            result.changeBytes += jsonSize (makeChangeEvent (parameter->convertFrom0to1 (value)));
+        }
+
+        if (time < nextFrame)
+            continue;
+
+        nextFrame += 1.0 / settings.framesPerSecond;
+        ++result.frames;
+
+        if (time >= hiddenStart && time < hiddenEnd)
+        {
+            ++result.hiddenFrames;
+            continue;
+        }
+
+        if (auto batch = sync.getNextBatch(); ! batch.isVoid())
+        {
+            ++result.batches;
+            result.batchedValues += batch["values"].getDynamicObject()->getProperties().size();
+            result.batchBytes += jsonSize (batch);
+        }
+    }
+
+    return result;
+}
+
+} // namespace WAVFinBench
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace WAVFinBench
+{
+
+//==============================================================================
+/** The automation played against the editor's parameter queue. */
+struct TrafficSettings
+{
+    double sampleRate = 48000.0;
+    int blockSize = 64;
+    double seconds = 10.0;
+    double framesPerSecond = 60.0;
+
+    /** Taken from the middle of the run: the editor sends nothing while it is hidden. */
+    double hiddenSeconds = 2.0;
+};
+
+/** Messages the web UI would receive, the old way and the queued way. Sizes are of the
+    JSON each message carries. */
+struct TrafficResult
+{
+    juce::int64 changes = 0, changeBytes = 0;       // one event per parameter change
+    juce::int64 frames = 0, hiddenFrames = 0;       // display frames, and those while hidden
+    juce::int64 batches = 0, batchedValues = 0, batchBytes = 0;
+};
+
+/**
+    Host automation stress on the parameter traffic to the web UI.
+
+    Every automatable parameter of a fresh processor moves on every block, each on its own
+    slow sine, set the way a host's automation sets it. Each change would have been one
+    event from its relay; the queue (ParameterSync, as the editor drives it once per display
+    frame) sends at most one batch per frame, holding each moved parameter once.
+*/
+TrafficResult measureParameterTraffic (const TrafficSettings& settings);
+
+} // namespace WAVFinBench
@@ -0,0 +1,287 @@
+#include "PluginProcessor.h"
+#include "RealtimeHooks.h"
+#include <iostream>
+
+using namespace WAVFinRealtimeCheck;
+
+namespace
+{
+    /** One host setup: the processor is prepared with these and runs a number of blocks. */
+    struct RunConfig
+    {
+        double sampleRate;
+        int maxBlockSize;
+        int numChannels;
+        bool doublePrecision;
+    };
+
+    // Tiny and odd block sizes, both precisions, mono and stereo, up to 192 kHz
+    const RunConfig runConfigs[]
+    {
+        { 44100.0,  64,   2, false },
+        { 48000.0,  37,   1, false },
+        { 96000.0,  512,  2, true },
+        { 192000.0, 1024, 2, false }
+    };
+
+    constexpr int defaultBlocksPerRun = 2000;
+    constexpr int editorChangesPerSecond = 40;
+
+    // Every this many blocks the input goes silent for the last quarter, so stages fall asleep and wake up
+    constexpr int silenceCycleBlocks = 400;
+
+    /** Writes a short stereo IR for the editor-side loads: 0.3 s of decaying noise. */
+    juce::Result writeImpulseResponse (const juce::File& file)
+    {
+        constexpr double sampleRate = 44100.0;
+        juce::AudioBuffer<float> impulse (2, (int) (0.3 * sampleRate));
+        juce::Random random (3);
+
+        for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            for (int s = 0; s < impulse.getNumSamples(); ++s)
+                impulse.setSample (ch, s, (2.0f * random.nextFloat() - 1.0f) * std::exp (-20.0f * (float) s / impulse.getNumSamples()));
+
+        std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (stream != nullptr ? wav.createWriterFor (stream.get(), sampleRate, 2, 24, {}, 0) : nullptr);
+
+        if (writer == nullptr)
+            return juce::Result::fail ("Cannot write " + file.getFullPathName());
+
+        stream.release();   // owned by the writer now
+        return writer->writeFromAudioSampleBuffer (impulse, 0, impulse.getNumSamples()) ? juce::Result::ok()
+                                                                                          : juce::Result::fail ("Write error on " + file.getFullPathName());
+    }
+
+    /** Stands in for the plugin wrapper, which every hosted processor has as a listener. */
+    struct HostListener  : public juce::AudioProcessorListener
+    {
+        void audioProcessorParameterChanged (juce::AudioProcessor*, int, float) override {}
+        void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails&) override {}
+    };
+}
+
+//==============================================================================
+/**
+    Runs the processor the way a host and its editor would, one RunConfig after another,
+    and counts every allocation, lock or blocking call made inside processBlock.
+
+    The audio thread automates random parameters between blocks, as a host does, sends
+    blocks of random length up to the prepared size, and marks only the processBlock
+    call itself with ScopedAudioThread. Meanwhile the message thread runs the processor's
+    own timer and, like an editor, flips enables and choices (the non-automatable ones
+    included) and loads impulse responses.
+*/
+class RealtimeCheck  : private juce::Thread,
+                       private juce::Timer
+{
+public:
+    RealtimeCheck (int blocks, juce::uint32 seedToUse, const juce::File& impulse)
+        : juce::Thread ("WAVFin audio"), blocksPerRun (blocks), seed (seedToUse), impulseResponse (impulse)
+    {
+    }
+
+    ~RealtimeCheck() override
+    {
+        stopTimer();
+        stopThread (10000);
+    }
+
+    /** Runs every configuration, dispatching messages until the last has finished. Message thread. */
+    void runAll()
+    {
+        startRun();
+        startTimerHz (editorChangesPerSecond);
+        juce::MessageManager::getInstance()->runDispatchLoop();
+    }
+
+private:
+    //==============================================================================
+    void startRun()
+    {
+        const auto& config = runConfigs[runIndex];
+
+        processor = std::make_unique<WAVFinEffectEngineAudioProcessor>();
+        processor->addListener (&hostListener);
+
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (config.numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.outputBuses.add (channelSet);
+        processor->setBusesLayout (layout);
+
+        processor->setProcessingPrecision (config.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                  : juce::AudioProcessor::singlePrecision);
+        processor->setRateAndBufferSizeDetails (config.sampleRate, config.maxBlockSize);
+        processor->prepareToPlay (config.sampleRate, config.maxBlockSize);
+
+        violationsBefore = getNumViolations();
+        editorRandom.setSeed ((juce::int64) seed * 7919 + runIndex);
+        startThread (juce::Thread::Priority::highest);
+    }
+
+    void finishRun()
+    {
+        const auto& config = runConfigs[runIndex];
+
+        std::cout << juce::String (config.sampleRate, 0) << " Hz, blocks up to " << config.maxBlockSize << ", "
+                  << config.numChannels << (config.doublePrecision ? " ch, double: " : " ch, float: ")
+                  << blocksPerRun << " blocks, " << getNumViolations() - violationsBefore << " violations" << std::endl;
+
+        processor->releaseResources();
+        processor->removeListener (&hostListener);
+        processor.reset();
+    }
+
+    //==============================================================================
+    // Message thread: what an editor does while audio runs
+    void timerCallback() override
+    {
+        if (! isThreadRunning())
+        {
+            finishRun();
+
+            if (++runIndex < (int) std::size (runConfigs))
+            {
+                startRun();
+            }
+            else
+            {
+                stopTimer();
+                juce::MessageManager::getInstance()->stopDispatchLoop();
+            }
+
+            return;
+        }
+
+        const auto& params = processor->getParameters();
+        auto* param = params[editorRandom.nextInt (params.size())];
+
+        // Enables and choices change the plan and the latency; those are the interesting ones
+        const auto numSteps = param->getNumSteps();
+        const auto value = numSteps > 1 && numSteps < 16 ? (float) editorRandom.nextInt (numSteps) / (float) (numSteps - 1)
+                                                         : editorRandom.nextFloat();
+        param->beginChangeGesture();
+        param->setValueNotifyingHost (value);
+        param->endChangeGesture();
+
+        if (editorRandom.nextInt (20) == 0)
+            processor->getConvolution().loadImpulseResponse (impulseResponse);
+    }
+
+    //==============================================================================
+    // Audio thread
+    void run() override
+    {
+        const auto& config = runConfigs[runIndex];
+
+        if (config.doublePrecision)
+            processBlocks<double> (config);
+        else
+            processBlocks<float> (config);
+    }
+
+    template <typename SampleType>
+    void processBlocks (const RunConfig& config)
+    {
+        juce::AudioBuffer<SampleType> buffer (config.numChannels, config.maxBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random ((juce::int64) seed * 104729 + runIndex);
+
+        juce::Array<juce::AudioProcessorParameter*> automatable;
+
+        for (auto* param : processor->getParameters())
+            if (param->isAutomatable())
+                automatable.add (param);
+
+        for (int block = 0; block < blocksPerRun && ! threadShouldExit(); ++block)
+        {
+            // Host automation arrives between blocks
+            for (int i = random.nextInt (4); --i >= 0;)
+                automatable[random.nextInt (automatable.size())]->setValueNotifyingHost (random.nextFloat());
+
+            const auto numSamples = random.nextInt (4) == 0 ? 1 + random.nextInt (config.maxBlockSize) : config.maxBlockSize;
+            const bool silent = block % silenceCycleBlocks >= silenceCycleBlocks * 3 / 4;
+
+            for (int ch = 0; ch < config.numChannels; ++ch)
+                for (int s = 0; s < numSamples; ++s)
+                    buffer.setSample (ch, s, silent ? SampleType() : (SampleType) (0.5f * random.nextFloat() - 0.25f));
+
+            juce::AudioBuffer<SampleType> hostBlock (buffer.getArrayOfWritePointers(), config.numChannels, numSamples);
+
+            {
+                const ScopedAudioThread audioThread;
+                processor->processBlock (hostBlock, midi);
+            }
+
+            // Leaves the message thread time to make changes while the blocks run
+            wait (1);
+        }
+    }
+
+    //==============================================================================
+    const int blocksPerRun;
+    const juce::uint32 seed;
+    const juce::File impulseResponse;
+
+    int runIndex = 0;
+    int violationsBefore = 0;
+    std::unique_ptr<WAVFinEffectEngineAudioProcessor> processor;
+    HostListener hostListener;
+    juce::Random editorRandom;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeCheck)
+};
+
+//==============================================================================
+namespace
+{
+    void runCheck (const juce::ArgumentList& args)
+    {
+        const auto blocks = args.containsOption ("--blocks") ? args.getValueForOption ("--blocks").getIntValue() : defaultBlocksPerRun;
+        const auto seed = args.containsOption ("--seed") ? (juce::uint32) args.getValueForOption ("--seed").getLargeIntValue() : 1u;
+
+        if (blocks < 1)
+            juce::ConsoleApplication::fail ("--blocks must be at least 1");
+
+        const juce::TemporaryFile impulse (".wav");
+
+        if (auto result = writeImpulseResponse (impulse.getFile()); result.failed())
+            juce::ConsoleApplication::fail (result.getErrorMessage());
+
+        std::cout << "Seed " << seed << std::endl;
+
+        {
+            RealtimeCheck check (blocks, seed, impulse.getFile());
+            check.runAll();
+        }
+
+        if (const auto numViolations = getNumViolations(); numViolations > 0)
+        {
+            printViolations (std::cerr);
+            juce::ConsoleApplication::fail (juce::String (numViolations) + " allocations, locks or blocking calls inside processBlock");
+        }
+
+        std::cout << "No allocations, locks or blocking calls inside processBlock" << std::endl;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    installHooks();
+
+    // The message thread runs the processor's timer and the editor-side changes
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage: wavfin-rtcheck [--blocks=<n>] [--seed=<n>]", true);
+
+    app.addDefaultCommand ({ "",
+                             "[--blocks=<n>] [--seed=<n>]",
+                             "Fails if processBlock allocates, locks or blocks.",
+                             "Runs every host setup for --blocks blocks (default 2000) with random automation and\n"
+                             "editor changes, seeded by --seed (default 1), under malloc, lock and syscall hooks.\n",
+                             runCheck });
+
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,262 @@
+// The fortified read() and write() wrappers would clash with the replacements below
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeHooks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+// glibc's own allocator entry points, so the malloc replacements need no dlsym (which allocates)
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void __libc_free (void*);
+}
+
+namespace WAVFinRealtimeCheck
+{
+
+namespace
+{
+    constexpr int maxFrames = 24;
+    constexpr int maxSites = 256;
+
+    /** A distinct call: the function and the stack that reached it. */
+    struct Site
+    {
+        const char* function;
+        void* frames[maxFrames];
+        int numFrames;
+        int count;
+    };
+
+    // Written only while recording is held; read after the audio threads have stopped
+    Site sites[maxSites];
+    int numSites = 0;
+    std::atomic_flag recording = ATOMIC_FLAG_INIT;
+
+    std::atomic<int> numViolations { 0 };
+    std::atomic<int> numUnrecorded { 0 };
+
+    // Plain ints, so reading them needs no TLS initialiser (which could itself allocate)
+    thread_local int audioThreadDepth = 0;
+    thread_local int hookDepth = 0;
+
+    // Not inlined, so the stack always starts with this frame and the replacement's (see printViolations)
+    [[gnu::noinline]] void record (const char* function) noexcept
+    {
+        if (audioThreadDepth == 0 || hookDepth > 0)
+            return;
+
+        // Anything the recording itself calls (the unwinder) is not the audio code's doing
+        ++hookDepth;
+        numViolations.fetch_add (1, std::memory_order_relaxed);
+
+        void* frames[maxFrames];
+        const auto numFrames = backtrace (frames, maxFrames);
+
+        while (recording.test_and_set (std::memory_order_acquire)) {}
+
+        auto* site = std::find_if (sites, sites + numSites, [&] (const Site& s)
+        {
+            return s.function == function && s.numFrames == numFrames
+                && std::equal (frames, frames + numFrames, s.frames);
+        });
+
+        if (site != sites + numSites)
+            ++site->count;
+        else if (numSites < maxSites)
+        {
+            site = &sites[numSites++];
+            site->function = function;
+            site->numFrames = numFrames;
+            site->count = 1;
+            std::copy (frames, frames + numFrames, site->frames);
+        }
+        else
+            numUnrecorded.fetch_add (1, std::memory_order_relaxed);
+
+        recording.clear (std::memory_order_release);
+        --hookDepth;
+    }
+
+    /** The next definition of a function after this executable's, looked up once. */
+    template <typename Function>
+    Function real (std::atomic<void*>& cache, const char* name) noexcept
+    {
+        auto* function = cache.load (std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            ++hookDepth;
+            function = dlsym (RTLD_NEXT, name);
+            --hookDepth;
+            cache.store (function, std::memory_order_release);
+        }
+
+        return reinterpret_cast<Function> (function);
+    }
+
+    /** "binary(_ZN4mangled+0x1f) [0x...]" with the symbol demangled, when there is one. */
+    std::string demangleFrame (const char* frame)
+    {
+        std::string text (frame);
+        const auto open = text.find ('(');
+        const auto plus = text.find ('+', open);
+
+        if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+            return text;
+
+        int status = 0;
+        std::unique_ptr<char, decltype (&std::free)> name (abi::__cxa_demangle (text.substr (open + 1, plus - open - 1).c_str(),
+                                                                                nullptr, nullptr, &status), &std::free);
+        if (status != 0 || name == nullptr)
+            return text;
+
+        return text.substr (0, open + 1) + name.get() + text.substr (plus);
+    }
+}
+
+//==============================================================================
+ScopedAudioThread::ScopedAudioThread() noexcept     { ++audioThreadDepth; }
+ScopedAudioThread::~ScopedAudioThread() noexcept    { --audioThreadDepth; }
+
+void installHooks()
+{
+    // The first backtrace() loads the unwinder, and the first dlsym() allocates its error buffer
+    void* frames[maxFrames];
+    backtrace (frames, maxFrames);
+
+    timespec none {};
+    nanosleep (&none, nullptr);
+    sched_yield();
+}
+
+int getNumViolations() noexcept
+{
+    return numViolations.load (std::memory_order_relaxed);
+}
+
+void printViolations (std::ostream& out)
+{
+    for (int i = 0; i < numSites; ++i)
+    {
+        const auto& site = sites[i];
+        out << site.function << " called " << site.count << (site.count == 1 ? " time" : " times") << " on the audio thread:\n";
+
+        // Frame 0 is record() and frame 1 the replacement function
+        if (auto* symbols = backtrace_symbols (site.frames, site.numFrames))
+        {
+            for (int frame = 2; frame < site.numFrames; ++frame)
+                out << "    " << demangleFrame (symbols[frame]) << "\n";
+
+            std::free (symbols);
+        }
+
+        out << "\n";
+    }
+
+    if (const auto unrecorded = numUnrecorded.load(); unrecorded > 0)
+        out << unrecorded << " more calls from further call sites were counted but not recorded\n";
+}
+
+} // namespace WAVFinRealtimeCheck
+
+//==============================================================================
+// The replacements. Each records the call, then forwards it.
+using WAVFinRealtimeCheck::record;
+using WAVFinRealtimeCheck::real;
+
+extern "C"
+{
+
+void* malloc (size_t size)
+{
+    record ("malloc");
+    return __libc_malloc (size);
+}
+
+void* calloc (size_t count, size_t size)
+{
+    record ("calloc");
+    return __libc_calloc (count, size);
+}
+
+void* realloc (void* ptr, size_t size)
+{
+    record ("realloc");
+    return __libc_realloc (ptr, size);
+}
+
+void free (void* ptr)
+{
+    // free (nullptr) is a no-op, as in the destructor of an empty std::function
+    if (ptr != nullptr)
+        record ("free");
+
+    __libc_free (ptr);
+}
+
+void* memalign (size_t alignment, size_t size)
+{
+    record ("memalign");
+    return __libc_memalign (alignment, size);
+}
+
+void* aligned_alloc (size_t alignment, size_t size)
+{
+    record ("aligned_alloc");
+    return __libc_memalign (alignment, size);
+}
+
+int posix_memalign (void** result, size_t alignment, size_t size)
+{
+    record ("posix_memalign");
+
+    if (alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    *result = __libc_memalign (alignment, size);
+    return *result != nullptr || size == 0 ? 0 : ENOMEM;
+}
+
+// A static local of this type is constant-initialised, so the first call takes no guard lock
+#define WAVFIN_FORWARD(name, ...) \
+    static std::atomic<void*> realFunction { nullptr }; \
+    record (#name); \
+    return real<decltype (&name)> (realFunction, #name) (__VA_ARGS__)
+
+int pthread_mutex_lock (pthread_mutex_t* mutex)                                         { WAVFIN_FORWARD (pthread_mutex_lock, mutex); }
+int pthread_rwlock_rdlock (pthread_rwlock_t* lock)                                      { WAVFIN_FORWARD (pthread_rwlock_rdlock, lock); }
+int pthread_rwlock_wrlock (pthread_rwlock_t* lock)                                      { WAVFIN_FORWARD (pthread_rwlock_wrlock, lock); }
+int pthread_cond_wait (pthread_cond_t* cond, pthread_mutex_t* mutex)                   { WAVFIN_FORWARD (pthread_cond_wait, cond, mutex); }
+int pthread_cond_timedwait (pthread_cond_t* cond, pthread_mutex_t* mutex, const timespec* time) { WAVFIN_FORWARD (pthread_cond_timedwait, cond, mutex, time); }
+int pthread_join (pthread_t thread, void** result)                                      { WAVFIN_FORWARD (pthread_join, thread, result); }
+int sem_wait (sem_t* semaphore)                                                         { WAVFIN_FORWARD (sem_wait, semaphore); }
+int sem_timedwait (sem_t* semaphore, const timespec* time)                              { WAVFIN_FORWARD (sem_timedwait, semaphore, time); }
+int nanosleep (const timespec* duration, timespec* remaining)                           { WAVFIN_FORWARD (nanosleep, duration, remaining); }
+int clock_nanosleep (clockid_t clock, int flags, const timespec* time, timespec* remaining) { WAVFIN_FORWARD (clock_nanosleep, clock, flags, time, remaining); }
+int usleep (useconds_t microseconds)                                                    { WAVFIN_FORWARD (usleep, microseconds); }
+int sched_yield()                                                                       { WAVFIN_FORWARD (sched_yield); }
+ssize_t read (int fd, void* buffer, size_t size)                                        { WAVFIN_FORWARD (read, fd, buffer, size); }
+ssize_t write (int fd, const void* buffer, size_t size)                                 { WAVFIN_FORWARD (write, fd, buffer, size); }
+
+#undef WAVFIN_FORWARD
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ostream>
+
+namespace WAVFinRealtimeCheck
+{
+
+//==============================================================================
+/**
+    Marks the calling thread as a realtime audio thread while alive.
+
+    RealtimeHooks.cpp replaces malloc and friends, pthread locks and condition waits,
+    semaphores, sleeps, sched_yield and read/write for the whole executable (Linux/glibc).
+    Every replacement forwards to the real function; on a marked thread it first records
+    the call and the stack that made it. Nesting is allowed.
+*/
+class ScopedAudioThread
+{
+public:
+    ScopedAudioThread() noexcept;
+    ~ScopedAudioThread() noexcept;
+
+    ScopedAudioThread (const ScopedAudioThread&) = delete;
+    ScopedAudioThread& operator= (const ScopedAudioThread&) = delete;
+};
+
+/** Resolves the real functions and warms up the unwinder, which allocates the first time
+    it runs. Call once from main() before any thread is marked. */
+void installHooks();
+
+/** Calls made from marked threads so far. */
+int getNumViolations() noexcept;
+
+/** Prints each distinct call site once, with its count and demangled stack. Not realtime safe. */
+void printViolations (std::ostream& out);
+
+} // namespace WAVFinRealtimeCheck
@@ -0,0 +1,220 @@
+#include "OfflineRenderer.h"
+#include "WorkStealingPool.h"
+#include <iostream>
+
+using namespace WAVFinRender;
+
+namespace
+{
+    const char* const renderOptions =
+        "  --state=<file>     processor state (getStateInformation blob, or its XML)\n"
+        "  --params=<file>    JSON object of parameter values, applied after the state\n"
+        "  --block=<n>        block size (default 512)\n"
+        "  --double           process in double precision\n"
+        "  --tail=<seconds>   render past the input (default: the processor's tail, at most 30 s)\n"
+        "  --bits=<n>         output bit depth (default 24)\n";
+
+    /** Command-line arguments that are not --options, after the command itself. */
+    juce::StringArray getPositionalArguments (const juce::ArgumentList& args)
+    {
+        juce::StringArray result;
+
+        for (int i = 1; i < args.size(); ++i)
+            if (! args[i].isOption())
+                result.add (args[i].text);
+
+        return result;
+    }
+
+    RenderSettings parseSettings (const juce::ArgumentList& args)
+    {
+        RenderSettings settings;
+
+        auto intOption = [&args] (const char* option, int defaultValue, int minValue, int maxValue)
+        {
+            if (! args.containsOption (option))
+                return defaultValue;
+
+            const auto text = args.getValueForOption (option);
+
+            if (! text.containsOnly ("0123456789") || ! juce::isPositiveAndNotGreaterThan (text.getIntValue() - minValue, maxValue - minValue))
+                juce::ConsoleApplication::fail (juce::String (option) + " must be a whole number from "
+                                                + juce::String (minValue) + " to " + juce::String (maxValue));
+            return text.getIntValue();
+        };
+
+        settings.blockSize = intOption ("--block", settings.blockSize, 1, 65536);
+        settings.bitsPerSample = intOption ("--bits", settings.bitsPerSample, 8, 32);
+        settings.doublePrecision = args.containsOption ("--double");
+
+        if (args.containsOption ("--tail"))
+            settings.tailSeconds = juce::jmax (0.0, args.getValueForOption ("--tail").getDoubleValue());
+
+        if (args.containsOption ("--state"))
+        {
+            const auto file = args.getExistingFileForOption ("--state");
+
+            if (auto xml = juce::parseXML (file))
+                juce::AudioProcessor::copyXmlToBinary (*xml, settings.state);
+            else if (! file.loadFileAsData (settings.state))
+                juce::ConsoleApplication::fail ("Cannot read " + file.getFullPathName());
+        }
+
+        if (args.containsOption ("--params"))
+        {
+            const auto file = args.getExistingFileForOption ("--params");
+            const auto result = juce::JSON::parse (file.loadFileAsString(), settings.parameters);
+
+            if (result.failed())
+                juce::ConsoleApplication::fail (file.getFileName() + ": " + result.getErrorMessage());
+        }
+
+        return settings;
+    }
+
+    void printStats (const juce::String& name, const RenderStats& stats)
+    {
+        std::cout << name << ": " << juce::String (stats.audioSeconds, 1) << " s of audio in "
+                  << juce::String (stats.wallSeconds, 2) << " s, "
+                  << juce::String (stats.getRealtimeFactor(), 1) << "x realtime ("
+                  << juce::String (stats.getDspRealtimeFactor(), 1) << "x in processBlock)" << std::endl;
+    }
+
+    //==============================================================================
+    void renderFile (const juce::ArgumentList& args)
+    {
+        const auto files = getPositionalArguments (args);
+
+        if (files.size() != 2)
+            juce::ConsoleApplication::fail ("Expected an input and an output file");
+
+        const auto input = juce::File::getCurrentWorkingDirectory().getChildFile (files[0]);
+        const auto output = juce::File::getCurrentWorkingDirectory().getChildFile (files[1]);
+
+        const auto settings = parseSettings (args);
+        OfflineRenderer renderer (settings);
+
+        if (auto result = renderer.configure(); result.failed())
+            juce::ConsoleApplication::fail (result.getErrorMessage());
+
+        RenderStats stats;
+
+        if (auto result = renderer.render (input, output, stats); result.failed())
+            juce::ConsoleApplication::fail (result.getErrorMessage());
+
+        printStats (input.getFileName(), stats);
+    }
+
+    void renderBatch (const juce::ArgumentList& args)
+    {
+        const auto folders = getPositionalArguments (args);
+
+        if (folders.size() != 2)
+            juce::ConsoleApplication::fail ("Expected an input and an output folder");
+
+        const auto inputFolder = juce::File::getCurrentWorkingDirectory().getChildFile (folders[0]);
+        const auto outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile (folders[1]);
+
+        if (! inputFolder.isDirectory())
+            juce::ConsoleApplication::fail ("Not a folder: " + inputFolder.getFullPathName());
+
+        if (outputFolder.createDirectory().failed())
+            juce::ConsoleApplication::fail ("Cannot create " + outputFolder.getFullPathName());
+
+        auto inputs = inputFolder.findChildFiles (juce::File::findFiles, false, "*.wav;*.flac");
+
+        if (inputs.isEmpty())
+            juce::ConsoleApplication::fail ("No .wav or .flac files in " + inputFolder.getFullPathName());
+
+        // Longest first, so the pool starts the big files early and steals the small ones
+        std::sort (inputs.begin(), inputs.end(), [] (const juce::File& a, const juce::File& b) { return a.getSize() > b.getSize(); });
+
+        const auto settings = parseSettings (args);
+        const auto maxJobs = juce::SystemStats::getNumCpus();
+        const auto numWorkers = juce::jmin (inputs.size(), [&]
+        {
+            if (! args.containsOption ("--jobs"))
+                return maxJobs;
+
+            const auto jobs = args.getValueForOption ("--jobs").getIntValue();
+
+            if (jobs < 1)
+                juce::ConsoleApplication::fail ("--jobs must be at least 1");
+
+            return jobs;
+        }());
+
+        // One processor per worker, created and configured here on the message thread
+        std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            renderers.push_back (std::make_unique<OfflineRenderer> (settings));
+
+            if (auto result = renderers.back()->configure(); result.failed())
+                juce::ConsoleApplication::fail (result.getErrorMessage());
+        }
+
+        std::mutex outputLock;
+        RenderStats total;
+        int numFailed = 0;
+
+        WorkStealingPool pool (numWorkers);
+
+        for (const auto& input : inputs)
+        {
+            pool.add ([&, input] (int worker)
+            {
+                RenderStats stats;
+                const auto result = renderers[(size_t) worker]->render (input, outputFolder.getChildFile (input.getFileName()), stats);
+
+                const std::lock_guard<std::mutex> lock (outputLock);
+
+                if (result.failed())
+                {
+                    std::cerr << result.getErrorMessage() << std::endl;
+                    ++numFailed;
+                    return;
+                }
+
+                printStats (input.getFileName(), stats);
+                total += stats;
+            });
+        }
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        pool.run();
+        const auto wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+        std::cout << inputs.size() - numFailed << " files, " << juce::String (total.audioSeconds, 1) << " s of audio in "
+                  << juce::String (wallSeconds, 2) << " s on " << numWorkers << " threads: "
+                  << juce::String (wallSeconds > 0.0 ? total.audioSeconds / wallSeconds : 0.0, 1) << "x realtime" << std::endl;
+
+        if (numFailed > 0)
+            juce::ConsoleApplication::fail (juce::String (numFailed) + " files failed");
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's timers and change broadcasters need a message manager, even with no loop running
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage: wavfin-render <command> [options]", true);
+
+    app.addCommand ({ "render",
+                      "render <input> <output> [options]",
+                      "Renders one file through the effect chain.",
+                      juce::String ("Reads WAV or FLAC and writes the format of the output's extension.\n") + renderOptions,
+                      renderFile });
+
+    app.addCommand ({ "batch",
+                      "batch <input folder> <output folder> [options] [--jobs=<n>]",
+                      "Renders every .wav and .flac file in a folder, one processor per core.",
+                      juce::String ("Outputs keep their names. --jobs limits the number of threads (default: one per core).\n") + renderOptions,
+                      renderBatch });
+
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,218 @@
+#include "OfflineRenderer.h"
+
+namespace WAVFinRender
+{
+
+namespace
+{
+    // Longest wait for the loader thread to decode and resample an impulse response
+    constexpr int impulseLoadTimeoutMs = 60000;
+
+    // Key in the parameter JSON that names an IR file rather than a parameter
+    const juce::Identifier impulseResponseKey { "impulse_response" };
+
+    double secondsSince (juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    }
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer (const RenderSettings& s)
+    : settings (s)
+{
+    formats.registerBasicFormats();
+}
+
+juce::Result OfflineRenderer::configure()
+{
+    if (settings.state.getSize() > 0)
+        processor.setStateInformation (settings.state.getData(), (int) settings.state.getSize());
+
+    if (auto result = applyParameters(); result.failed())
+        return result;
+
+    auto& convolution = processor.getConvolution();
+
+    if (! convolution.waitForPendingLoads (impulseLoadTimeoutMs))
+        return juce::Result::fail ("Timed out loading the impulse response");
+
+    // A failed load reports the previous file instead. The IR asked for is the JSON one,
+    // or else the one in the state (stored under "impulseResponse", see getStateInformation)
+    const auto requested = processor.apvts.state.getProperty ("impulseResponse").toString();
+    const auto irFile = settings.parameters.hasProperty (impulseResponseKey)
+                            ? juce::File (settings.parameters[impulseResponseKey].toString())
+                            : (juce::File::isAbsolutePath (requested) ? juce::File (requested) : juce::File());
+
+    if (irFile != juce::File() && convolution.getImpulseResponseFile() != irFile)
+        return juce::Result::fail ("Could not load impulse response " + irFile.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::applyParameters()
+{
+    const auto* object = settings.parameters.getDynamicObject();
+
+    if (object == nullptr)
+        return settings.parameters.isVoid() ? juce::Result::ok()
+                                            : juce::Result::fail ("Parameters must be a JSON object");
+
+    for (const auto& property : object->getProperties())
+    {
+        const auto id = property.name.toString();
+        const auto& value = property.value;
+
+        if (property.name == impulseResponseKey)
+        {
+            processor.getConvolution().loadImpulseResponse (juce::File (value.toString()));
+            continue;
+        }
+
+        auto* param = processor.apvts.getParameter (id);
+
+        if (param == nullptr)
+            return juce::Result::fail ("Unknown parameter: " + id);
+
+        float normalised = 0.0f;
+
+        if (value.isString())
+            normalised = param->getValueForText (value.toString());
+        else if (value.isBool() || value.isInt() || value.isInt64() || value.isDouble())
+            normalised = param->convertTo0to1 ((float) value);
+        else
+            return juce::Result::fail ("Parameter " + id + " needs a number, bool or string");
+
+        param->setValueNotifyingHost (normalised);
+    }
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+juce::Result OfflineRenderer::render (const juce::File& input, const juce::File& output, RenderStats& stats)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    stats = {};
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (input));
+
+    if (reader == nullptr)
+        return juce::Result::fail ("Cannot read " + input.getFullPathName());
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sampleRate = reader->sampleRate;
+
+    if (numChannels < 1 || numChannels > 2)
+        return juce::Result::fail (input.getFileName() + ": only mono and stereo files are supported");
+
+    // The processor runs with the file's channel layout
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (channelSet);
+    layout.outputBuses.add (channelSet);
+
+    if (! processor.setBusesLayout (layout))
+        return juce::Result::fail ("The processor does not accept " + juce::String (numChannels) + " channels");
+
+    auto* format = formats.findFormatForFileExtension (output.getFileExtension());
+
+    if (format == nullptr)
+        return juce::Result::fail ("No writer for " + output.getFileName() + " (use .wav or .flac)");
+
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream (output.createOutputStream());
+
+    if (stream == nullptr)
+        return juce::Result::fail ("Cannot write " + output.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                             settings.bitsPerSample, {}, 0));
+    if (writer == nullptr)
+        return juce::Result::fail (output.getFileName() + ": the format does not support "
+                                   + juce::String (settings.bitsPerSample) + "-bit " + juce::String (sampleRate) + " Hz");
+
+    stream.release();   // owned by the writer now
+
+    // Prepare as a host would for an offline bounce
+    processor.setProcessingPrecision (settings.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                               : juce::AudioProcessor::singlePrecision);
+    processor.setNonRealtime (true);
+    processor.prepareToPlay (sampleRate, settings.blockSize);
+
+    if (settings.doublePrecision)
+        doubleBuffer.setSize (numChannels, settings.blockSize);
+
+    const auto tailSeconds = settings.tailSeconds >= 0.0 ? settings.tailSeconds
+                                                         : juce::jmin (processor.getTailLengthSeconds(), RenderSettings::maxTailSeconds);
+    const auto inputFrames = reader->lengthInSamples;
+    const auto outputFrames = inputFrames + (juce::int64) std::ceil (tailSeconds * sampleRate);
+
+    juce::AudioBuffer<float> io (numChannels, settings.blockSize);
+    auto framesToDrop = (juce::int64) processor.getLatencySamples();
+    juce::int64 framesRead = 0, framesWritten = 0;
+    bool writeFailed = false;
+
+    while (framesWritten < outputFrames && ! writeFailed)
+    {
+        // Past the end of the file the reader fills with silence, which flushes the tail
+        reader->read (&io, 0, settings.blockSize, framesRead, true, numChannels > 1);
+        framesRead += settings.blockSize;
+
+        if (settings.doublePrecision)
+            processBlock<double> (io, stats);
+        else
+            processBlock<float> (io, stats);
+
+        const auto skip = (int) juce::jmin (framesToDrop, (juce::int64) settings.blockSize);
+        const auto count = (int) juce::jmin ((juce::int64) (settings.blockSize - skip), outputFrames - framesWritten);
+        framesToDrop -= skip;
+
+        if (count > 0)
+        {
+            writeFailed = ! writer->writeFromAudioSampleBuffer (io, skip, count);
+            framesWritten += count;
+        }
+    }
+
+    processor.releaseResources();
+    writer.reset();
+
+    if (writeFailed)
+        return juce::Result::fail ("Write error on " + output.getFullPathName());
+
+    stats.audioSeconds = (double) inputFrames / sampleRate;
+    stats.wallSeconds = secondsSince (startTicks);
+    return juce::Result::ok();
+}
+
+template <typename SampleType>
+void OfflineRenderer::processBlock (juce::AudioBuffer<float>& io, RenderStats& stats)
+{
+    if constexpr (std::is_same_v<SampleType, double>)
+    {
+        for (int ch = 0; ch < io.getNumChannels(); ++ch)
+            std::copy_n (io.getReadPointer (ch), io.getNumSamples(), doubleBuffer.getWritePointer (ch));
+    }
+
+    auto& buffer = [&]() -> juce::AudioBuffer<SampleType>&
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBuffer;
+        else
+            return io;
+    }();
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    processor.processBlock (buffer, midi);
+    stats.dspSeconds += secondsSince (startTicks);
+
+    if constexpr (std::is_same_v<SampleType, double>)
+    {
+        for (int ch = 0; ch < io.getNumChannels(); ++ch)
+            std::transform (doubleBuffer.getReadPointer (ch), doubleBuffer.getReadPointer (ch) + io.getNumSamples(),
+                            io.getWritePointer (ch), [] (double x) { return (float) x; });
+    }
+}
+
+} // namespace WAVFinRender
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+namespace WAVFinRender
+{
+
+//==============================================================================
+/** What every file in a run shares: the processor settings and how the audio is streamed. */
+struct RenderSettings
+{
+    int blockSize = 512;
+    bool doublePrecision = false;
+    int bitsPerSample = 24;
+
+    /** Seconds rendered past the end of the input; negative uses the processor's
+        tail length, capped at maxTailSeconds (the delay tail can be infinite). */
+    double tailSeconds = -1.0;
+    static constexpr double maxTailSeconds = 30.0;
+
+    /** A getStateInformation() blob, applied first. */
+    juce::MemoryBlock state;
+
+    /** { "param_id": value, ... } applied on top of the state. Numbers are in the
+        parameter's own units (choice index, dB, ms...), strings are parsed as the host
+        would show them, and "impulse_response" is an IR file path. */
+    juce::var parameters;
+};
+
+/** Timing of one render. */
+struct RenderStats
+{
+    double audioSeconds = 0.0;      // input length
+    double wallSeconds = 0.0;       // reading, processing and writing
+    double dspSeconds = 0.0;        // processBlock only
+
+    double getRealtimeFactor() const noexcept      { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+    double getDspRealtimeFactor() const noexcept   { return dspSeconds > 0.0 ? audioSeconds / dspSeconds : 0.0; }
+
+    RenderStats& operator+= (const RenderStats& other) noexcept
+    {
+        audioSeconds += other.audioSeconds;
+        wallSeconds += other.wallSeconds;
+        dspSeconds += other.dspSeconds;
+        return *this;
+    }
+};
+
+//==============================================================================
+/**
+    Streams audio files through one WAVFinEffectEngineAudioProcessor, without an editor.
+
+    Each file is read and written block by block at settings.blockSize, so memory use
+    does not grow with its length. The processor runs non-realtime at the file's rate and
+    channel count (mono or stereo), and the output is latency compensated: the first
+    getLatencySamples() frames are dropped and the input is padded to flush them out,
+    followed by the tail.
+
+    Create and configure() on the message thread; render() may then run on any one thread.
+*/
+class OfflineRenderer
+{
+public:
+    explicit OfflineRenderer (const RenderSettings& settings);
+
+    /** Applies the state and parameters and waits for the impulse response to load.
+        Fails on an unknown parameter, a value of the wrong type or an IR that will not load. */
+    juce::Result configure();
+
+    /** Renders input (any format JUCE reads) to output (.wav or .flac, by extension). */
+    juce::Result render (const juce::File& input, const juce::File& output, RenderStats& stats);
+
+private:
+    //==============================================================================
+    juce::Result applyParameters();
+
+    template <typename SampleType>
+    void processBlock (juce::AudioBuffer<float>& io, RenderStats& stats);
+
+    //==============================================================================
+    const RenderSettings& settings;
+    WAVFinEffectEngineAudioProcessor processor;
+    juce::AudioFormatManager formats;
+    juce::AudioBuffer<double> doubleBuffer;
+    juce::MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
+
+} // namespace WAVFinRender
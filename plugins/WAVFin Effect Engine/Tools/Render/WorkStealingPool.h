@@ -0,0 +1,105 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace WAVFinRender
+{
+
+//==============================================================================
+/**
+    Runs a fixed set of jobs on a fixed number of worker threads.
+
+    Jobs are dealt round-robin into one queue per worker. A worker takes from the front
+    of its own queue and, once that is empty, steals from the back of the others, so a
+    worker that drew short files helps with the long ones instead of sitting idle. Add the
+    longest jobs first: they are then started first and the stolen ones are the short ones.
+
+    The job receives the index of the worker running it, to pick that worker's resources.
+*/
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void (int workerIndex)>;
+
+    explicit WorkStealingPool (int numWorkers)
+    {
+        for (int i = 0; i < juce::jmax (1, numWorkers); ++i)
+            queues.push_back (std::make_unique<Queue>());
+    }
+
+    int getNumWorkers() const noexcept      { return (int) queues.size(); }
+
+    /** Call before run(). */
+    void add (Job job)
+    {
+        queues[numAdded++ % queues.size()]->jobs.push_back (std::move (job));
+    }
+
+    /** Runs every job added so far and returns when all have finished. */
+    void run()
+    {
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < getNumWorkers(); ++i)
+            threads.emplace_back ([this, i] { work (i); });
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+private:
+    //==============================================================================
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Job> jobs;
+    };
+
+    void work (int index)
+    {
+        // Nothing is added while running, so once every queue is empty the work is done
+        while (auto job = takeJob (index))
+            job (index);
+    }
+
+    Job takeJob (int index)
+    {
+        if (auto job = pop (*queues[(size_t) index], true))
+            return job;
+
+        for (int offset = 1; offset < getNumWorkers(); ++offset)
+            if (auto job = pop (*queues[(size_t) ((index + offset) % getNumWorkers())], false))
+                return job;
+
+        return {};
+    }
+
+    static Job pop (Queue& queue, bool front)
+    {
+        const std::lock_guard<std::mutex> lock (queue.lock);
+
+        if (queue.jobs.empty())
+            return {};
+
+        auto job = std::move (front ? queue.jobs.front() : queue.jobs.back());
+
+        if (front)
+            queue.jobs.pop_front();
+        else
+            queue.jobs.pop_back();
+
+        return job;
+    }
+
+    //==============================================================================
+    std::vector<std::unique_ptr<Queue>> queues;
+    size_t numAdded = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkStealingPool)
+};
+
+} // namespace WAVFinRender